@@ -147,6 +147,7 @@ static QofQuery *new_query_for_addresss(QofBook *book)
 
 static AddressQF* build_shared_quickfill (QofBook *book, const char * key)
 {
+    static const QofIdTypeConst address_types[] = { GNC_ID_ADDRESS, NULL };
     AddressQF *result;
     QofQuery *query = new_query_for_addresss(book);
     GList *entries = qof_query_run(query);
@@ -166,8 +167,8 @@ static AddressQF* build_shared_quickfill (QofBook *book, const char * key)
     qof_query_destroy(query);
 
     result->listener =
-        qof_event_register_handler (listen_for_gncaddress_events,
-                                    result);
+        qof_event_register_filtered_handler (listen_for_gncaddress_events,
+                result, QOF_EVENT_MODIFY | QOF_EVENT_DESTROY, address_types);
 
     qof_book_set_data_fin (book, key, result, shared_quickfill_destroy);
 
@@ -252,6 +252,25 @@ add_event_type (ComponentEventInfo *cei, QofIdTypeConst entity_type,
         *mask = event_mask;
 }
 
+static void
+cm_record_event (const GncGUID *guid, QofIdTypeConst type,
+                 QofEventId event_type)
+{
+    add_event (&changes, guid, event_type, TRUE);
+
+    if (g_strcmp0 (type, GNC_ID_SPLIT) == 0)
+    {
+        /* split events are never generated by the engine, but might
+         * be generated by a backend (viz. the postgres backend.)
+         * Handle them like a transaction modify event. */
+        add_event_type (&changes, GNC_ID_TRANS, QOF_EVENT_MODIFY, TRUE);
+    }
+    else if (type)
+        add_event_type (&changes, type, event_type, TRUE);
+
+    got_events = TRUE;
+}
+
 static void
 gnc_cm_event_handler (QofInstance *entity,
                       QofEventId event_type,
@@ -263,19 +282,27 @@ gnc_cm_event_handler (QofInstance *entity,
     fprintf (stderr, "event_handler: event %d, entity %p, guid %s\n", event_type,
              entity, guid_to_string(guid));
 #endif
-    add_event (&changes, guid, event_type, TRUE);
+    cm_record_event (guid, entity->e_type, event_type);
 
-    if (QOF_CHECK_TYPE(entity, GNC_ID_SPLIT))
+    if (suspend_counter == 0)
+        gnc_gui_refresh_internal (FALSE);
+}
+
+/* The events of a whole engine batch, one entry per entity, end in a
+ * single refresh. */
+static void
+gnc_cm_batch_handler (const GPtrArray *entries, gpointer user_data)
+{
+    guint i;
+
+#if CM_DEBUG
+    fprintf (stderr, "batch_handler: %u entities\n", entries->len);
+#endif
+    for (i = 0; i < entries->len; i++)
     {
-        /* split events are never generated by the engine, but might
-         * be generated by a backend (viz. the postgres backend.)
-         * Handle them like a transaction modify event. */
-        add_event_type (&changes, GNC_ID_TRANS, QOF_EVENT_MODIFY, TRUE);
+        QofEventBatchEntry *entry = g_ptr_array_index (entries, i);
+        cm_record_event (&entry->guid, entry->type, entry->event_mask);
     }
-    else
-        add_event_type (&changes, entity->e_type, event_type, TRUE);
-
-    got_events = TRUE;
 
     if (suspend_counter == 0)
         gnc_gui_refresh_internal (FALSE);
@@ -298,7 +325,8 @@ gnc_component_manager_init (void)
     changes_backup.event_masks = g_hash_table_new (g_str_hash, g_str_equal);
     changes_backup.entity_events = guid_hash_table_new ();
 
-    handler_id = qof_event_register_handler (gnc_cm_event_handler, NULL);
+    handler_id = qof_event_register_batch_handler (gnc_cm_event_handler,
+                 gnc_cm_batch_handler, NULL);
 }
 
 void
@@ -121,6 +121,7 @@ static QofQuery *new_query_for_entrys(QofBook *book)
 
 static EntryQF* build_shared_quickfill (QofBook *book, const char * key, gboolean use_invoices)
 {
+    static const QofIdTypeConst entry_types[] = { GNC_ID_ENTRY, NULL };
     EntryQF *result;
     QofQuery *query = new_query_for_entrys(book);
     GList *entries = qof_query_run(query);
@@ -139,8 +140,8 @@ static EntryQF* build_shared_quickfill (QofBook *book, const char * key, gboolea
     qof_query_destroy(query);
 
     result->listener =
-        qof_event_register_handler (listen_for_gncentry_events,
-                                    result);
+        qof_event_register_filtered_handler (listen_for_gncentry_events,
+                result, QOF_EVENT_MODIFY | QOF_EVENT_DESTROY, entry_types);
 
     qof_book_set_data_fin (book, key, result, shared_quickfill_destroy);
 
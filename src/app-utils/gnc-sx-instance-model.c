@@ -1216,7 +1216,7 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
 
     {
         kvp_frame *txn_frame;
-        txn_frame = xaccTransGetSlots(new_txn);
+        txn_frame = xaccTransGetSlotsForEdit(new_txn);
         kvp_frame_set_guid(txn_frame, "from-sched-xaction",
 		  xaccSchedXactionGetGUID(creation_data->instance->parent->sx));
 /* The transaction was probably marked dirty by xaccTransSetCurrency,
@@ -1266,6 +1266,8 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         return;
     }
 
+    /* Creating the transactions generates events for each split. */
+    qof_event_begin_batch();
     for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
     {
         GList *instance_iter;
@@ -1341,6 +1343,7 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         gnc_sx_set_instance_count(instances->sx, instance_count);
         xaccSchedXactionSetRemOccur(instances->sx, remain_occur_count);
     }
+    qof_event_end_batch();
 }
 
 void
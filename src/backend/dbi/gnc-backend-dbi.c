@@ -51,6 +51,7 @@
 #include "gnc-locale-utils.h"
 
 #include "gnc-backend-dbi.h"
+#include "gnc-slots-sql.h"
 
 #ifdef S_SPLINT_S
 #include "splint-defs.h"
@@ -1365,6 +1366,8 @@ gnc_dbi_session_end( QofBackend *be_start )
         be->sql_be.conn = NULL;
     }
     gnc_sql_finalize_version_info( &be->sql_be );
+    gnc_sql_finalize_statement_cache( &be->sql_be );
+    gnc_sql_slots_forget_saved( &be->sql_be );
 
     LEAVE (" ");
 }
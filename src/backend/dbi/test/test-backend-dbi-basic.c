@@ -122,6 +122,72 @@ setup_memory (Fixture *fixture, gconstpointer pData)
         fixture->filename = NULL;
 }
 
+/* A book with two accounts and LARGE_BOOK_TXNS two-split transactions
+ * between them, for timing saves. */
+#define LARGE_BOOK_TXNS 250000
+
+static void
+setup_large (Fixture *fixture, gconstpointer pData)
+{
+    QofSession* session = qof_session_new();
+    gchar *url = (gchar*)pData;
+    QofBook* book = qof_session_get_book (session);
+    Account *root = gnc_book_get_root_account (book);
+    Account *acct1, *acct2;
+    gnc_commodity_table* table;
+    gnc_commodity* currency;
+    time64 date = gnc_time (NULL);
+    gint i;
+
+    table = gnc_commodity_table_get_table (book);
+    currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "CAD");
+
+    acct1 = xaccMallocAccount (book);
+    xaccAccountSetType (acct1, ACCT_TYPE_BANK);
+    xaccAccountSetName (acct1, "Bank 1");
+    xaccAccountSetCommodity (acct1, currency);
+    gnc_account_append_child (root, acct1);
+
+    acct2 = xaccMallocAccount (book);
+    xaccAccountSetType (acct2, ACCT_TYPE_EXPENSE);
+    xaccAccountSetName (acct2, "Expense 1");
+    xaccAccountSetCommodity (acct2, currency);
+    gnc_account_append_child (root, acct2);
+
+    xaccAccountBeginEdit (acct1);
+    xaccAccountBeginEdit (acct2);
+    for (i = 0; i < LARGE_BOOK_TXNS; i++)
+    {
+        Transaction *tx = xaccMallocTransaction (book);
+        Split *spl1 = xaccMallocSplit (book);
+        Split *spl2 = xaccMallocSplit (book);
+        gnc_numeric amount = gnc_numeric_create (100 + i % 1000, 100);
+
+        xaccTransBeginEdit (tx);
+        xaccTransSetCurrency (tx, currency);
+        xaccTransSetDatePostedSecs (tx, date - (LARGE_BOOK_TXNS - i) * 600);
+        xaccTransSetDescription (tx, "Large book transaction");
+        xaccTransSetNotes (tx, "Large book notes");
+        xaccSplitSetParent (spl1, tx);
+        xaccSplitSetAccount (spl1, acct1);
+        xaccSplitSetAmount (spl1, gnc_numeric_neg (amount));
+        xaccSplitSetValue (spl1, gnc_numeric_neg (amount));
+        xaccSplitSetParent (spl2, tx);
+        xaccSplitSetAccount (spl2, acct2);
+        xaccSplitSetAmount (spl2, amount);
+        xaccSplitSetValue (spl2, amount);
+        xaccTransCommitEdit (tx);
+    }
+    xaccAccountCommitEdit (acct2);
+    xaccAccountCommitEdit (acct1);
+
+    fixture->session = session;
+    if (g_strcmp0 (url, "sqlite3") == 0)
+        fixture->filename = g_strdup_printf ("/tmp/test-sqlite-%d", getpid());
+    else
+        fixture->filename = NULL;
+}
+
 static void
 setup_business (Fixture *fixture, gconstpointer pData)
 {
@@ -560,6 +626,126 @@ test_dbi_business_store_and_reload (Fixture *fixture, gconstpointer pData)
     qof_session_destroy (session_3);
 }
 
+/* Edits the slots of an account in a saved session, which writes them
+ * through commit_edit, then reloads the book and compares. */
+static void
+test_dbi_edit_slots (Fixture *fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    QofSession* session_2;
+    QofSession* session_3;
+    Account *acct;
+    KvpFrame *frame;
+
+    if (fixture->filename)
+        url = fixture->filename;
+
+    session_2 = qof_session_new();
+    qof_session_begin (session_2, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+
+    acct = gnc_account_lookup_by_name (
+               gnc_book_get_root_account (qof_session_get_book (session_2)),
+               "Bank 1");
+    g_assert (acct != NULL);
+    frame = qof_instance_get_slots (QOF_INSTANCE (acct));
+
+    /* The first edit rewrites all of the slots ... */
+    xaccAccountBeginEdit (acct);
+    kvp_frame_set_gint64 (frame, "int64-val", 200);
+    kvp_frame_set_string (frame, "nested/frame/string-val", "qrstuvwxyz");
+    qof_instance_set_dirty (QOF_INSTANCE (acct));
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+
+    /* ... and later ones only the slots which changed. */
+    xaccAccountBeginEdit (acct);
+    kvp_frame_set_slot_nc (frame, "double-val", NULL);
+    kvp_frame_set_slot_nc (frame, "nested", NULL);
+    kvp_frame_set_string (frame, "string-val", "zyxwvutsrq");
+    kvp_frame_set_gint64 (frame, "other/int64-val", 300);
+    qof_instance_set_dirty (QOF_INSTANCE (acct));
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+
+    session_3 = qof_session_new();
+    qof_session_begin (session_3, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_3), ==, ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), ==, ERR_BACKEND_NO_ERR);
+    compare_books (qof_session_get_book (session_2),
+                   qof_session_get_book (session_3));
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
+/* Times a full save of a 500k split book; only run with -m perf. */
+static void
+test_dbi_save_large (Fixture *fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    QofSession* session_2;
+
+    if (fixture->filename)
+        url = fixture->filename;
+
+    session_2 = qof_session_new();
+    qof_session_begin (session_2, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+
+    g_test_timer_start ();
+    qof_session_save (session_2, NULL);
+    g_test_minimized_result (g_test_timer_elapsed (),
+                             "save %d splits", 2 * LARGE_BOOK_TXNS);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+}
+
+/* Times loading the book saved from setup_large, which has slots on
+ * every transaction; only run with -m perf. */
+static void
+test_dbi_load_large (Fixture *fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    QofSession* session_2;
+    QofSession* session_3;
+
+    if (fixture->filename)
+        url = fixture->filename;
+
+    session_2 = qof_session_new();
+    qof_session_begin (session_2, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), ==, ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    session_3 = qof_session_new();
+    qof_session_begin (session_3, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_3), ==, ERR_BACKEND_NO_ERR);
+    g_test_timer_start ();
+    qof_session_load (session_3, NULL);
+    g_test_minimized_result (g_test_timer_elapsed (),
+                             "load %d transactions", LARGE_BOOK_TXNS);
+    g_assert_cmpint (qof_session_get_error (session_3), ==, ERR_BACKEND_NO_ERR);
+    g_assert_cmpint (gnc_book_count_transactions (qof_session_get_book (session_3)),
+                     ==, LARGE_BOOK_TXNS);
+
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
 static void
 create_dbi_test_suite (gchar *dbm_name, gchar *url)
 {
@@ -572,6 +758,15 @@ create_dbi_test_suite (gchar *dbm_name, gchar *url)
                   test_dbi_version_control, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
                   setup_business, test_dbi_version_control, teardown);
+    GNC_TEST_ADD (subsuite, "edit_slots", Fixture, url, setup_memory,
+                  test_dbi_edit_slots, teardown);
+    if (g_test_perf () && g_strcmp0 (dbm_name, "sqlite3") == 0)
+    {
+        GNC_TEST_ADD (subsuite, "save_large", Fixture, url, setup_large,
+                      test_dbi_save_large, teardown);
+        GNC_TEST_ADD (subsuite, "load_large", Fixture, url, setup_large,
+                      test_dbi_load_large, teardown);
+    }
     g_free (subsuite);
 
 }
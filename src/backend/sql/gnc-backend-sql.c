@@ -98,6 +98,10 @@ static GncSqlStatement* build_delete_statement( GncSqlBackend* be,
         const gchar* table_name,
         QofIdTypeConst obj_name, gpointer pObject,
         const GncSqlColumnTableEntry* table );
+static gboolean add_pending_insert( GncSqlBackend* be,
+                                    const gchar* table_name,
+                                    QofIdTypeConst obj_name, gpointer pObject,
+                                    const GncSqlColumnTableEntry* table );
 
 #define TRANSACTION_NAME "trans"
 
@@ -227,6 +231,10 @@ gnc_sql_load( GncSqlBackend* be, /*@ dependent @*/ QofBook *book, QofBackendLoad
         g_assert( be->book == NULL );
         be->book = book;
 
+        /* Slots are read for all objects at once after they're loaded.
+         * Loaders which commit their objects flush the slots first. */
+        gnc_sql_slots_begin_bulk_load( be );
+
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for ( i = 0; fixed_load_order[i] != NULL; i++ )
         {
@@ -254,6 +262,7 @@ gnc_sql_load( GncSqlBackend* be, /*@ dependent @*/ QofBook *book, QofBackendLoad
         gnc_account_foreach_descendant( root, (AccountCb)xaccAccountBeginEdit, NULL );
 
         qof_object_foreach_backend( GNC_SQL_BACKEND, initial_load_cb, be );
+        gnc_sql_slots_end_bulk_load( be );
 
         gnc_account_foreach_descendant( root, (AccountCb)xaccAccountCommitEdit, NULL );
     }
@@ -454,6 +463,9 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
     be->operations_done = 0;
 
     is_ok = gnc_sql_connection_begin_transaction( be->conn );
+    /* Nothing is read back while saving, so the rows can be written
+     * with multi-row INSERTs. */
+    be->batch_inserts = TRUE;
 
     // FIXME: should write the set of commodities that are used
     //write_commodities( be, book );
@@ -482,6 +494,11 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
         qof_object_foreach_backend( GNC_SQL_BACKEND, write_cb, be );
     }
     if ( is_ok )
+    {
+        is_ok = gnc_sql_flush_pending_inserts( be );
+    }
+    be->batch_inserts = FALSE;
+    if ( is_ok )
     {
         is_ok = gnc_sql_connection_commit_transaction( be->conn );
     }
@@ -497,6 +514,8 @@ gnc_sql_sync_all( GncSqlBackend* be, /*@ dependent @*/ QofBook *book )
     else
     {
         qof_backend_set_error( (QofBackend*)be, ERR_BACKEND_SERVER_ERR );
+        gnc_sql_finalize_statement_cache( be );
+        gnc_sql_slots_forget_saved( be );
         is_ok = gnc_sql_connection_rollback_transaction( be->conn );
     }
     finish_progress( be );
@@ -610,11 +629,20 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
     be_data.inst = inst;
     be_data.is_ok = TRUE;
 
+    /* Collect the INSERTs for the object, its slots and its children so
+     * that each table gets a single statement. */
+    be->batch_inserts = TRUE;
     qof_object_foreach_backend( GNC_SQL_BACKEND, commit_cb, &be_data );
+    if ( be_data.is_ok )
+    {
+        be_data.is_ok = gnc_sql_flush_pending_inserts( be );
+    }
+    be->batch_inserts = FALSE;
 
     if ( !be_data.is_known )
     {
         PERR( "gnc_sql_commit_edit(): Unknown object type '%s'\n", inst->e_type );
+        gnc_sql_finalize_statement_cache( be );
         (void)gnc_sql_connection_rollback_transaction( be->conn );
 
         // Don't let unknown items still mark the book as being dirty
@@ -625,7 +653,18 @@ gnc_sql_commit_edit( GncSqlBackend *be, QofInstance *inst )
     }
     if ( !be_data.is_ok )
     {
-        // Error - roll it back
+        gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+
+        /* The rows of the object and its children were sent together, so
+         * an error may only show up when they are flushed: report it
+         * against the object being committed. */
+        (void)guid_to_string_buff( qof_instance_get_guid( inst ), guid_buf );
+        PERR( "gnc_sql_commit_edit(): Failed to save %s %s\n",
+              inst->e_type, guid_buf );
+
+        // Error - roll it back, along with what we remember of the slots
+        gnc_sql_finalize_statement_cache( be );
+        gnc_sql_slots_forget_saved( be );
         (void)gnc_sql_connection_rollback_transaction( be->conn );
 
         // This *should* leave things marked dirty
@@ -2477,6 +2516,7 @@ gnc_sql_execute_select_statement( GncSqlBackend* be, GncSqlStatement* stmt )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( stmt != NULL, NULL );
 
+    if ( !gnc_sql_flush_pending_inserts( be ) ) return NULL;
     result = gnc_sql_connection_execute_select_statement( be->conn, stmt );
     if ( result == NULL )
     {
@@ -2514,6 +2554,7 @@ gnc_sql_execute_select_sql( GncSqlBackend* be, const gchar* sql )
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( sql != NULL, NULL );
 
+    if ( !gnc_sql_flush_pending_inserts( be ) ) return NULL;
     stmt = gnc_sql_create_statement_from_sql( be, sql );
     if ( stmt == NULL )
     {
@@ -2539,6 +2580,7 @@ gnc_sql_execute_nonselect_sql( GncSqlBackend* be, const gchar* sql )
     g_return_val_if_fail( be != NULL, 0 );
     g_return_val_if_fail( sql != NULL, 0 );
 
+    if ( !gnc_sql_flush_pending_inserts( be ) ) return -1;
     stmt = gnc_sql_create_statement_from_sql( be, sql );
     if ( stmt == NULL )
     {
@@ -2653,6 +2695,15 @@ gnc_sql_do_db_operation( GncSqlBackend* be,
     g_return_val_if_fail( pObject != NULL, FALSE );
     g_return_val_if_fail( table != NULL, FALSE );
 
+    if ( op == OP_DB_INSERT && be->batch_inserts )
+    {
+        return add_pending_insert( be, table_name, obj_name, pObject, table );
+    }
+    if ( !gnc_sql_flush_pending_inserts( be ) )
+    {
+        return FALSE;
+    }
+
     if ( op == OP_DB_INSERT )
     {
         stmt = build_insert_statement( be, table_name, obj_name, pObject, table );
@@ -2797,32 +2848,91 @@ free_gvalue_list( GSList* list )
     g_slist_free( list );
 }
 
-/*@ null @*/ static GncSqlStatement*
-build_insert_statement( GncSqlBackend* be,
-                        const gchar* table_name,
-                        QofIdTypeConst obj_name, gpointer pObject,
-                        const GncSqlColumnTableEntry* table )
+/* ================================================================= */
+/* Statement templates
+
+   The SQL text in front of the values of an INSERT, UPDATE or DELETE
+   only depends on the table and its column description, so it is built
+   once per backend and reused; only the values are formatted for each
+   object.  While be->batch_inserts is set, the INSERTs into each table
+   are collected into multi-row INSERTs.  Nothing is read back while the
+   rows are pending: every statement executed through this file first
+   flushes them.
+ */
+
+/* Keep multi-row INSERTs below SQLite's compound select limit (500) and
+ * well below the default MySQL packet size. */
+#define INSERT_BATCH_MAX_ROWS 250
+#define INSERT_BATCH_MAX_BYTES (512 * 1024)
+
+typedef struct
 {
-    GncSqlStatement* stmt;
-    GString* sql;
-    GSList* values;
-    GSList* node;
-    gchar* sqlbuf;
-    GList* colnames = NULL;
+    E_DB_OPERATION op;
+    const GncSqlColumnTableEntry* table;
+    gchar* table_name;
+} StatementTemplateKey;
+
+typedef struct
+{
+    gchar* sql;         /* "INSERT INTO t(a,b) VALUES", "UPDATE t SET ", ... */
+    GList* colnames;    /* Column names, in the order of the value list */
+    GString* pending;   /* Multi-row INSERT being collected, or NULL */
+    gint pending_rows;
+} StatementTemplate;
+
+static guint
+statement_template_key_hash( gconstpointer key )
+{
+    const StatementTemplateKey* k = key;
+
+    return g_str_hash( k->table_name ) ^ g_direct_hash( k->table ) ^ (guint)k->op;
+}
+
+static gboolean
+statement_template_key_equal( gconstpointer a, gconstpointer b )
+{
+    const StatementTemplateKey* ka = a;
+    const StatementTemplateKey* kb = b;
+
+    return ka->op == kb->op && ka->table == kb->table &&
+           strcmp( ka->table_name, kb->table_name ) == 0;
+}
+
+static void
+statement_template_key_free( gpointer key )
+{
+    StatementTemplateKey* k = key;
+
+    g_free( k->table_name );
+    g_free( k );
+}
+
+static void
+statement_template_free( gpointer data )
+{
+    StatementTemplate* tmpl = data;
     GList* colname;
-    const GncSqlColumnTableEntry* table_row;
 
-    g_return_val_if_fail( be != NULL, NULL );
-    g_return_val_if_fail( table_name != NULL, NULL );
-    g_return_val_if_fail( obj_name != NULL, NULL );
-    g_return_val_if_fail( pObject != NULL, NULL );
-    g_return_val_if_fail( table != NULL, NULL );
+    for ( colname = tmpl->colnames; colname != NULL; colname = colname->next )
+    {
+        g_free( colname->data );
+    }
+    g_list_free( tmpl->colnames );
+    g_free( tmpl->sql );
+    if ( tmpl->pending != NULL )
+    {
+        PWARN( "Discarding %d unwritten rows: %s", tmpl->pending_rows, tmpl->sql );
+        (void)g_string_free( tmpl->pending, TRUE );
+    }
+    g_free( tmpl );
+}
 
-    sqlbuf = g_strdup_printf( "INSERT INTO %s(", table_name );
-    sql = g_string_new( sqlbuf );
-    g_free( sqlbuf );
+static GList*
+get_colnames( const GncSqlColumnTableEntry* table )
+{
+    GList* colnames = NULL;
+    const GncSqlColumnTableEntry* table_row;
 
-    // Get all col names and all values
     for ( table_row = table; table_row->col_name != NULL; table_row++ )
     {
         if (( table_row->flags & COL_AUTOINC ) == 0 )
@@ -2836,19 +2946,94 @@ build_insert_statement( GncSqlBackend* be,
         }
     }
     g_assert( colnames != NULL );
+    return colnames;
+}
+
+static StatementTemplate*
+get_statement_template( GncSqlBackend* be, E_DB_OPERATION op,
+                        const gchar* table_name,
+                        const GncSqlColumnTableEntry* table )
+{
+    StatementTemplateKey key;
+    StatementTemplateKey* new_key;
+    StatementTemplate* tmpl;
+
+    if ( be->stmt_templates == NULL )
+    {
+        be->stmt_templates = g_hash_table_new_full( statement_template_key_hash,
+                             statement_template_key_equal,
+                             statement_template_key_free,
+                             statement_template_free );
+    }
 
-    for ( colname = colnames; colname != NULL; colname = colname->next )
+    key.op = op;
+    key.table = table;
+    key.table_name = (gchar*)table_name;
+    tmpl = g_hash_table_lookup( be->stmt_templates, &key );
+    if ( tmpl != NULL ) return tmpl;
+
+    tmpl = g_new0( StatementTemplate, 1 );
+    if ( op == OP_DB_INSERT )
     {
-        if ( colname != colnames )
+        GString* sql = g_string_new( NULL );
+        GList* colname;
+
+        tmpl->colnames = get_colnames( table );
+        g_string_printf( sql, "INSERT INTO %s(", table_name );
+        for ( colname = tmpl->colnames; colname != NULL; colname = colname->next )
         {
-            g_string_append( sql, "," );
+            if ( colname != tmpl->colnames )
+            {
+                g_string_append( sql, "," );
+            }
+            g_string_append( sql, (gchar*)colname->data );
         }
-        g_string_append( sql, (gchar*)colname->data );
-        g_free( colname->data );
+        g_string_append( sql, ") VALUES" );
+        tmpl->sql = g_string_free( sql, FALSE );
+    }
+    else if ( op == OP_DB_UPDATE )
+    {
+        tmpl->colnames = get_colnames( table );
+        tmpl->sql = g_strdup_printf( "UPDATE %s SET ", table_name );
+    }
+    else
+    {
+        tmpl->sql = g_strdup_printf( "DELETE FROM %s ", table_name );
+    }
+
+    new_key = g_new( StatementTemplateKey, 1 );
+    new_key->op = op;
+    new_key->table = table;
+    new_key->table_name = g_strdup( table_name );
+    g_hash_table_insert( be->stmt_templates, new_key, tmpl );
+
+    return tmpl;
+}
+
+void
+gnc_sql_finalize_statement_cache( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    g_list_free( be->pending_inserts );
+    be->pending_inserts = NULL;
+    if ( be->stmt_templates != NULL )
+    {
+        g_hash_table_destroy( be->stmt_templates );
+        be->stmt_templates = NULL;
     }
-    g_list_free( colnames );
+}
 
-    g_string_append( sql, ") VALUES(" );
+/* Appends "(value,value,...)" for the object to sql. */
+static void
+append_row_values( GncSqlBackend* be, GString* sql,
+                   QofIdTypeConst obj_name, gpointer pObject,
+                   const GncSqlColumnTableEntry* table )
+{
+    GSList* values;
+    GSList* node;
+
+    (void)g_string_append( sql, "(" );
     values = create_gslist_from_values( be, obj_name, pObject, table );
     for ( node = values; node != NULL; node = node->next )
     {
@@ -2865,6 +3050,108 @@ build_insert_statement( GncSqlBackend* be,
     }
     free_gvalue_list( values );
     (void)g_string_append( sql, ")" );
+}
+
+static gboolean
+flush_template_inserts( GncSqlBackend* be, StatementTemplate* tmpl )
+{
+    GString* sql = tmpl->pending;
+    GncSqlStatement* stmt;
+    gint result = -1;
+
+    tmpl->pending = NULL;
+    tmpl->pending_rows = 0;
+
+    stmt = gnc_sql_create_statement_from_sql( be, sql->str );
+    if ( stmt != NULL )
+    {
+        result = gnc_sql_connection_execute_nonselect_statement( be->conn, stmt );
+        gnc_sql_statement_dispose( stmt );
+    }
+    if ( result == -1 )
+    {
+        PERR( "SQL error: %.200s...\n", sql->str );
+        qof_backend_set_error( &be->be, ERR_BACKEND_SERVER_ERR );
+    }
+    (void)g_string_free( sql, TRUE );
+
+    return result != -1;
+}
+
+gboolean
+gnc_sql_flush_pending_inserts( GncSqlBackend* be )
+{
+    GList* pending;
+    GList* node;
+    gboolean is_ok = TRUE;
+
+    g_return_val_if_fail( be != NULL, FALSE );
+
+    if ( be->pending_inserts == NULL ) return TRUE;
+
+    pending = g_list_reverse( be->pending_inserts );
+    be->pending_inserts = NULL;
+    for ( node = pending; node != NULL; node = node->next )
+    {
+        if ( !flush_template_inserts( be, node->data ) )
+        {
+            is_ok = FALSE;
+        }
+    }
+    g_list_free( pending );
+
+    return is_ok;
+}
+
+/* Adds the object's row to the multi-row INSERT collected for its table. */
+static gboolean
+add_pending_insert( GncSqlBackend* be, const gchar* table_name,
+                    QofIdTypeConst obj_name, gpointer pObject,
+                    const GncSqlColumnTableEntry* table )
+{
+    StatementTemplate* tmpl;
+
+    tmpl = get_statement_template( be, OP_DB_INSERT, table_name, table );
+    if ( tmpl->pending == NULL )
+    {
+        tmpl->pending = g_string_new( tmpl->sql );
+        be->pending_inserts = g_list_prepend( be->pending_inserts, tmpl );
+    }
+    else
+    {
+        (void)g_string_append( tmpl->pending, "," );
+    }
+    append_row_values( be, tmpl->pending, obj_name, pObject, table );
+    tmpl->pending_rows++;
+
+    if ( tmpl->pending_rows >= INSERT_BATCH_MAX_ROWS ||
+            tmpl->pending->len >= INSERT_BATCH_MAX_BYTES )
+    {
+        be->pending_inserts = g_list_remove( be->pending_inserts, tmpl );
+        return flush_template_inserts( be, tmpl );
+    }
+    return TRUE;
+}
+
+/*@ null @*/ static GncSqlStatement*
+build_insert_statement( GncSqlBackend* be,
+                        const gchar* table_name,
+                        QofIdTypeConst obj_name, gpointer pObject,
+                        const GncSqlColumnTableEntry* table )
+{
+    GncSqlStatement* stmt;
+    GString* sql;
+    const StatementTemplate* tmpl;
+
+    g_return_val_if_fail( be != NULL, NULL );
+    g_return_val_if_fail( table_name != NULL, NULL );
+    g_return_val_if_fail( obj_name != NULL, NULL );
+    g_return_val_if_fail( pObject != NULL, NULL );
+    g_return_val_if_fail( table != NULL, NULL );
+
+    tmpl = get_statement_template( be, OP_DB_INSERT, table_name, table );
+    sql = g_string_new( tmpl->sql );
+    append_row_values( be, sql, obj_name, pObject, table );
 
     stmt = gnc_sql_connection_create_statement_from_sql( be->conn, sql->str );
     (void)g_string_free( sql, TRUE );
@@ -2881,12 +3168,10 @@ build_update_statement( GncSqlBackend* be,
     GncSqlStatement* stmt;
     GString* sql;
     GSList* values;
-    GList* colnames = NULL;
     GSList* value;
     GList* colname;
     gboolean firstCol;
-    const GncSqlColumnTableEntry* table_row;
-    gchar* sqlbuf;
+    const StatementTemplate* tmpl;
 
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( table_name != NULL, NULL );
@@ -2894,29 +3179,14 @@ build_update_statement( GncSqlBackend* be,
     g_return_val_if_fail( pObject != NULL, NULL );
     g_return_val_if_fail( table != NULL, NULL );
 
-    // Get all col names and all values
-    for ( table_row = table; table_row->col_name != NULL; table_row++ )
-    {
-        if (( table_row->flags & COL_AUTOINC ) == 0 )
-        {
-            GncSqlColumnTypeHandler* pHandler;
-
-            // Add col names to the list
-            pHandler = get_handler( table_row );
-            g_assert( pHandler != NULL );
-            pHandler->add_colname_to_list_fn( table_row, &colnames );
-        }
-    }
-    g_assert( colnames != NULL );
+    tmpl = get_statement_template( be, OP_DB_UPDATE, table_name, table );
     values = create_gslist_from_values( be, obj_name, pObject, table );
 
     // Create the SQL statement
-    sqlbuf = g_strdup_printf( "UPDATE %s SET ", table_name );
-    sql = g_string_new( sqlbuf );
-    g_free( sqlbuf );
+    sql = g_string_new( tmpl->sql );
 
     firstCol = TRUE;
-    for ( colname = colnames->next, value = values->next;
+    for ( colname = tmpl->colnames->next, value = values->next;
             colname != NULL && value != NULL;
             colname = colname->next, value = value->next )
     {
@@ -2932,11 +3202,6 @@ build_update_statement( GncSqlBackend* be,
         g_free( value_str );
         firstCol = FALSE;
     }
-    for ( colname = colnames; colname != NULL; colname = colname->next )
-    {
-        g_free( colname->data );
-    }
-    g_list_free( colnames );
     if ( value != NULL || colname != NULL )
     {
         PERR( "Mismatch in number of column names and values" );
@@ -2959,7 +3224,7 @@ build_delete_statement( GncSqlBackend* be,
     GncSqlStatement* stmt;
     GncSqlColumnTypeHandler* pHandler;
     GSList* list = NULL;
-    gchar* sqlbuf;
+    const StatementTemplate* tmpl;
 
     g_return_val_if_fail( be != NULL, NULL );
     g_return_val_if_fail( table_name != NULL, NULL );
@@ -2967,9 +3232,8 @@ build_delete_statement( GncSqlBackend* be,
     g_return_val_if_fail( pObject != NULL, NULL );
     g_return_val_if_fail( table != NULL, NULL );
 
-    sqlbuf = g_strdup_printf( "DELETE FROM %s ", table_name );
-    stmt = gnc_sql_connection_create_statement_from_sql( be->conn, sqlbuf );
-    g_free( sqlbuf );
+    tmpl = get_statement_template( be, OP_DB_DELETE, table_name, table );
+    stmt = gnc_sql_connection_create_statement_from_sql( be->conn, tmpl->sql );
 
     /* WHERE */
     pHandler = get_handler( table );
@@ -63,6 +63,11 @@ struct GncSqlBackend
     gint operations_done;			/**< Number of operations (save/load) done */
     GHashTable* versions;			/**< Version number for each table */
     const gchar* timespec_format;	/**< Format string for SQL for timespec values */
+    GHashTable* stmt_templates;	/**< SQL text per table and operation */
+    gboolean batch_inserts;		/**< Collect INSERTs into multi-row statements */
+    GList* pending_inserts;		/**< Templates with rows waiting to be inserted */
+    GHashTable* saved_slots;		/**< Slots frame last written, per object guid */
+    GHashTable* slot_owners;		/**< Objects waiting for a bulk slots load */
 };
 typedef struct GncSqlBackend GncSqlBackend;
 
@@ -442,6 +447,23 @@ gboolean gnc_sql_do_db_operation( GncSqlBackend* be,
                                   gpointer pObject,
                                   const GncSqlColumnTableEntry* table );
 
+/**
+ * Executes the rows collected for multi-row INSERTs while
+ * be->batch_inserts is set.  Does nothing if no rows are pending.
+ *
+ * @param be SQL backend struct
+ * @return TRUE if successful, FALSE if not
+ */
+gboolean gnc_sql_flush_pending_inserts( GncSqlBackend* be );
+
+/**
+ * Frees the cached statement templates and discards any rows still
+ * pending for multi-row INSERTs.
+ *
+ * @param be SQL backend struct
+ */
+void gnc_sql_finalize_statement_cache( GncSqlBackend* be );
+
 /**
  * Executes an SQL SELECT statement and returns the result rows.  If an error
  * occurs, an entry is added to the log, an error status is returned to qof and
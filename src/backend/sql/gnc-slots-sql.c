@@ -67,8 +67,36 @@ typedef struct
     /*@ dependent @*/
     KvpValue* pKvpValue;
     GString* path;
+    /*@ dependent @*/
+    struct slots_bulk_load* bulk;
 } slot_info_t;
 
+/* State of gnc_sql_slots_end_bulk_load() and gnc_sql_slots_flush_bulk_load() */
+typedef struct slots_bulk_load
+{
+    GHashTable* containers;	/* Nested frames and lists, by guid */
+    GSList* lists;		/* Lists to attach once all rows are read */
+    gboolean is_targeted;	/* Only the rows of the owners are read */
+    GSList* wanted;		/* Containers whose rows still have to be read */
+} slots_bulk_load_t;
+
+/* Target of the rows of a nested frame or list during a bulk load */
+typedef struct
+{
+    slot_info_t info;
+    GncGUID guid;
+    gboolean is_attached;
+} slots_container_t;
+
+/* A list slot, attached after the pass because its items may come later */
+typedef struct
+{
+    /*@ dependent @*/
+    KvpFrame* pKvpFrame;
+    gchar* key;
+    GncGUID guid;
+} slots_pending_list_t;
+
 
 static /*@ null @*/ gpointer get_obj_guid( gpointer pObject );
 static void set_obj_guid( void );
@@ -92,9 +120,11 @@ static GDate* get_gdate_val( gpointer pObject );
 static void set_gdate_val( gpointer pObject, GDate* value );
 static slot_info_t *slot_info_copy( slot_info_t *pInfo, GncGUID *guid );
 static void slots_load_info( slot_info_t *pInfo );
+static void attach_bulk_container( slot_info_t *pInfo, const GncGUID *guid );
 
 #define SLOT_MAX_PATHNAME_LEN 4096
 #define SLOT_MAX_STRINGVAL_LEN 4096
+#define SLOTS_BULK_MAX_GUIDS 500
 enum
 {
     id_col = 0,
@@ -481,6 +511,13 @@ set_guid_val( gpointer pObject, /*@ null @*/ gpointer pValue )
     g_return_if_fail( pObject != NULL );
     if ( pValue == NULL ) return;
 
+    if ( pInfo->bulk != NULL && ( pInfo->value_type == KVP_TYPE_GLIST ||
+                                  pInfo->value_type == KVP_TYPE_FRAME ) )
+    {
+        attach_bulk_container( pInfo, (GncGUID*)pValue );
+        return;
+    }
+
     switch ( pInfo->value_type)
     {
     case KVP_TYPE_GUID:
@@ -621,6 +658,7 @@ slot_info_copy( slot_info_t *pInfo, GncGUID *guid )
     newSlot->context = pInfo->context;
     newSlot->pKvpValue = pInfo->pKvpValue;
     newSlot->path = g_string_new(pInfo->path->str);
+    newSlot->bulk = pInfo->bulk;
     return newSlot;
 }
 
@@ -706,81 +744,287 @@ save_slot( const gchar* key, KvpValue* value, gpointer data )
     (void)g_string_truncate( pSlot_info->path, curlen );
 }
 
-gboolean
-gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid, gboolean is_infant, KvpFrame* pFrame )
+/* ================================================================= */
+/* The frames as they were last written to the db, keyed by object guid.
+ * When an object which has been saved before is saved again, its frame is
+ * compared to this copy and only the top-level slots which differ are
+ * rewritten.  Objects which have only been loaded or written by a full
+ * save aren't kept here, so the first save of those rewrites all of the
+ * slots.  At most SAVED_SLOTS_MAX frames are kept; when the table is full
+ * it is emptied, which only costs the next save of each object a full
+ * rewrite. */
+#define SAVED_SLOTS_MAX 1024
+
+static KvpFrame*
+get_saved_frame( const GncSqlBackend* be, const GncGUID* guid )
 {
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, g_string_new('\0') };
-
-    g_return_val_if_fail( be != NULL, FALSE );
-    g_return_val_if_fail( guid != NULL, FALSE );
-    g_return_val_if_fail( pFrame != NULL, FALSE );
+    if ( be->saved_slots == NULL ) return NULL;
+    return g_hash_table_lookup( be->saved_slots, guid );
+}
 
-    // If this is not saving into a new db, clear out the old saved slots first
-    if ( !be->is_pristine_db && !is_infant )
+static void
+set_saved_frame( GncSqlBackend* be, const GncGUID* guid, const KvpFrame* pFrame )
+{
+    if ( be->saved_slots == NULL )
+    {
+        be->saved_slots = g_hash_table_new_full( guid_hash_to_guint,
+                          guid_g_hash_table_equal,
+                          (GDestroyNotify)guid_free,
+                          (GDestroyNotify)kvp_frame_delete );
+    }
+    else if ( g_hash_table_size( be->saved_slots ) >= SAVED_SLOTS_MAX &&
+              g_hash_table_lookup( be->saved_slots, guid ) == NULL )
     {
-        (void)gnc_sql_slots_delete( be, guid );
+        g_hash_table_remove_all( be->saved_slots );
     }
+    g_hash_table_replace( be->saved_slots, guid_copy( guid ),
+                          kvp_frame_copy( pFrame ) );
+}
 
-    slot_info.be = be;
-    slot_info.guid = guid;
-    kvp_frame_for_each_slot( pFrame, save_slot, &slot_info );
-    (void)g_string_free( slot_info.path, TRUE );
+static void
+forget_saved_frame( GncSqlBackend* be, const GncGUID* guid )
+{
+    if ( be->saved_slots == NULL ) return;
+    (void)g_hash_table_remove( be->saved_slots, guid );
+}
 
-    return slot_info.is_ok;
+void
+gnc_sql_slots_forget_saved( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->saved_slots != NULL )
+    {
+        g_hash_table_destroy( be->saved_slots );
+        be->saved_slots = NULL;
+    }
 }
 
-gboolean
-gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid )
+/* Appends "'guid'" to the comma separated list in str. */
+static void
+append_guid_to_list( GString* str, const gchar* guid_str )
 {
-    gchar* buf;
-    GncSqlResult* result;
-    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
-    GncSqlStatement* stmt;
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, g_string_new('\0') };
+    if ( str->len != 0 )
+    {
+        (void)g_string_append_c( str, ',' );
+    }
+    g_string_append_printf( str, "'%s'", guid_str );
+}
 
-    g_return_val_if_fail( be != NULL, FALSE );
-    g_return_val_if_fail( guid != NULL, FALSE );
+/*
+ * Deletes the slots of an object, or only the slot named key if key isn't
+ * NULL.  If the slots may contain frames or lists, the guids of their
+ * children are collected with one SELECT per level of nesting, and all of
+ * the rows are then removed with a single DELETE.
+ */
+static gboolean
+delete_slot_tree( GncSqlBackend* be, const GncGUID* guid, const gchar* key,
+                  gboolean has_children )
+{
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    gchar* where_clause;
+    gchar* level;
+    gchar* buf;
+    GString* children = g_string_new( NULL );
+    gboolean is_ok = TRUE;
 
     (void)guid_to_string_buff( guid, guid_buf );
+    if ( key == NULL )
+    {
+        where_clause = g_strdup_printf( "obj_guid='%s'", guid_buf );
+    }
+    else
+    {
+        gchar* quoted_key = gnc_sql_connection_quote_string( be->conn,
+                            (gchar*)key );
+        where_clause = g_strdup_printf( "obj_guid='%s' AND name=%s",
+                                        guid_buf, quoted_key );
+        g_free( quoted_key );
+    }
 
-    buf = g_strdup_printf( "SELECT * FROM %s WHERE obj_guid='%s' and slot_type in ('%d', '%d') and not guid_val is null",
-                           TABLE_NAME, guid_buf, KVP_TYPE_FRAME, KVP_TYPE_GLIST );
-    stmt = gnc_sql_create_statement_from_sql( be, buf );
-    g_free( buf );
-    if ( stmt != NULL )
+    level = has_children ? g_strdup( where_clause ) : NULL;
+    while ( level != NULL )
     {
+        GncSqlStatement* stmt;
+        GncSqlResult* result;
+        GncSqlRow* row;
+        GString* next_level;
+
+        buf = g_strdup_printf( "SELECT guid_val FROM %s WHERE (%s) and slot_type in ('%d', '%d') and not guid_val is null",
+                               TABLE_NAME, level, KVP_TYPE_FRAME, KVP_TYPE_GLIST );
+        g_free( level );
+        level = NULL;
+        stmt = gnc_sql_create_statement_from_sql( be, buf );
+        g_free( buf );
+        if ( stmt == NULL )
+        {
+            is_ok = FALSE;
+            break;
+        }
         result = gnc_sql_execute_select_statement( be, stmt );
         gnc_sql_statement_dispose( stmt );
-        if ( result != NULL )
+        if ( result == NULL )
         {
-            GncSqlRow* row = gnc_sql_result_get_first_row( result );
+            is_ok = FALSE;
+            break;
+        }
 
-            while ( row != NULL )
+        next_level = g_string_new( NULL );
+        for ( row = gnc_sql_result_get_first_row( result ); row != NULL;
+                row = gnc_sql_result_get_next_row( result ) )
+        {
+            const GValue* val = gnc_sql_row_get_value_at_col_name( row, "guid_val" );
+            if ( val == NULL || !G_VALUE_HOLDS_STRING( val ) ||
+                    g_value_get_string( val ) == NULL )
             {
-                GncSqlColumnTableEntry table_row = col_table[guid_val_col];
-                GncGUID child_guid;
-                const GValue* val =
-                    gnc_sql_row_get_value_at_col_name( row, table_row.col_name);
-                if ( val == NULL )
-                    continue;
-
-                (void)string_to_guid( g_value_get_string( val ), &child_guid );
-                gnc_sql_slots_delete( be, &child_guid );
-                row = gnc_sql_result_get_next_row( result );
+                continue;
             }
-            gnc_sql_result_dispose( result );
+            append_guid_to_list( next_level, g_value_get_string( val ) );
+            append_guid_to_list( children, g_value_get_string( val ) );
         }
+        gnc_sql_result_dispose( result );
+
+        if ( next_level->len != 0 )
+        {
+            level = g_strdup_printf( "obj_guid in (%s)", next_level->str );
+        }
+        (void)g_string_free( next_level, TRUE );
+    }
+
+    if ( is_ok )
+    {
+        if ( children->len == 0 )
+        {
+            buf = g_strdup_printf( "DELETE FROM %s WHERE %s",
+                                   TABLE_NAME, where_clause );
+        }
+        else
+        {
+            buf = g_strdup_printf( "DELETE FROM %s WHERE (%s) OR obj_guid in (%s)",
+                                   TABLE_NAME, where_clause, children->str );
+        }
+        is_ok = ( gnc_sql_execute_nonselect_sql( be, buf ) >= 0 );
+        g_free( buf );
     }
 
+    g_free( where_clause );
+    (void)g_string_free( children, TRUE );
+    return is_ok;
+}
+
+typedef struct
+{
+    slot_info_t* pInfo;
+    /*@ dependent @*/
+    KvpFrame* pOther;
+} slot_diff_t;
+
+static gboolean
+is_container_type( KvpValueType type )
+{
+    return type == KVP_TYPE_FRAME || type == KVP_TYPE_GLIST;
+}
+
+/* Called for each slot of the saved frame: deletes the rows of slots which
+ * have been removed or changed since. */
+static void
+delete_changed_slot( const gchar* key, KvpValue* value, gpointer data )
+{
+    slot_diff_t* diff = (slot_diff_t*)data;
+    KvpValue* new_value;
+
+    if ( !diff->pInfo->is_ok ) return;
+
+    new_value = kvp_frame_get_slot( diff->pOther, key );
+    if ( new_value != NULL && kvp_value_compare( value, new_value ) == 0 )
+    {
+        return;
+    }
+    diff->pInfo->is_ok = delete_slot_tree( diff->pInfo->be, diff->pInfo->guid,
+                                           key, is_container_type( kvp_value_get_type( value ) ) );
+}
+
+/* Called for each slot of the new frame: writes the slots which have been
+ * added or changed since the frame was saved. */
+static void
+save_changed_slot( const gchar* key, KvpValue* value, gpointer data )
+{
+    slot_diff_t* diff = (slot_diff_t*)data;
+    KvpValue* old_value;
+
+    if ( !diff->pInfo->is_ok ) return;
+
+    old_value = kvp_frame_get_slot( diff->pOther, key );
+    if ( old_value != NULL && kvp_value_compare( old_value, value ) == 0 )
+    {
+        return;
+    }
+    save_slot( key, value, diff->pInfo );
+}
+
+gboolean
+gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid, gboolean is_infant, KvpFrame* pFrame )
+{
+    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, 0, NULL, FRAME, NULL, g_string_new('\0') };
+    KvpFrame* pSaved;
+
+    g_return_val_if_fail( be != NULL, FALSE );
+    g_return_val_if_fail( guid != NULL, FALSE );
+    g_return_val_if_fail( pFrame != NULL, FALSE );
+
     slot_info.be = be;
     slot_info.guid = guid;
-    slot_info.is_ok = TRUE;
-    slot_info.is_ok = gnc_sql_do_db_operation( be, OP_DB_DELETE, TABLE_NAME,
-                      TABLE_NAME, &slot_info, obj_guid_col_table );
+
+    pSaved = get_saved_frame( be, guid );
+    if ( pSaved != NULL && !is_infant )
+    {
+        // Only write the slots which differ from the last save
+        slot_diff_t diff;
+
+        diff.pInfo = &slot_info;
+        diff.pOther = pFrame;
+        kvp_frame_for_each_slot( pSaved, delete_changed_slot, &diff );
+        diff.pOther = pSaved;
+        kvp_frame_for_each_slot( pFrame, save_changed_slot, &diff );
+    }
+    else
+    {
+        // If this is not saving into a new db, clear out the old saved slots first
+        if ( !be->is_pristine_db && !is_infant )
+        {
+            slot_info.is_ok = delete_slot_tree( be, guid, NULL, TRUE );
+        }
+        if ( slot_info.is_ok )
+        {
+            kvp_frame_for_each_slot( pFrame, save_slot, &slot_info );
+        }
+    }
+    (void)g_string_free( slot_info.path, TRUE );
+
+    /* A full save writes every object once, so there's nothing to gain
+     * from keeping copies of the frames it writes. */
+    if ( slot_info.is_ok && !be->is_pristine_db )
+    {
+        set_saved_frame( be, guid, pFrame );
+    }
+    else
+    {
+        forget_saved_frame( be, guid );
+    }
 
     return slot_info.is_ok;
 }
 
+gboolean
+gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid )
+{
+    g_return_val_if_fail( be != NULL, FALSE );
+    g_return_val_if_fail( guid != NULL, FALSE );
+
+    forget_saved_frame( be, guid );
+    return delete_slot_tree( be, guid, NULL, TRUE );
+}
+
 static void
 load_slot( slot_info_t *pInfo, GncSqlRow* row )
 {
@@ -921,6 +1165,20 @@ gnc_sql_slots_load_for_list( GncSqlBackend* be, GList* list )
     // Ignore empty list
     if ( list == NULL ) return;
 
+    // Bulk loading: the slots are attached by gnc_sql_slots_end_bulk_load()
+    if ( be->slot_owners != NULL )
+    {
+        GList* node;
+
+        for ( node = list; node != NULL; node = node->next )
+        {
+            QofInstance* inst = QOF_INSTANCE(node->data);
+            g_hash_table_insert( be->slot_owners,
+                                 (gpointer)qof_instance_get_guid( inst ), inst );
+        }
+        return;
+    }
+
     coll = qof_instance_get_collection( QOF_INSTANCE(list->data) );
 
     // Create the query for all slots for all items on the list
@@ -994,6 +1252,47 @@ load_slot_for_book_object( GncSqlBackend* be, GncSqlRow* row, BookLookupFn looku
     }
 }
 
+/* Registers the objects returned by the subquery for bulk loading. */
+static void
+add_slot_owners_from_subquery( GncSqlBackend* be, const gchar* subquery,
+                               BookLookupFn lookup_fn )
+{
+    GncSqlStatement* stmt;
+    GncSqlResult* result;
+    GncSqlRow* row;
+
+    stmt = gnc_sql_create_statement_from_sql( be, subquery );
+    if ( stmt == NULL )
+    {
+        PERR( "stmt == NULL, SQL = '%s'\n", subquery );
+        return;
+    }
+    result = gnc_sql_execute_select_statement( be, stmt );
+    gnc_sql_statement_dispose( stmt );
+    if ( result == NULL ) return;
+
+    for ( row = gnc_sql_result_get_first_row( result ); row != NULL;
+            row = gnc_sql_result_get_next_row( result ) )
+    {
+        const GValue* val = gnc_sql_row_get_value_at_col_name( row, "guid" );
+        GncGUID guid;
+        QofInstance* inst;
+
+        if ( val == NULL || !G_VALUE_HOLDS_STRING( val ) ||
+                !string_to_guid( g_value_get_string( val ), &guid ) )
+        {
+            continue;
+        }
+        inst = lookup_fn( &guid, be->book );
+        if ( inst != NULL )
+        {
+            g_hash_table_insert( be->slot_owners,
+                                 (gpointer)qof_instance_get_guid( inst ), inst );
+        }
+    }
+    gnc_sql_result_dispose( result );
+}
+
 /**
  * gnc_sql_slots_load_for_sql_subquery - Loads slots for all objects whose guid is
  * supplied by a subquery.  The subquery should be of the form "SELECT DISTINCT guid FROM ...".
@@ -1015,6 +1314,12 @@ void gnc_sql_slots_load_for_sql_subquery( GncSqlBackend* be, const gchar* subque
     // Ignore empty subquery
     if ( subquery == NULL ) return;
 
+    if ( be->slot_owners != NULL )
+    {
+        add_slot_owners_from_subquery( be, subquery, lookup_fn );
+        return;
+    }
+
     sql = g_strdup_printf( "SELECT * FROM %s WHERE %s IN (%s)",
                            TABLE_NAME, obj_guid_col_table[0].col_name,
                            subquery );
@@ -1043,6 +1348,314 @@ void gnc_sql_slots_load_for_sql_subquery( GncSqlBackend* be, const gchar* subque
     }
 }
 
+/* ================================================================= */
+/* Bulk loading.  Between gnc_sql_slots_begin_bulk_load() and
+ * gnc_sql_slots_end_bulk_load() the load functions above only record their
+ * objects in be->slot_owners.  The end reads the whole slots table with a
+ * single query ordered by obj_guid, so the rows of each object come
+ * together and its owner is looked up once.  gnc_sql_slots_flush_bulk_load()
+ * reads only the rows of the objects collected since the last flush.
+ *
+ * The rows of a nested frame or list have the guid from the guid_val of the
+ * parent row as their obj_guid, and can come before or after the parent.
+ * They are loaded into a container, which is hooked into its parent when
+ * the parent row is read; lists are only attached after the last row since
+ * their items may still be coming. */
+
+void
+gnc_sql_slots_begin_bulk_load( GncSqlBackend* be )
+{
+    g_return_if_fail( be != NULL );
+
+    if ( be->slot_owners == NULL )
+    {
+        be->slot_owners = g_hash_table_new( guid_hash_to_guint,
+                                            guid_g_hash_table_equal );
+    }
+}
+
+static void
+free_bulk_container( gpointer data )
+{
+    slots_container_t* container = (slots_container_t*)data;
+
+    if ( !container->is_attached )
+    {
+        kvp_frame_delete( container->info.pKvpFrame );
+    }
+    g_list_free_full( container->info.pList, (GDestroyNotify)kvp_value_delete );
+    (void)g_string_free( container->info.path, TRUE );
+    g_slice_free( slots_container_t, container );
+}
+
+static slots_container_t*
+get_bulk_container( slots_bulk_load_t* bulk, const GncGUID* guid )
+{
+    slots_container_t* container = g_hash_table_lookup( bulk->containers, guid );
+
+    if ( container == NULL )
+    {
+        container = g_slice_new0( slots_container_t );
+        container->guid = *guid;
+        container->info.guid = &container->guid;
+        container->info.is_ok = TRUE;
+        container->info.pKvpFrame = kvp_frame_new();
+        container->info.context = FRAME;
+        container->info.path = g_string_new( NULL );
+        container->info.bulk = bulk;
+        g_hash_table_insert( bulk->containers, &container->guid, container );
+    }
+    return container;
+}
+
+static void
+attach_bulk_container( slot_info_t* pInfo, const GncGUID* guid )
+{
+    slots_container_t* container;
+    gchar* key = get_key_from_path( pInfo->path );
+
+    if ( pInfo->value_type == KVP_TYPE_GLIST )
+    {
+        slots_pending_list_t* pending = g_slice_new( slots_pending_list_t );
+
+        pending->pKvpFrame = pInfo->pKvpFrame;
+        pending->key = key;
+        pending->guid = *guid;
+        pInfo->bulk->lists = g_slist_prepend( pInfo->bulk->lists, pending );
+        if ( pInfo->bulk->is_targeted )
+        {
+            pInfo->bulk->wanted = g_slist_prepend( pInfo->bulk->wanted,
+                                                   &pending->guid );
+        }
+        return;
+    }
+
+    container = get_bulk_container( pInfo->bulk, guid );
+    if ( pInfo->bulk->is_targeted && !container->is_attached )
+    {
+        pInfo->bulk->wanted = g_slist_prepend( pInfo->bulk->wanted,
+                                               &container->guid );
+    }
+    if ( container->is_attached )
+    {
+        PWARN( "Slot frame '%s' is referenced more than once", key );
+        g_free( key );
+        return;
+    }
+    container->is_attached = TRUE;
+    if ( pInfo->context == LIST )
+    {
+        KvpValue* value = kvp_value_new_frame_nc( container->info.pKvpFrame );
+        pInfo->pList = g_list_append( pInfo->pList, value );
+    }
+    else
+    {
+        kvp_frame_set_frame_nc( pInfo->pKvpFrame, key, container->info.pKvpFrame );
+    }
+    g_free( key );
+}
+
+static void
+attach_pending_list( gpointer data, gpointer user_data )
+{
+    slots_pending_list_t* pending = (slots_pending_list_t*)data;
+    slots_bulk_load_t* bulk = (slots_bulk_load_t*)user_data;
+    slots_container_t* container = g_hash_table_lookup( bulk->containers,
+                                   &pending->guid );
+    GList* items = NULL;
+
+    if ( container != NULL )
+    {
+        items = container->info.pList;
+        container->info.pList = NULL;
+    }
+    kvp_frame_set_slot_nc( pending->pKvpFrame, pending->key,
+                           kvp_value_new_glist_nc( items ) );
+    g_free( pending->key );
+    g_slice_free( slots_pending_list_t, pending );
+}
+
+/* The items of a list are saved with the path of the list followed by a
+ * '/', the slots of a frame with their key appended to it. */
+static context_t
+get_bulk_row_context( GncSqlRow* row )
+{
+    const GValue* val = gnc_sql_row_get_value_at_col_name( row, "name" );
+    const gchar* name;
+
+    if ( val == NULL || !G_VALUE_HOLDS_STRING( val ) ) return FRAME;
+    name = g_value_get_string( val );
+    if ( name != NULL && *name != '\0' && name[strlen( name ) - 1] == '/' )
+    {
+        return LIST;
+    }
+    return FRAME;
+}
+
+/* Reads the slot rows returned by sql into their owners, or into the
+ * containers of nested frames and lists.  The rows must be ordered by
+ * obj_guid. */
+static void
+load_bulk_rows( GncSqlBackend* be, const gchar* sql, GHashTable* owners,
+                slot_info_t* owner_info )
+{
+    slot_info_t* pInfo = NULL;
+    GncGUID last_guid;
+    GncSqlStatement* stmt;
+    GncSqlResult* result;
+    GncSqlRow* row;
+
+    stmt = gnc_sql_create_statement_from_sql( be, sql );
+    if ( stmt == NULL )
+    {
+        PERR( "stmt == NULL, SQL = '%s'\n", sql );
+        return;
+    }
+    result = gnc_sql_execute_select_statement( be, stmt );
+    gnc_sql_statement_dispose( stmt );
+    if ( result == NULL ) return;
+
+    for ( row = gnc_sql_result_get_first_row( result ); row != NULL;
+            row = gnc_sql_result_get_next_row( result ) )
+    {
+        const GncGUID* guid = load_obj_guid( be, row );
+
+        if ( pInfo == NULL || !guid_equal( guid, &last_guid ) )
+        {
+            QofInstance* inst = g_hash_table_lookup( owners, guid );
+
+            last_guid = *guid;
+            if ( inst != NULL )
+            {
+                owner_info->guid = qof_instance_get_guid( inst );
+                owner_info->pKvpFrame = qof_instance_get_slots( inst );
+                pInfo = owner_info;
+            }
+            else
+            {
+                pInfo = &get_bulk_container( owner_info->bulk, guid )->info;
+            }
+        }
+        if ( pInfo != owner_info )
+        {
+            pInfo->context = get_bulk_row_context( row );
+        }
+        load_slot( pInfo, row );
+    }
+    gnc_sql_result_dispose( result );
+}
+
+/* Loads the rows of the owners in the owners table, or of every object if
+ * bulk->is_targeted is FALSE, and attaches the lists. */
+static void
+load_bulk_slots( GncSqlBackend* be, GHashTable* owners, slots_bulk_load_t* bulk )
+{
+    slot_info_t owner_info = { NULL, NULL, TRUE, NULL, 0, NULL, NONE, NULL, NULL, NULL };
+    gchar* sql;
+
+    bulk->containers = g_hash_table_new_full( guid_hash_to_guint,
+                       guid_g_hash_table_equal,
+                       NULL, free_bulk_container );
+    owner_info.be = be;
+    owner_info.path = g_string_new( NULL );
+    owner_info.bulk = bulk;
+
+    if ( !bulk->is_targeted )
+    {
+        sql = g_strdup_printf( "SELECT * FROM %s ORDER BY %s, %s", TABLE_NAME,
+                               obj_guid_col_table[0].col_name,
+                               col_table[id_col].col_name );
+        load_bulk_rows( be, sql, owners, &owner_info );
+        g_free( sql );
+    }
+    else
+    {
+        GHashTableIter iter;
+        gpointer key;
+        GSList* guids = NULL;
+
+        g_hash_table_iter_init( &iter, owners );
+        while ( g_hash_table_iter_next( &iter, &key, NULL ) )
+        {
+            guids = g_slist_prepend( guids, key );
+        }
+
+        /* The rows of nested frames and lists have the guid of their
+         * container as obj_guid, so they are read by later passes as the
+         * containers turn up. */
+        while ( guids != NULL )
+        {
+            while ( guids != NULL )
+            {
+                GString* str = g_string_sized_new( 60 + (GUID_ENCODING_LENGTH + 3)
+                                                   * SLOTS_BULK_MAX_GUIDS );
+                gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+                guint count;
+
+                g_string_append_printf( str, "SELECT * FROM %s WHERE %s IN (",
+                                        TABLE_NAME, obj_guid_col_table[0].col_name );
+                for ( count = 0; guids != NULL && count < SLOTS_BULK_MAX_GUIDS; count++ )
+                {
+                    (void)guid_to_string_buff( (const GncGUID*)guids->data, guid_buf );
+                    g_string_append_printf( str, "%s'%s'", count == 0 ? "" : ",",
+                                            guid_buf );
+                    guids = g_slist_delete_link( guids, guids );
+                }
+                g_string_append_printf( str, ") ORDER BY %s, %s",
+                                        obj_guid_col_table[0].col_name,
+                                        col_table[id_col].col_name );
+                load_bulk_rows( be, str->str, owners, &owner_info );
+                (void)g_string_free( str, TRUE );
+            }
+            guids = bulk->wanted;
+            bulk->wanted = NULL;
+        }
+    }
+
+    /* Containers which never got attached belong to objects which weren't
+     * loaded, and are freed with the rest. */
+    g_slist_foreach( bulk->lists, attach_pending_list, bulk );
+    g_slist_free( bulk->lists );
+    g_hash_table_destroy( bulk->containers );
+    (void)g_string_free( owner_info.path, TRUE );
+}
+
+void
+gnc_sql_slots_end_bulk_load( GncSqlBackend* be )
+{
+    slots_bulk_load_t bulk = { NULL, NULL, FALSE, NULL };
+    GHashTable* owners;
+
+    g_return_if_fail( be != NULL );
+
+    owners = be->slot_owners;
+    be->slot_owners = NULL;
+    if ( owners == NULL ) return;
+    if ( g_hash_table_size( owners ) != 0 )
+    {
+        load_bulk_slots( be, owners, &bulk );
+    }
+    g_hash_table_destroy( owners );
+}
+
+/* A flush comes once per batch of transactions and once per scheduled
+ * transaction, so it only reads the rows of the objects collected since the
+ * last flush instead of the whole table. */
+void
+gnc_sql_slots_flush_bulk_load( GncSqlBackend* be )
+{
+    slots_bulk_load_t bulk = { NULL, NULL, TRUE, NULL };
+
+    g_return_if_fail( be != NULL );
+
+    if ( be->slot_owners == NULL ) return;
+    if ( g_hash_table_size( be->slot_owners ) != 0 )
+    {
+        load_bulk_slots( be, be->slot_owners, &bulk );
+        g_hash_table_remove_all( be->slot_owners );
+    }
+}
+
 /* ================================================================= */
 static void
 create_slots_tables( GncSqlBackend* be )
@@ -56,6 +56,15 @@ gboolean gnc_sql_slots_save( GncSqlBackend* be, const GncGUID* guid,
  */
 gboolean gnc_sql_slots_delete( GncSqlBackend* be, const GncGUID* guid );
 
+/**
+ * gnc_sql_slots_forget_saved - Discards the copies of the frames kept to
+ * write only changed slots.  Must be called when a transaction is rolled
+ * back, since the db no longer matches the copies.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_slots_forget_saved( GncSqlBackend* be );
+
 /** Loads slots for an object from the db.
  *
  * @param be SQL backend
@@ -86,6 +95,34 @@ typedef QofInstance* (*BookLookupFn)( const GncGUID* guid, const QofBook* book )
 void gnc_sql_slots_load_for_sql_subquery( GncSqlBackend* be, const gchar* subquery,
         BookLookupFn lookup_fn );
 
+/**
+ * gnc_sql_slots_begin_bulk_load - Starts collecting the objects passed to
+ * gnc_sql_slots_load_for_list() and gnc_sql_slots_load_for_sql_subquery()
+ * instead of loading their slots right away.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_slots_begin_bulk_load( GncSqlBackend* be );
+
+/**
+ * gnc_sql_slots_end_bulk_load - Loads the slots of all of the objects
+ * collected since gnc_sql_slots_begin_bulk_load() with a single query over
+ * the whole slots table.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_slots_end_bulk_load( GncSqlBackend* be );
+
+/**
+ * gnc_sql_slots_flush_bulk_load - Loads the slots of the objects collected
+ * since the last flush, selecting them by obj_guid, and goes on collecting.  Used by loaders which commit their
+ * objects, so that the objects have their slots by then.  Does nothing if
+ * no bulk load is in progress.
+ *
+ * @param be SQL backend
+ */
+void gnc_sql_slots_flush_bulk_load( GncSqlBackend* be );
+
 void gnc_sql_init_slots_handler( void );
 
 #endif /* GNC_SLOTS_SQL_H */
@@ -364,6 +364,8 @@ query_transactions( GncSqlBackend* be, GncSqlStatement* stmt )
         {
             gnc_sql_slots_load_for_list( be, tx_list );
             load_splits_for_tx_list( be, tx_list );
+            // The slots have to be in place before the commits below
+            gnc_sql_slots_flush_bulk_load( be );
         }
 
         // Commit all of the transactions
@@ -202,8 +202,11 @@ book_slots_handler (xmlNodePtr node, gpointer book_pdata)
     gboolean success;
 
     /* the below works only because the get is gaurenteed to return
-     * a frame, even if its empty */
+     * a frame, even if its empty.  The commit lets the book read its
+     * options again. */
+    qof_book_begin_edit (book);
     success = dom_tree_to_kvp_frame_given (node, qof_book_get_slots (book));
+    qof_book_commit_edit (book);
 
     g_return_val_if_fail(success, FALSE);
 
@@ -364,6 +364,16 @@ do_counter_cb (const char *type, gpointer data_p, gpointer be_data_p)
     /* XXX: should we do anything with this counter? */
 }
 
+/* Size the book's collection for the number of objects the file says
+ * are coming, so loading does not keep growing it. */
+static void
+reserve_collection (QofBook *book, QofIdType type, gint64 count)
+{
+    if (!book || count <= 0 || count > G_MAXUINT) return;
+    qof_collection_reserve (qof_book_get_collection (book, type),
+                            (guint) count);
+}
+
 static gboolean
 gnc_counter_end_handler(gpointer data_for_children,
                         GSList* data_from_children, GSList* sibling_data,
@@ -403,10 +413,14 @@ gnc_counter_end_handler(gpointer data_for_children,
     else if (g_strcmp0(type, "transaction") == 0)
     {
         sixdata->counter.transactions_total = val;
+        reserve_collection (sixdata->book, GNC_ID_TRANS, val);
+        /* Most transactions have two splits. */
+        reserve_collection (sixdata->book, GNC_ID_SPLIT, 2 * val);
     }
     else if (g_strcmp0(type, "account") == 0)
     {
         sixdata->counter.accounts_total = val;
+        reserve_collection (sixdata->book, GNC_ID_ACCOUNT, val);
     }
     else if (g_strcmp0(type, "book") == 0)
     {
@@ -427,6 +441,7 @@ gnc_counter_end_handler(gpointer data_for_children,
     else if (g_strcmp0(type, "price") == 0)
     {
         sixdata->counter.prices_total = val;
+        reserve_collection (sixdata->book, GNC_ID_PRICE, val);
     }
     else
     {
@@ -261,7 +261,7 @@ add_text_to_node(xmlNodePtr node, gchar *type, gchar *val)
 
 
 static void
-add_kvp_slot(gpointer key, gpointer value, gpointer data);
+add_kvp_slot(const gchar *key, kvp_value *value, gpointer data);
 
 static void
 add_kvp_value_node(xmlNodePtr node, gchar *tag, kvp_value* val)
@@ -356,11 +356,10 @@ add_kvp_value_node(xmlNodePtr node, gchar *tag, kvp_value* val)
         xmlSetProp(val_node, BAD_CAST "type", BAD_CAST "frame");
 
         frame = kvp_value_get_frame (val);
-        if (!frame || !kvp_frame_get_hash (frame))
+        if (!frame || kvp_frame_is_empty (frame))
             break;
 
-        g_hash_table_foreach_sorted(kvp_frame_get_hash(frame),
-                                    add_kvp_slot, val_node, (GCompareFunc)strcmp);
+        kvp_frame_for_each_slot_sorted(frame, add_kvp_slot, val_node);
     }
     break;
 
@@ -368,7 +367,7 @@ add_kvp_value_node(xmlNodePtr node, gchar *tag, kvp_value* val)
 }
 
 static void
-add_kvp_slot(gpointer key, gpointer value, gpointer data)
+add_kvp_slot(const gchar *key, kvp_value *value, gpointer data)
 {
     xmlNodePtr slot_node;
     xmlNodePtr node = (xmlNodePtr)data;
@@ -391,20 +390,14 @@ kvp_frame_to_dom_tree(const char *tag, const kvp_frame *frame)
         return NULL;
     }
 
-    if (!kvp_frame_get_hash(frame))
-    {
-        return NULL;
-    }
-
-    if (g_hash_table_size(kvp_frame_get_hash(frame)) == 0)
+    if (kvp_frame_get_slot_count(frame) == 0)
     {
         return NULL;
     }
 
     ret = xmlNewNode(NULL, BAD_CAST tag);
 
-    g_hash_table_foreach_sorted(kvp_frame_get_hash(frame),
-                                add_kvp_slot, ret, (GCompareFunc)strcmp);
+    kvp_frame_for_each_slot_sorted(frame, add_kvp_slot, ret);
 
     return ret;
 }
@@ -93,7 +93,9 @@ static gboolean dom_chars_handler(
 {
     if (length > 0)
     {
-	gchar *newtext = g_strdup (text);
+	/* text isn't terminated at length, it runs on into the rest of
+	 * the parser's input buffer */
+	gchar *newtext = g_strndup (text, length);
         xmlNodeAddContentLen((xmlNodePtr)parent_data,
 			     checked_char_cast (newtext), length);
 	g_free (newtext);
@@ -97,6 +97,7 @@ enum
 \********************************************************************/
 
 static void xaccAccountBringUpToDate (Account *acc);
+static void account_invalidate_split_index (AccountPrivate *priv);
 
 
 /********************************************************************\
@@ -251,8 +252,12 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_valid_split = NULL;
 
     priv->splits = NULL;
+    priv->last_split = NULL;
+    priv->splits_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+    priv->split_index = NULL;
     priv->sort_dirty = FALSE;
 }
 
@@ -265,6 +270,14 @@ gnc_account_dispose (GObject *acctp)
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+
+    if (priv->splits_hash)
+    {
+        g_hash_table_destroy (priv->splits_hash);
+        priv->splits_hash = NULL;
+    }
+    account_invalidate_split_index (priv);
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -1112,6 +1125,7 @@ xaccFreeAccount (Account *acc)
     priv->commodity = NULL;
 
     priv->balance_dirty = FALSE;
+    priv->balance_valid_split = NULL;
     priv->sort_dirty = FALSE;
 
     /* qof_instance_release (&acc->inst); */
@@ -1206,6 +1220,9 @@ xaccAccountCommitEdit (Account *acc)
         {
             g_list_free(priv->splits);
             priv->splits = NULL;
+            priv->last_split = NULL;
+            g_hash_table_remove_all (priv->splits_hash);
+            account_invalidate_split_index (priv);
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -1545,6 +1562,22 @@ gnc_account_set_sort_dirty (Account *acc)
     priv->sort_dirty = TRUE;
 }
 
+/* Mark the running balances dirty after @last_valid, the last split
+ * whose balances are known to still be correct; NULL means that all of
+ * them must be recomputed.  Only one such position is remembered: if
+ * the balances are already dirty from somewhere else, fall back to a
+ * full recomputation rather than trying to work out which is earlier.
+ */
+static void
+set_balance_dirty (AccountPrivate *priv, Split *last_valid)
+{
+    if (!priv->balance_dirty)
+        priv->balance_valid_split = last_valid;
+    else if (priv->balance_valid_split != last_valid)
+        priv->balance_valid_split = NULL;
+    priv->balance_dirty = TRUE;
+}
+
 void
 gnc_account_set_balance_dirty (Account *acc)
 {
@@ -1556,12 +1589,143 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    set_balance_dirty (priv, NULL);
+}
+
+void
+gnc_account_split_changed (Account *acc, Split *split)
+{
+    AccountPrivate *priv;
+    GList *node;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    priv = GET_PRIVATE(acc);
+    node = g_hash_table_lookup (priv->splits_hash, split);
+    if (node == NULL)
+        return;
+
+    if (!priv->sort_dirty &&
+            ((node->prev && xaccSplitOrder (node->prev->data, split) > 0) ||
+             (node->next && xaccSplitOrder (split, node->next->data) > 0)))
+        priv->sort_dirty = TRUE;
+
+    set_balance_dirty (priv, node->prev ? node->prev->data : NULL);
 }
 
 /********************************************************************\
 \********************************************************************/
 
+/* The date index is a flat copy of the split list that allows the
+ * balance-as-of-date queries to binary search on the posted date.  It
+ * is built lazily, extended in place when a split is appended at the
+ * end of the list and simply dropped on any other change. */
+static void
+account_invalidate_split_index (AccountPrivate *priv)
+{
+    if (priv->split_index)
+    {
+        g_ptr_array_free (priv->split_index, TRUE);
+        priv->split_index = NULL;
+    }
+}
+
+static GPtrArray *
+account_get_split_index (AccountPrivate *priv)
+{
+    GList *lp;
+
+    if (priv->split_index)
+        return priv->split_index;
+
+    priv->split_index = g_ptr_array_sized_new (g_hash_table_size (priv->splits_hash));
+    for (lp = priv->splits; lp; lp = lp->next)
+        g_ptr_array_add (priv->split_index, lp->data);
+    return priv->split_index;
+}
+
+/* Return the position in the (sorted) date index of the first split
+ * posted after @date, or at @date as well if @at_date is TRUE.  Splits
+ * without a transaction sort last, so they count as posted after any
+ * date. */
+static guint
+account_find_first_split_after (GPtrArray *index, time64 date,
+                                gboolean at_date)
+{
+    guint lo = 0, hi = index->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        Transaction *trans = xaccSplitGetParent (g_ptr_array_index (index, mid));
+        time64 posted;
+
+        if (trans == NULL)
+        {
+            hi = mid;
+            continue;
+        }
+        posted = xaccTransGetDate (trans);
+        if (posted > date || (at_date && posted == date))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+/* The split list is kept as a GList so that xaccAccountGetSplitList
+ * and the many traversals over it keep working unchanged.  Alongside
+ * it we keep an index from each split to its list node, which makes
+ * the membership test and removal O(1), and a pointer to the tail
+ * node.  Splits usually arrive in (or near) date order, so the sorted
+ * insert searches backwards from the tail instead of forwards from
+ * the head; an insert of the newest split costs O(1).
+ */
+static GList *
+account_splits_insert_sorted (AccountPrivate *priv, Split *s)
+{
+    GList *prev, *node;
+    gboolean action_for_num = qof_book_use_split_action_for_num_field
+                              (xaccSplitGetBook (s));
+
+    for (prev = priv->last_split; prev; prev = prev->prev)
+        if (xaccSplitOrder_num_action (prev->data, s, action_for_num) <= 0)
+            break;
+
+    node = g_list_alloc ();
+    node->data = s;
+    node->prev = prev;
+    if (prev)
+    {
+        node->next = prev->next;
+        prev->next = node;
+    }
+    else
+    {
+        node->next = priv->splits;
+        priv->splits = node;
+    }
+    if (node->next)
+        node->next->prev = node;
+    else
+        priv->last_split = node;
+
+    return node;
+}
+
+static GList *
+account_splits_prepend (AccountPrivate *priv, Split *s)
+{
+    priv->splits = g_list_prepend (priv->splits, s);
+    if (priv->last_split == NULL)
+        priv->last_split = priv->splits;
+    return priv->splits;
+}
+
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
@@ -1572,27 +1736,32 @@ gnc_account_insert_split (Account *acc, Split *s)
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    if (g_hash_table_lookup (priv->splits_hash, s))
         return FALSE;
 
     if (qof_instance_get_editlevel(acc) == 0)
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        node = account_splits_insert_sorted (priv, s);
+        set_balance_dirty (priv, node->prev ? node->prev->data : NULL);
+        if (priv->split_index && node == priv->last_split)
+            g_ptr_array_add (priv->split_index, s);
+        else
+            account_invalidate_split_index (priv);
     }
     else
     {
-        priv->splits = g_list_prepend(priv->splits, s);
+        node = account_splits_prepend (priv, s);
         priv->sort_dirty = TRUE;
+        set_balance_dirty (priv, NULL);
+        account_invalidate_split_index (priv);
     }
+    g_hash_table_insert (priv->splits_hash, s, node);
 
     //FIXME: find better event
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1603,39 +1772,63 @@ gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
     GList *node;
+    Split *prev;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
+    node = g_hash_table_lookup (priv->splits_hash, s);
     if (NULL == node)
         return FALSE;
 
+    /* Only the splits after the removed one need new balances. */
+    prev = node->prev ? node->prev->data : NULL;
+    if (priv->balance_valid_split == s)
+        priv->balance_valid_split = prev;
+    set_balance_dirty (priv, prev);
+
+    g_hash_table_remove (priv->splits_hash, s);
+    if (node == priv->last_split)
+        priv->last_split = node->prev;
     priv->splits = g_list_delete_link(priv->splits, node);
+    account_invalidate_split_index (priv);
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
 
+static gint
+split_order_cb (gconstpointer a, gconstpointer b, gpointer action_for_num)
+{
+    return xaccSplitOrder_num_action (a, b, GPOINTER_TO_INT (action_for_num));
+}
+
 void
 xaccAccountSortSplits (Account *acc, gboolean force)
 {
     AccountPrivate *priv;
+    gboolean action_for_num;
 
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
     priv = GET_PRIVATE(acc);
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
-    priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+    /* g_list_sort relinks the existing nodes, so the node index in
+     * splits_hash stays valid; only the tail has to be found again. */
+    action_for_num = qof_book_use_split_action_for_num_field
+                     (gnc_account_get_book (acc));
+    priv->splits = g_list_sort_with_data(priv->splits, split_order_cb,
+                                         GINT_TO_POINTER (action_for_num));
+    priv->last_split = g_list_last (priv->splits);
+    account_invalidate_split_index (priv);
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty (priv, NULL);
 }
 
 static void
@@ -1840,6 +2033,8 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     g_return_if_fail (qof_instance_books_equal(accfrom, accto));
     ENTER ("(accfrom=%p, accto=%p)", accfrom, accto);
 
+    /* Each split moved generates several events. */
+    qof_event_begin_batch();
     xaccAccountBeginEdit(accfrom);
     xaccAccountBeginEdit(accto);
     /* Begin editing both accounts and all transactions in accfrom. */
@@ -1867,11 +2062,49 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     g_assert(from_priv->lots == NULL);
     xaccAccountCommitEdit(accfrom);
     xaccAccountCommitEdit(accto);
+    qof_event_end_batch();
 
     LEAVE ("(accfrom=%p, accto=%p)", accfrom, accto);
 }
 
 
+/* Check the incrementally maintained running balances against a full
+ * recomputation.  Only done when debug logging is on for the module. */
+static void
+account_check_balances (Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    gnc_numeric balance = priv->starting_balance;
+    gnc_numeric cleared_balance = priv->starting_cleared_balance;
+    gnc_numeric reconciled_balance = priv->starting_reconciled_balance;
+    GList *lp;
+
+    for (lp = priv->splits; lp; lp = lp->next)
+    {
+        Split *split = (Split *) lp->data;
+        gnc_numeric amt = xaccSplitGetAmount (split);
+
+        balance = gnc_numeric_add_fixed(balance, amt);
+        if (NREC != split->reconciled)
+            cleared_balance = gnc_numeric_add_fixed(cleared_balance, amt);
+        if (YREC == split->reconciled || FREC == split->reconciled)
+            reconciled_balance = gnc_numeric_add_fixed(reconciled_balance, amt);
+
+        if (!gnc_numeric_equal (balance, split->balance) ||
+                !gnc_numeric_equal (cleared_balance, split->cleared_balance) ||
+                !gnc_numeric_equal (reconciled_balance, split->reconciled_balance))
+        {
+            PERR ("acct=%s: incremental running balance of split %p is wrong",
+                  priv->accountName, split);
+            return;
+        }
+    }
+    if (!gnc_numeric_equal (balance, priv->balance) ||
+            !gnc_numeric_equal (cleared_balance, priv->cleared_balance) ||
+            !gnc_numeric_equal (reconciled_balance, priv->reconciled_balance))
+        PERR ("acct=%s: incremental balance is wrong", priv->accountName);
+}
+
 /********************************************************************\
  * xaccAccountRecomputeBalance                                      *
  *   recomputes the partial balances and the current balance for    *
@@ -1920,10 +2153,28 @@ xaccAccountRecomputeBalance (Account * acc)
     balance            = priv->starting_balance;
     cleared_balance    = priv->starting_cleared_balance;
     reconciled_balance = priv->starting_reconciled_balance;
+    lp = priv->splits;
+
+    /* If only the tail of the split list is dirty, carry on from the
+     * last split whose running balances are still good; otherwise
+     * fall back to recomputing all of them. */
+    if (priv->balance_valid_split)
+    {
+        GList *node = g_hash_table_lookup (priv->splits_hash,
+                                           priv->balance_valid_split);
+        if (node)
+        {
+            Split *split = (Split *) node->data;
+            balance = split->balance;
+            cleared_balance = split->cleared_balance;
+            reconciled_balance = split->reconciled_balance;
+            lp = node->next;
+        }
+    }
 
     PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
            priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    for (; lp; lp = lp->next)
     {
         Split *split = (Split *) lp->data;
         gnc_numeric amt = xaccSplitGetAmount (split);
@@ -1952,6 +2203,10 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_valid_split = NULL;
+
+    if (qof_log_check (log_module, QOF_LOG_DEBUG))
+        account_check_balances (acc);
 }
 
 /********************************************************************\
@@ -2066,7 +2321,7 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    set_balance_dirty (priv, NULL); /* new type may affect balance computation */
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2265,7 +2520,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    set_balance_dirty (priv, NULL);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -3042,7 +3297,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty (priv, NULL);
 }
 
 void
@@ -3055,7 +3310,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty (priv, NULL);
 }
 
 void
@@ -3068,7 +3323,7 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty (priv, NULL);
 }
 
 gnc_numeric
@@ -3133,17 +3388,9 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 gnc_numeric
 xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
 {
-    /* Ideally this could use xaccAccountForEachSplit, but
-     * it doesn't exist yet and I'm uncertain of exactly how
-     * it would work at this time, since it differs from
-     * xaccAccountForEachTransaction by using gpointer return
-     * values rather than gints.
-     */
     AccountPrivate *priv;
-    GList   *lp;
-    Timespec ts, trans_ts;
-    gboolean found = FALSE;
-    gnc_numeric balance;
+    GPtrArray *index;
+    guint pos;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
@@ -3151,55 +3398,63 @@ xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
     priv = GET_PRIVATE(acc);
-    balance = priv->balance;
-
-    /* Since transaction post times are stored as a Timespec,
-     * convert date into a Timespec as well rather than converting
-     * each transaction's Timespec into a time64.
-     *
-     * FIXME: CAS: I think this comment is a bogus justification for
-     * using xaccTransGetDatePostedTS.  There's no benefit to using
-     * Timespec when the input argument is time64, and it's hard to
-     * imagine that casting long long to long and comparing two longs is
-     * worse than comparing two long longs every time.  IMO,
-     * xaccAccountGetPresentBalance gets this right, and its algorithm
-     * should be used here.
-     */
-    ts.tv_sec = date;
-    ts.tv_nsec = 0;
 
-    lp = priv->splits;
-    while ( lp && !found )
+    /* The running balance of the last split posted before the date is
+     * the balance as of that date. */
+    index = account_get_split_index (priv);
+    pos = account_find_first_split_after (index, date, TRUE);
+
+    /* No splits were posted on or after the given date, so the latest
+     * account balance is good enough. */
+    if (pos == index->len)
+        return priv->balance;
+
+    /* AsOf date must be before any entries, return zero. */
+    if (pos == 0)
+        return gnc_numeric_zero();
+
+    return xaccSplitGetBalance (g_ptr_array_index (index, pos - 1));
+}
+
+void
+gnc_account_foreach_split_posted_between (const Account *acc,
+        time64 start, time64 end,
+        QofInstanceForeachCB cb, gpointer user_data)
+{
+    AccountPrivate *priv;
+    GList *node;
+
+    g_return_if_fail (GNC_IS_ACCOUNT (acc));
+    g_return_if_fail (cb);
+
+    priv = GET_PRIVATE (acc);
+
+    if (start == G_MININT64 && end == G_MAXINT64)
     {
-        xaccTransGetDatePostedTS( xaccSplitGetParent( (Split *)lp->data ),
-                                  &trans_ts );
-        if ( timespec_cmp( &trans_ts, &ts ) >= 0 )
-            found = TRUE;
-        else
-            lp = lp->next;
+        for (node = priv->splits; node; node = node->next)
+            cb (node->data, user_data);
+        return;
     }
 
-    if ( lp )
+    /* The date index can only be searched if the splits are in order */
+    if (!priv->sort_dirty)
     {
-        if ( lp->prev )
-        {
-            /* Since lp is now pointing to a split which was past the reconcile
-             * date, get the running balance of the previous split.
-             */
-            balance = xaccSplitGetBalance( (Split *)lp->prev->data );
-        }
-        else
-        {
-            /* AsOf date must be before any entries, return zero. */
-            balance = gnc_numeric_zero();
-        }
+        GPtrArray *index = account_get_split_index (priv);
+        guint pos = account_find_first_split_after (index, start, TRUE);
+        guint last = account_find_first_split_after (index, end, FALSE);
+
+        for (; pos < last; pos++)
+            cb (g_ptr_array_index (index, pos), user_data);
+        return;
     }
 
-    /* Otherwise there were no splits posted after the given date,
-     * so the latest account balance should be good enough.
-     */
+    for (node = priv->splits; node; node = node->next)
+    {
+        time64 posted = xaccTransGetDate (xaccSplitGetParent (node->data));
 
-    return( balance );
+        if (posted >= start && posted <= end)
+            cb (node->data, user_data);
+    }
 }
 
 /*
@@ -3221,6 +3476,18 @@ xaccAccountGetPresentBalance (const Account *acc)
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
+
+    /* The date index can only be searched if the splits are in order */
+    if (!priv->sort_dirty)
+    {
+        GPtrArray *index = account_get_split_index (priv);
+        guint pos = account_find_first_split_after (index, today, FALSE);
+
+        if (pos == 0)
+            return gnc_numeric_zero ();
+        return xaccSplitGetBalance (g_ptr_array_index (index, pos - 1));
+    }
+
     for (node = g_list_last(priv->splits); node; node = node->prev)
     {
         Split *split = node->data;
@@ -109,8 +109,15 @@ typedef struct AccountPrivate
     gnc_numeric reconciled_balance;
 
     gboolean balance_dirty;     /* balances in splits incorrect */
+    /* When balance_dirty is set, the last split whose running balances
+     * are still correct, or NULL if all of them must be recomputed. */
+    Split *balance_valid_split;
 
     GList *splits;              /* list of split pointers */
+    GList *last_split;          /* tail node of splits, for cheap appends */
+    GHashTable *splits_hash;    /* index of Split* -> its node in splits */
+    GPtrArray *split_index;     /* splits in list order, for binary
+                                 * searches by date; NULL if stale */
     gboolean sort_dirty;        /* sort order of splits is bad */
 
     LotList   *lots;		/* list of lot pointers */
@@ -135,6 +142,24 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account that @split, one of its splits, has been changed in
+ * a way that may affect its running balances or its place in the date
+ * order.  The split list is only marked for re-sorting if the split is
+ * now out of order with its neighbours, and only the balances from the
+ * split onwards are marked for recomputation. */
+void gnc_account_split_changed (Account *acc, Split *split);
+
+/* Call @cb on the splits of @acc posted between @start and @end, both
+ * inclusive, in the order of the split list.  While the list is sorted
+ * the bounds are found by binary search on the date index, otherwise
+ * the whole list is filtered.  Pass G_MININT64 and G_MAXINT64 for an
+ * open range; every split of the account is visited then.  The splits
+ * of transactions still open for editing may be missed, see
+ * xaccBookHasOpenTransactions. */
+void gnc_account_foreach_split_posted_between (const Account *acc,
+        time64 start, time64 end,
+        QofInstanceForeachCB cb, gpointer user_data);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
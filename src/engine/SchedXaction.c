@@ -1057,7 +1057,7 @@ pack_split_info (TTSplitInfo *s_info, Account *parent_acct,
     xaccAccountInsertSplit(parent_acct,
                            split);
 
-    split_frame = xaccSplitGetSlots(split);
+    split_frame = xaccSplitGetSlotsForEdit(split);
 
     tmp_value
     = kvp_value_new_string(gnc_ttsplitinfo_get_credit_formula(s_info));
@@ -63,9 +63,11 @@ xaccAccountTreeScrubOrphans (Account *acc)
 {
     if (!acc) return;
 
+    qof_event_begin_batch ();
     xaccAccountScrubOrphans (acc);
     gnc_account_foreach_descendant(acc,
                                    (AccountCb)xaccAccountScrubOrphans, NULL);
+    qof_event_end_batch ();
 }
 
 static void
@@ -272,9 +274,11 @@ xaccSplitScrub (Split *split)
 void
 xaccAccountTreeScrubImbalance (Account *acc)
 {
+    qof_event_begin_batch ();
     xaccAccountScrubImbalance (acc);
     gnc_account_foreach_descendant(acc,
                                    (AccountCb)xaccAccountScrubImbalance, NULL);
+    qof_event_end_batch ();
 }
 
 void
@@ -251,6 +251,9 @@ remove_guids (Split *sa, Split *sb)
 {
     KvpFrame *ksub;
 
+    xaccSplitJournalSlots (sa);
+    xaccSplitJournalSlots (sb);
+
     /* Find and remove the matching guid's */
     ksub = (KvpFrame*)gnc_kvp_bag_find_by_guid (sa->inst.kvp_data, "lot-split",
             "peer_guid", qof_instance_get_guid(sb));
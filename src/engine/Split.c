@@ -51,12 +51,31 @@
 #include "gnc-engine.h"
 #include "gnc-lot.h"
 #include "gnc-event.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
 
 const char *void_former_amt_str = "void-former-amount";
 const char *void_former_val_str = "void-former-value";
 
 #define PRICE_SIGFIGS 6
 
+/* Record a field of the split in its transaction's edit journal before
+ * changing it.  Splits that joined the transaction during the edit are
+ * removed again by a rollback, so they aren't journaled. */
+#define SPLIT_JOURNALED(s) ((s)->parent && (s)->parent == (s)->orig_parent)
+#define JOURNAL_SPLIT_FIELD(s, field) do {                              \
+        if (SPLIT_JOURNALED(s))                                         \
+            TRANS_JOURNAL_FIELD((s)->parent, (s)->field);               \
+    } while (0)
+#define JOURNAL_SPLIT_STRING(s, field) do {                             \
+        if (SPLIT_JOURNALED(s))                                         \
+            xaccTransJournalString((s)->parent, &(s)->field);           \
+    } while (0)
+#define JOURNAL_SPLIT_SLOTS(s) do {                                     \
+        if (SPLIT_JOURNALED(s))                                         \
+            xaccTransJournalSlots((s)->parent, &(s)->inst);             \
+    } while (0)
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
@@ -323,6 +342,7 @@ xaccSplitReinit(Split * split)
 
     CACHE_REPLACE(split->action, "");
     CACHE_REPLACE(split->memo, "");
+    xaccSplitClearSortKey (split);
     split->reconciled  = NREC;
     split->amount      = gnc_numeric_zero();
     split->value       = gnc_numeric_zero();
@@ -514,6 +534,7 @@ xaccFreeSplit (Split *split)
         PERR ("double-free %p", split);
         return;
     }
+    xaccSplitClearSortKey (split);
     CACHE_REMOVE(split->memo);
     CACHE_REMOVE(split->action);
 
@@ -544,7 +565,7 @@ void mark_split (Split *s)
 {
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (s->acc, s);
     }
 
     /* set dirty flag on lot too. */
@@ -831,7 +852,7 @@ xaccSplitCommitEdit(Split *s)
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (acc, s);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -961,6 +982,15 @@ get_commodity_denom(const Split * s)
 KvpFrame *
 xaccSplitGetSlots (const Split * s)
 {
+    if (!s) return NULL;
+    return qof_instance_get_slots(QOF_INSTANCE(s));
+}
+
+KvpFrame *
+xaccSplitGetSlotsForEdit (Split * s)
+{
+    if (!s) return NULL;
+    JOURNAL_SPLIT_SLOTS(s);
     return qof_instance_get_slots(QOF_INSTANCE(s));
 }
 /* Used for testing only: _get_random_split in test-engine-stuff.c */
@@ -969,11 +999,26 @@ xaccSplitSetSlots_nc(Split *s, KvpFrame *frm)
 {
     if (!s || !frm) return;
     xaccTransBeginEdit(s->parent);
+    JOURNAL_SPLIT_SLOTS(s);
     qof_instance_set_slots(QOF_INSTANCE(s), frm);
     xaccTransCommitEdit(s->parent);
 
 }
 
+void
+xaccSplitJournalSlots (Split *split)
+{
+    if (!split) return;
+    JOURNAL_SPLIT_SLOTS(split);
+}
+
+void
+xaccSplitJournalGainsSplit (Split *split)
+{
+    if (!split) return;
+    JOURNAL_SPLIT_FIELD(split, gains_split);
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -984,6 +1029,8 @@ xaccSplitSetSharePriceAndAmount (Split *s, gnc_numeric price, gnc_numeric amt)
     ENTER (" ");
     xaccTransBeginEdit (s->parent);
 
+    JOURNAL_SPLIT_FIELD(s, amount);
+    JOURNAL_SPLIT_FIELD(s, value);
     s->amount = gnc_numeric_convert(amt, get_commodity_denom(s),
                                     GNC_HOW_RND_ROUND_HALF_UP);
     s->value  = gnc_numeric_mul(s->amount, price,
@@ -1000,6 +1047,7 @@ static void
 qofSplitSetSharePrice (Split *split, gnc_numeric price)
 {
     g_return_if_fail(split);
+    JOURNAL_SPLIT_FIELD(split, value);
     split->value = gnc_numeric_mul(xaccSplitGetAmount(split),
                                    price, get_currency_denom(split),
                                    GNC_HOW_RND_ROUND_HALF_UP);
@@ -1012,6 +1060,7 @@ xaccSplitSetSharePrice (Split *s, gnc_numeric price)
     ENTER (" ");
     xaccTransBeginEdit (s->parent);
 
+    JOURNAL_SPLIT_FIELD(s, value);
     s->value = gnc_numeric_mul(xaccSplitGetAmount(s),
                                price, get_currency_denom(s),
                                GNC_HOW_RND_ROUND_HALF_UP);
@@ -1027,6 +1076,7 @@ static void
 qofSplitSetAmount (Split *split, gnc_numeric amt)
 {
     g_return_if_fail(split);
+    JOURNAL_SPLIT_FIELD(split, amount);
     if (split->acc)
     {
         split->amount = gnc_numeric_convert(amt,
@@ -1049,6 +1099,7 @@ xaccSplitSetAmount (Split *s, gnc_numeric amt)
            s->amount.num, s->amount.denom, amt.num, amt.denom);
 
     xaccTransBeginEdit (s->parent);
+    JOURNAL_SPLIT_FIELD(s, amount);
     if (s->acc)
         s->amount = gnc_numeric_convert(amt, get_commodity_denom(s),
                                         GNC_HOW_RND_ROUND_HALF_UP);
@@ -1066,6 +1117,7 @@ static void
 qofSplitSetValue (Split *split, gnc_numeric amt)
 {
     g_return_if_fail(split);
+    JOURNAL_SPLIT_FIELD(split, value);
     split->value = gnc_numeric_convert(amt,
                                        get_currency_denom(split), GNC_HOW_RND_ROUND_HALF_UP);
 }
@@ -1085,6 +1137,7 @@ xaccSplitSetValue (Split *s, gnc_numeric amt)
     xaccTransBeginEdit (s->parent);
     new_val = gnc_numeric_convert(amt, get_currency_denom(s),
                                   GNC_HOW_RND_ROUND_HALF_UP);
+    JOURNAL_SPLIT_FIELD(s, value);
     if (gnc_numeric_check(new_val) == GNC_ERROR_OK)
         s->value = new_val;
     else PERR("numeric error in converting the split value's denominator");
@@ -1135,6 +1188,8 @@ xaccSplitSetBaseValue (Split *s, gnc_numeric value,
 
     currency = xaccTransGetCurrency (s->parent);
     commodity = xaccAccountGetCommodity (s->acc);
+    JOURNAL_SPLIT_FIELD(s, amount);
+    JOURNAL_SPLIT_FIELD(s, value);
 
     /* If the base_currency is the transaction's commodity ('currency'),
      * set the value.  If it's the account commodity, set the
@@ -1295,41 +1350,85 @@ xaccSplitDestroy (Split *split)
 /********************************************************************\
 \********************************************************************/
 
+void
+xaccSplitClearSortKey (Split *split)
+{
+    if (!split->sort_key) return;
+    g_free (split->sort_key->memo_key);
+    g_free (split->sort_key->action_key);
+    g_free (split->sort_key);
+    split->sort_key = NULL;
+}
+
+static const SplitSortKey *
+split_get_sort_key (const Split *split)
+{
+    SplitSortKey *key = split->sort_key;
+
+    if (key && key->memo == split->memo && key->action == split->action)
+        return key;
+
+    if (!key)
+        key = ((Split *)split)->sort_key = g_new0 (SplitSortKey, 1);
+    else
+    {
+        g_free (key->memo_key);
+        g_free (key->action_key);
+    }
+    key->memo = split->memo;
+    key->action = split->action;
+    key->action_num = split->action ? atoi (split->action) : 0;
+    key->memo_key = g_utf8_collate_key (split->memo ? split->memo : "", -1);
+    key->action_key = g_utf8_collate_key (split->action ? split->action : "",
+                                          -1);
+    return key;
+}
+
 gint
 xaccSplitOrder (const Split *sa, const Split *sb)
 {
+    if (sa == sb) return 0;
+    /* nothing is always less than something */
+    if (!sa) return -1;
+    if (!sb) return +1;
+
+    return xaccSplitOrder_num_action (sa, sb,
+                                      qof_book_use_split_action_for_num_field
+                                      (xaccSplitGetBook (sa)));
+}
+
+gint
+xaccSplitOrder_num_action (const Split *sa, const Split *sb,
+                           gboolean action_for_num)
+{
+    const SplitSortKey *ka, *kb;
     int retval;
     int comp;
-    char *da, *db;
-    gboolean action_for_num;
 
     if (sa == sb) return 0;
     /* nothing is always less than something */
     if (!sa) return -1;
     if (!sb) return +1;
 
+    ka = split_get_sort_key (sa);
+    kb = split_get_sort_key (sb);
+
     /* sort in transaction order, but use split action rather than trans num
      * according to book option */
-    action_for_num = qof_book_use_split_action_for_num_field
-                                                        (xaccSplitGetBook (sa));
-    if (action_for_num)
-        retval = xaccTransOrder_num_action (sa->parent, sa->action,
-                                            sb->parent, sb->action);
+    if (action_for_num && sa->action && sb->action)
+        retval = xaccTransOrder_parsed (sa->parent, &ka->action_num,
+                                        sb->parent, &kb->action_num);
     else
-        retval = xaccTransOrder (sa->parent, sb->parent);
+        retval = xaccTransOrder_parsed (sa->parent, NULL, sb->parent, NULL);
     if (retval) return retval;
 
     /* otherwise, sort on memo strings */
-    da = sa->memo ? sa->memo : "";
-    db = sb->memo ? sb->memo : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (ka->memo_key, kb->memo_key);
     if (retval)
         return retval;
 
     /* otherwise, sort on action strings */
-    da = sa->action ? sa->action : "";
-    db = sb->action ? sb->action : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (ka->action_key, kb->action_key);
     if (retval != 0)
         return retval;
 
@@ -1545,7 +1644,9 @@ static void
 qofSplitSetMemo (Split *split, const char* memo)
 {
     g_return_if_fail(split);
+    JOURNAL_SPLIT_STRING(split, memo);
     CACHE_REPLACE(split->memo, memo);
+    xaccSplitClearSortKey (split);
 }
 
 void
@@ -1554,7 +1655,9 @@ xaccSplitSetMemo (Split *split, const char *memo)
     if (!split || !memo) return;
     xaccTransBeginEdit (split->parent);
 
+    JOURNAL_SPLIT_STRING(split, memo);
     CACHE_REPLACE(split->memo, memo);
+    xaccSplitClearSortKey (split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1564,7 +1667,9 @@ static void
 qofSplitSetAction (Split *split, const char *actn)
 {
     g_return_if_fail(split);
+    JOURNAL_SPLIT_STRING(split, action);
     CACHE_REPLACE(split->action, actn);
+    xaccSplitClearSortKey (split);
 }
 
 void
@@ -1573,7 +1678,9 @@ xaccSplitSetAction (Split *split, const char *actn)
     if (!split || !actn) return;
     xaccTransBeginEdit (split->parent);
 
+    JOURNAL_SPLIT_STRING(split, action);
     CACHE_REPLACE(split->action, actn);
+    xaccSplitClearSortKey (split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1590,6 +1697,7 @@ qofSplitSetReconcile (Split *split, char recn)
     case YREC:
     case FREC:
     case VREC:
+        JOURNAL_SPLIT_FIELD(split, reconciled);
         split->reconciled = recn;
         mark_split (split);
         xaccAccountRecomputeBalance (split->acc);
@@ -1613,6 +1721,7 @@ xaccSplitSetReconcile (Split *split, char recn)
     case YREC:
     case FREC:
     case VREC:
+        JOURNAL_SPLIT_FIELD(split, reconciled);
         split->reconciled = recn;
         mark_split (split);
         qof_instance_set_dirty(QOF_INSTANCE(split));
@@ -1632,6 +1741,7 @@ xaccSplitSetDateReconciledSecs (Split *split, time64 secs)
     if (!split) return;
     xaccTransBeginEdit (split->parent);
 
+    JOURNAL_SPLIT_FIELD(split, date_reconciled);
     split->date_reconciled.tv_sec = secs;
     split->date_reconciled.tv_nsec = 0;
     qof_instance_set_dirty(QOF_INSTANCE(split));
@@ -1645,6 +1755,7 @@ xaccSplitSetDateReconciledTS (Split *split, Timespec *ts)
     if (!split || !ts) return;
     xaccTransBeginEdit (split->parent);
 
+    JOURNAL_SPLIT_FIELD(split, date_reconciled);
     split->date_reconciled = *ts;
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
@@ -1737,6 +1848,7 @@ void
 xaccSplitSetLot(Split* split, GNCLot* lot)
 {
     xaccTransBeginEdit (split->parent);
+    JOURNAL_SPLIT_FIELD(split, lot);
     split->lot = lot;
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
@@ -1839,6 +1951,8 @@ xaccSplitMakeStockSplit(Split *s)
 {
     xaccTransBeginEdit (s->parent);
 
+    JOURNAL_SPLIT_FIELD(s, value);
+    JOURNAL_SPLIT_SLOTS(s);
     s->value = gnc_numeric_zero();
     kvp_frame_set_str(s->inst.kvp_data, "split-type", "stock-split");
     SET_GAINS_VDIRTY(s);
@@ -1936,8 +2050,10 @@ void
 xaccSplitVoid(Split *split)
 {
     gnc_numeric zero = gnc_numeric_zero();
-    KvpFrame *frame = split->inst.kvp_data;
+    KvpFrame *frame;
 
+    JOURNAL_SPLIT_SLOTS(split);
+    frame = split->inst.kvp_data;
     kvp_frame_set_gnc_numeric(frame, void_former_amt_str,
                               xaccSplitGetAmount(split));
     kvp_frame_set_gnc_numeric(frame, void_former_val_str,
@@ -1952,8 +2068,10 @@ xaccSplitVoid(Split *split)
 void
 xaccSplitUnvoid(Split *split)
 {
-    KvpFrame *frame = split->inst.kvp_data;
+    KvpFrame *frame;
 
+    JOURNAL_SPLIT_SLOTS(split);
+    frame = split->inst.kvp_data;
     xaccSplitSetAmount (split, xaccSplitVoidFormerAmount(split));
     xaccSplitSetValue (split, xaccSplitVoidFormerValue(split));
     xaccSplitSetReconcile(split, NREC);
@@ -1966,6 +2084,89 @@ xaccSplitUnvoid(Split *split)
 \********************************************************************/
 /* QofObject function implementation */
 
+static gboolean
+param_path_is (const QofQueryParamList *path, const char *first,
+               const char *second)
+{
+    return path && path->next && !path->next->next &&
+           !g_strcmp0 (path->data, first) &&
+           !g_strcmp0 (path->next->data, second);
+}
+
+/* Query access path for splits.  A match on the account of the split,
+ * as built by xaccQueryAddAccountGUIDMatch, only needs to look at the
+ * splits of the matched accounts.  Posted-date bounds among the other
+ * terms narrow it down to a slice of each account's date index.  The
+ * bounds are only taken to the second, and DAY matches are not used at
+ * all; the query checks every term on the splits it gets.
+ *
+ * A split only joins its account's list, and moves in its date index,
+ * when its transaction is committed, so while any transaction of the
+ * book is open the query scans the whole collection as before. */
+static gboolean
+split_foreach_query_match (QofBook *book, GList *and_terms,
+                           QofInstanceForeachCB cb, gpointer user_data)
+{
+    query_guid_t account_match = NULL;
+    time64 start = G_MININT64, end = G_MAXINT64;
+    GList *node, *guid;
+
+    for (node = and_terms; node; node = node->next)
+    {
+        QofQueryTerm *term = node->data;
+        QofQueryParamList *path = qof_query_term_get_param_path (term);
+        QofQueryPredData *pd = qof_query_term_get_pred_data (term);
+
+        if (qof_query_term_is_inverted (term))
+            continue;
+
+        if (!account_match &&
+                param_path_is (path, SPLIT_ACCOUNT, QOF_PARAM_GUID) &&
+                !g_strcmp0 (pd->type_name, QOF_TYPE_GUID) &&
+                ((query_guid_t)pd)->options == QOF_GUID_MATCH_ANY)
+        {
+            account_match = (query_guid_t)pd;
+        }
+        else if (param_path_is (path, SPLIT_TRANS, TRANS_DATE_POSTED) &&
+                 !g_strcmp0 (pd->type_name, QOF_TYPE_DATE) &&
+                 ((query_date_t)pd)->options == QOF_DATE_MATCH_NORMAL)
+        {
+            Timespec ts = ((query_date_t)pd)->date;
+
+            if (pd->how == QOF_COMPARE_GT || pd->how == QOF_COMPARE_GTE ||
+                    pd->how == QOF_COMPARE_EQUAL)
+                start = MAX (start, ts.tv_sec);
+            /* A date with nanoseconds may still match splits posted
+             * at the next second. */
+            if (pd->how == QOF_COMPARE_LT || pd->how == QOF_COMPARE_LTE ||
+                    pd->how == QOF_COMPARE_EQUAL)
+                end = MIN (end, ts.tv_nsec > 0 ? ts.tv_sec + 1 : ts.tv_sec);
+        }
+    }
+
+    if (!account_match || xaccBookHasOpenTransactions (book))
+        return FALSE;
+
+    for (guid = account_match->guids; guid; guid = guid->next)
+    {
+        Account *acc;
+        GList *prev;
+
+        /* Visit each account once */
+        for (prev = account_match->guids; prev != guid; prev = prev->next)
+            if (guid_equal (prev->data, guid->data))
+                break;
+        if (prev != guid)
+            continue;
+
+        acc = xaccAccountLookup (guid->data, book);
+        if (acc)
+            gnc_account_foreach_split_posted_between (acc, start, end,
+                    cb, user_data);
+    }
+    return TRUE;
+}
+
 /* Hook into the QofObject registry */
 
 #ifdef _MSC_VER
@@ -1988,6 +2189,7 @@ static QofObject split_object_def =
     DI(.foreach           = ) qof_collection_foreach,
     DI(.printable         = ) (const char * (*)(gpointer)) xaccSplitGetMemo,
     DI(.version_cmp       = ) (int (*)(gpointer, gpointer)) qof_instance_version_cmp,
+    DI(.foreach_query_match = ) split_foreach_query_match,
 };
 
 static gpointer
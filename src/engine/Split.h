@@ -153,6 +153,11 @@ void xaccSplitSetLot(Split* split, GNCLot* lot);
  */
 KvpFrame *xaccSplitGetSlots(const Split *split);
 
+/** Returns the KvpFrame slots of this split for changing them.  While
+ * the transaction is open, the slots are recorded first, so that the
+ * changes are undone by xaccTransRollbackEdit. */
+KvpFrame *xaccSplitGetSlotsForEdit(Split *split);
+
 /** Set the KvpFrame slots of this split to the given frm by directly
  * using the frm pointer (i.e. non-copying). */
 void xaccSplitSetSlots_nc(Split *s, KvpFrame *frm);
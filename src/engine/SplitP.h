@@ -68,6 +68,19 @@
 #define GAINS_STATUS_VDIRTY    (GAINS_STATUS_VALU_DIRTY)
 #define GAINS_STATUS_A_VDIRTY  (GAINS_STATUS_AMNT_DIRTY|GAINS_STATUS_VALU_DIRTY|GAINS_STATUS_LOT_DIRTY)
 
+/* The parts of a split's sort order that are costly to derive from the
+ * strings, computed once for xaccSplitOrder.  The key remembers which
+ * strings it was built from and is rebuilt when they no longer match;
+ * the setters drop it outright. */
+typedef struct
+{
+    const char *memo;           /* split->memo the key was built from */
+    const char *action;         /* split->action the key was built from */
+    int action_num;             /* atoi (action) */
+    char *memo_key;             /* g_utf8_collate_key (memo) */
+    char *action_key;           /* g_utf8_collate_key (action) */
+} SplitSortKey;
+
 struct split_s
 {
     QofInstance inst;
@@ -125,6 +138,9 @@ struct split_s
     gnc_numeric  balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
+
+    /* Cached sort key, NULL until the split is first compared. */
+    SplitSortKey *sort_key;
 };
 
 struct _SplitClass
@@ -156,6 +172,21 @@ void xaccSplitUnvoid(Split *split);
 void xaccSplitCommitEdit(Split *s);
 void xaccSplitRollbackEdit(Split *s);
 
+/* Drop the cached sort key after changing memo or action directly. */
+void xaccSplitClearSortKey (Split *split);
+
+/* Record the split's kvp frame, or its gains_split pointer, in the edit
+ * journal of its open transaction before changing it directly, so that
+ * a rollback restores it. */
+void xaccSplitJournalSlots (Split *split);
+void xaccSplitJournalGainsSplit (Split *split);
+
+/* xaccSplitOrder with the book option for using the split action as
+ * the number already looked up, so that sorting a whole list reads it
+ * only once. */
+gint xaccSplitOrder_num_action (const Split *sa, const Split *sb,
+                                gboolean action_for_num);
+
 /* Compute the value of a list of splits in the given currency,
  * excluding the skip_me split. */
 gnc_numeric xaccSplitsComputeValue (GList *splits, const Split * skip_me,
@@ -232,6 +232,207 @@ void mark_trans (Transaction *trans)
     FOR_EACH_SPLIT(trans, mark_split(s));
 }
 
+static void
+trans_clear_sort_key (Transaction *trans)
+{
+    if (!trans->sort_key) return;
+    g_free (trans->sort_key->description_key);
+    g_free (trans->sort_key);
+    trans->sort_key = NULL;
+}
+
+/* The transactions between xaccTransBeginEdit() and the end of their
+ * commit or rollback.  Their splits only join their accounts' split
+ * lists when they are committed, see xaccBookHasOpenTransactions(). */
+static GHashTable *open_transactions = NULL;
+
+static void
+trans_set_open (Transaction *trans, gboolean open)
+{
+    if (open)
+    {
+        if (!open_transactions)
+            open_transactions = g_hash_table_new (g_direct_hash,
+                                                  g_direct_equal);
+        g_hash_table_insert (open_transactions, trans, trans);
+    }
+    else if (open_transactions)
+    {
+        g_hash_table_remove (open_transactions, trans);
+    }
+}
+
+/********************************************************************\
+ * The edit journal.  Each entry holds the address of a field and the
+ * value it had before the edit first changed it.  Rollback writes the
+ * values back, newest first; commit just drops them.
+\********************************************************************/
+
+/* Past this many entries, fields are looked up in a hash table rather
+ * than by scanning the entries. */
+#define JOURNAL_INDEX_MIN 16
+
+typedef enum
+{
+    JOURNAL_VALUE,      /* plain data, copied */
+    JOURNAL_STRING,     /* a reference to a cached string */
+    JOURNAL_SLOTS,      /* a copy of a kvp frame */
+} JournalKind;
+
+typedef struct
+{
+    JournalKind kind;
+    gpointer field;
+    gsize size;
+    union
+    {
+        gnc_numeric numeric;
+        Timespec ts;
+        gpointer ptr;
+        char chr;
+        char *str;
+        KvpFrame *frame;
+    } old;
+} JournalEntry;
+
+struct _TransJournal
+{
+    GArray *entries;
+    GHashTable *fields;
+};
+
+/* Add an entry for field, or return NULL if it needn't be recorded. */
+static JournalEntry *
+journal_add (Transaction *trans, gpointer field, JournalKind kind)
+{
+    TransJournal *journal;
+    JournalEntry entry;
+    guint i;
+
+    if (!trans || qof_instance_get_editlevel (trans) <= 0) return NULL;
+
+    journal = trans->journal;
+    if (!journal)
+    {
+        journal = g_new0 (TransJournal, 1);
+        journal->entries = g_array_new (FALSE, FALSE, sizeof (JournalEntry));
+        trans->journal = journal;
+    }
+
+    if (journal->fields)
+    {
+        if (g_hash_table_lookup (journal->fields, field)) return NULL;
+    }
+    else
+    {
+        for (i = 0; i < journal->entries->len; i++)
+            if (g_array_index (journal->entries, JournalEntry, i).field == field)
+                return NULL;
+        if (journal->entries->len >= JOURNAL_INDEX_MIN)
+        {
+            journal->fields = g_hash_table_new (NULL, NULL);
+            for (i = 0; i < journal->entries->len; i++)
+                g_hash_table_insert (journal->fields,
+                                     g_array_index (journal->entries,
+                                                    JournalEntry, i).field,
+                                     GINT_TO_POINTER (1));
+        }
+    }
+    if (journal->fields)
+        g_hash_table_insert (journal->fields, field, GINT_TO_POINTER (1));
+
+    memset (&entry, 0, sizeof (entry));
+    entry.kind = kind;
+    entry.field = field;
+    g_array_append_val (journal->entries, entry);
+    return &g_array_index (journal->entries, JournalEntry,
+                           journal->entries->len - 1);
+}
+
+void
+xaccTransJournalValue (Transaction *trans, gpointer field, gsize size)
+{
+    JournalEntry *entry;
+
+    g_return_if_fail (field && size <= sizeof (entry->old));
+    entry = journal_add (trans, field, JOURNAL_VALUE);
+    if (!entry) return;
+    entry->size = size;
+    memcpy (&entry->old, field, size);
+}
+
+void
+xaccTransJournalString (Transaction *trans, char **field)
+{
+    JournalEntry *entry;
+
+    g_return_if_fail (field);
+    entry = journal_add (trans, field, JOURNAL_STRING);
+    if (!entry) return;
+    entry->old.str = CACHE_INSERT (*field);
+}
+
+void
+xaccTransJournalSlots (Transaction *trans, QofInstance *inst)
+{
+    JournalEntry *entry;
+
+    g_return_if_fail (inst);
+    entry = journal_add (trans, &inst->kvp_data, JOURNAL_SLOTS);
+    if (!entry) return;
+    entry->old.frame = inst->kvp_data ? kvp_frame_copy (inst->kvp_data) : NULL;
+}
+
+/* Drop the journal, restoring the recorded fields first if rollback. */
+static void
+journal_finish (Transaction *trans, gboolean rollback)
+{
+    TransJournal *journal = trans->journal;
+    guint i;
+
+    if (!journal) return;
+    trans->journal = NULL;
+
+    for (i = journal->entries->len; i > 0; i--)
+    {
+        JournalEntry *entry = &g_array_index (journal->entries,
+                                              JournalEntry, i - 1);
+        switch (entry->kind)
+        {
+        case JOURNAL_VALUE:
+            if (rollback)
+                memcpy (entry->field, &entry->old, entry->size);
+            break;
+        case JOURNAL_STRING:
+            if (rollback)
+            {
+                char **str = entry->field;
+                CACHE_REMOVE (*str);
+                *str = entry->old.str;
+            }
+            else
+                CACHE_REMOVE (entry->old.str);
+            break;
+        case JOURNAL_SLOTS:
+            if (rollback)
+            {
+                KvpFrame **frame = entry->field;
+                if (*frame)
+                    kvp_frame_delete (*frame);
+                *frame = entry->old.frame;
+            }
+            else if (entry->old.frame)
+                kvp_frame_delete (entry->old.frame);
+            break;
+        }
+    }
+
+    g_array_free (journal->entries, TRUE);
+    if (journal->fields)
+        g_hash_table_destroy (journal->fields);
+    g_free (journal);
+}
+
 G_INLINE_FUNC void gen_event_trans (Transaction *trans);
 void gen_event_trans (Transaction *trans)
 {
@@ -274,7 +475,7 @@ gnc_transaction_init(Transaction* trans)
     trans->date_posted.tv_nsec = 0;
 
     trans->marker = 0;
-    trans->orig = NULL;
+    trans->journal = NULL;
     LEAVE (" ");
 }
 
@@ -479,7 +680,8 @@ xaccTransDump (const Transaction *trans, const char *tag)
     printf("    version:     %x\n", qof_instance_get_version(trans));
     printf("    version_chk: %x\n", qof_instance_get_version_check(trans));
     printf("    editlevel:   %x\n", qof_instance_get_editlevel(trans));
-    printf("    orig:        %p\n", trans->orig);
+    printf("    journal:     %u\n",
+           trans->journal ? trans->journal->entries->len : 0);
     printf("    idata:       %x\n", qof_instance_get_idata(trans));
     printf("    splits:      ");
     for (node = trans->splits; node; node = node->next)
@@ -530,7 +732,6 @@ xaccTransSortSplits (Transaction *trans)
 /* This routine is not exposed externally, since it does weird things,
  * like not really owning the splits correctly, and other weirdnesses.
  * This routine is prone to programmer snafu if not used correctly.
- * It is used only by the edit-rollback code.
  */
 /* Actually, it *is* public, and used by Period.c */
 Transaction *
@@ -553,7 +754,7 @@ xaccDupeTransaction (const Transaction *from)
     to->date_entered = from->date_entered;
     to->date_posted = from->date_posted;
     qof_instance_copy_version(to, from);
-    to->orig = NULL;
+    to->journal = NULL;
 
     to->common_currency = from->common_currency;
 
@@ -591,7 +792,7 @@ xaccTransClone (const Transaction *from)
     qof_instance_copy_version(to, from);
     qof_instance_copy_version_check(to, from);
 
-    to->orig            = NULL;
+    to->journal         = NULL;
 
     qof_instance_init_data (&to->inst, GNC_ID_TRANS, qof_instance_get_book(from));
     kvp_frame_delete (to->inst.kvp_data);
@@ -725,6 +926,7 @@ xaccFreeTransaction (Transaction *trans)
     trans->splits = NULL;
 
     /* free up transaction strings */
+    trans_clear_sort_key (trans);
     CACHE_REMOVE(trans->num);
     CACHE_REMOVE(trans->description);
 
@@ -737,11 +939,8 @@ xaccFreeTransaction (Transaction *trans)
     trans->date_posted.tv_sec = 0;
     trans->date_posted.tv_nsec = 0;
 
-    if (trans->orig)
-    {
-        xaccFreeTransaction (trans->orig);
-        trans->orig = NULL;
-    }
+    journal_finish (trans, FALSE);
+    trans_set_open (trans, FALSE);
 
     /* qof_instance_release (&trans->inst); */
     g_object_unref(trans);
@@ -1276,6 +1475,7 @@ xaccTransSetCurrency (Transaction *trans, gnc_commodity *curr)
     xaccTransBeginEdit(trans);
 
     old_fraction = gnc_commodity_get_fraction (trans->common_currency);
+    TRANS_JOURNAL_FIELD (trans, trans->common_currency);
     trans->common_currency = curr;
     fraction = gnc_commodity_get_fraction (curr);
 
@@ -1298,6 +1498,7 @@ xaccTransBeginEdit (Transaction *trans)
 {
     if (!trans) return;
     if (!qof_begin_edit(&trans->inst)) return;
+    trans_set_open (trans, TRUE);
 
     if (qof_book_shutting_down(qof_instance_get_book(trans))) return;
 
@@ -1306,10 +1507,6 @@ xaccTransBeginEdit (Transaction *trans)
         xaccOpenLog ();
         xaccTransWriteLog (trans, 'B');
     }
-
-    /* Make a clone of the transaction; we will use this
-     * in case we need to roll-back the edit. */
-    trans->orig = xaccDupeTransaction (trans);
 }
 
 /********************************************************************\
@@ -1474,11 +1671,9 @@ static void trans_cleanup_commit(Transaction *trans)
     if (!qof_book_is_readonly(qof_instance_get_book(trans)))
         xaccTransWriteLog (trans, 'C');
 
-    /* Get rid of the copy we made. We won't be rolling back,
-     * so we don't need it any more.  */
-    PINFO ("get rid of rollback trans=%p", trans->orig);
-    xaccFreeTransaction (trans->orig);
-    trans->orig = NULL;
+    /* We won't be rolling back, so we don't need the journal any more. */
+    PINFO ("discard edit journal of trans=%p", trans);
+    journal_finish (trans, FALSE);
 
     /* Sort the splits. Why do we need to do this ?? */
     /* Good question.  Who knows?  */
@@ -1487,6 +1682,7 @@ static void trans_cleanup_commit(Transaction *trans)
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
     g_assert(qof_instance_get_editlevel(trans) == 0);
+    trans_set_open (trans, FALSE);
 
     gen_event_trans (trans); //TODO: could be conditional
     qof_event_gen (&trans->inst, QOF_EVENT_MODIFY, NULL);
@@ -1564,8 +1760,6 @@ xaccTransCommitEdit (Transaction *trans)
     LEAVE ("(trans=%p)", trans);
 }
 
-#define SWAP(a, b) do { gpointer tmp = (a); (a) = (b); (b) = tmp; } while (0);
-
 /* Ughhh. The Rollback function is terribly complex, and, what's worse,
  * it only rolls back the basics.  The TransCommit functions did a bunch
  * of Lot/Cap-gains scrubbing that don't get addressed/undone here, and
@@ -1577,18 +1771,15 @@ xaccTransCommitEdit (Transaction *trans)
 void
 xaccTransRollbackEdit (Transaction *trans)
 {
-    GList *node, *onode;
+    GList *node;
     QofBackend *be;
-    Transaction *orig;
     GList *slist;
-    int num_preexist, i;
 
 /* FIXME: This isn't quite the right way to handle nested edits --
  * there should be a stack of transaction states that are popped off
  * and restored at each level -- but it does prevent restoring to the
  * editlevel 0 state until one is returning to editlevel 0, and
- * thereby prevents a crash caused by trans->orig getting NULLed too
- * soon.
+ * thereby prevents the journal from being replayed too soon.
  */
     if (!qof_instance_get_editlevel (QOF_INSTANCE (trans))) return;
     if (qof_instance_get_editlevel (QOF_INSTANCE (trans)) > 1) {
@@ -1600,49 +1791,26 @@ xaccTransRollbackEdit (Transaction *trans)
 
     check_open(trans);
 
-    /* copy the original values back in. */
-
-    orig = trans->orig;
-    SWAP(trans->num, orig->num);
-    SWAP(trans->description, orig->description);
-    trans->date_entered = orig->date_entered;
-    trans->date_posted = orig->date_posted;
-    SWAP(trans->common_currency, orig->common_currency);
-    SWAP(trans->inst.kvp_data, orig->inst.kvp_data);
-
-    /* The splits at the front of trans->splits are exactly the same
-       splits as in the original, but some of them may have changed, so
-       we restore only those. */
-/* FIXME: Runs off the transaction's splits, so deleted splits are not
- * restored!
- */
-    num_preexist = g_list_length(orig->splits);
+    /* Put back the original values of everything the edit changed. */
+    journal_finish (trans, TRUE);
+    trans_clear_sort_key (trans);
+
+    /* Splits that were in the transaction when the edit started may
+       have been moved away or destroyed; splits added during the edit
+       have to go again. */
     slist = g_list_copy(trans->splits);
-    for (i = 0, node = slist, onode = orig->splits; node;
-            i++, node = node->next, onode = onode ? onode->next : NULL)
+    for (node = slist; node; node = node->next)
     {
         Split *s = node->data;
 
         if (!qof_instance_is_dirty(QOF_INSTANCE(s)))
             continue;
 
-        if (i < num_preexist)
+        xaccSplitClearSortKey (s);
+        if (s->orig_parent == trans)
         {
-            Split *so = onode->data;
-
             xaccSplitRollbackEdit(s);
-            SWAP(s->action, so->action);
-            SWAP(s->memo, so->memo);
-            SWAP(s->inst.kvp_data, so->inst.kvp_data);
-            s->reconciled = so->reconciled;
-            s->amount = so->amount;
-            s->value = so->value;
-            s->lot = so->lot;
-            s->gains_split = so->gains_split;
-            //SET_GAINS_A_VDIRTY(s);
-            s->date_reconciled = so->date_reconciled;
             qof_instance_mark_clean(QOF_INSTANCE(s));
-            xaccFreeSplit(so);
         }
         else
         {
@@ -1669,8 +1837,8 @@ xaccTransRollbackEdit (Transaction *trans)
         }
     }
     g_list_free(slist);
-    g_list_free(orig->splits);
-    orig->splits = NULL;
+    /* Restoring the splits' parents went through the setters. */
+    journal_finish (trans, FALSE);
 
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
@@ -1717,13 +1885,11 @@ xaccTransRollbackEdit (Transaction *trans)
     if (!qof_book_is_readonly(qof_instance_get_book(trans)))
         xaccTransWriteLog (trans, 'R');
 
-    xaccFreeTransaction (trans->orig);
-
-    trans->orig = NULL;
     qof_instance_set_destroying(trans, FALSE);
 
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
+    trans_set_open (trans, FALSE);
     /* FIXME: The register code seems to depend on the engine to
        generate an event during rollback, even though the state is just
        reverting to what it was. */
@@ -1738,6 +1904,28 @@ xaccTransIsOpen (const Transaction *trans)
     return trans ? (0 < qof_instance_get_editlevel(trans)) : FALSE;
 }
 
+gboolean
+xaccBookHasOpenTransactions (const QofBook *book)
+{
+    GHashTableIter iter;
+    gpointer key;
+
+    if (!open_transactions) return FALSE;
+
+    g_hash_table_iter_init (&iter, open_transactions);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+        Transaction *trans = key;
+
+        /* Transactions can also be closed by the QOF edit calls */
+        if (!xaccTransIsOpen (trans))
+            g_hash_table_iter_remove (&iter);
+        else if (qof_instance_get_book (trans) == book)
+            return TRUE;
+    }
+    return FALSE;
+}
+
 #define SECS_PER_DAY 86400
 
 int
@@ -1750,7 +1938,43 @@ int
 xaccTransOrder_num_action (const Transaction *ta, const char *actna,
                             const Transaction *tb, const char *actnb)
 {
-    char *da, *db;
+    int na, nb;
+
+    /* sort on split action string, if not NULL */
+    if (actna && actnb)
+    {
+        na = atoi(actna);
+        nb = atoi(actnb);
+        return xaccTransOrder_parsed (ta, &na, tb, &nb);
+    }
+    return xaccTransOrder_parsed (ta, NULL, tb, NULL);
+}
+
+static const TransSortKey *
+trans_get_sort_key (const Transaction *trans)
+{
+    TransSortKey *key = trans->sort_key;
+
+    if (key && key->num == trans->num && key->description == trans->description)
+        return key;
+
+    if (!key)
+        key = ((Transaction *)trans)->sort_key = g_new0 (TransSortKey, 1);
+    else
+        g_free (key->description_key);
+    key->num = trans->num;
+    key->description = trans->description;
+    key->num_value = trans->num ? atoi (trans->num) : 0;
+    key->description_key = g_utf8_collate_key (trans->description ?
+                                               trans->description : "", -1);
+    return key;
+}
+
+int
+xaccTransOrder_parsed (const Transaction *ta, const int *actna,
+                       const Transaction *tb, const int *actnb)
+{
+    const TransSortKey *ka, *kb;
     int na, nb, retval;
 
     if ( ta && !tb ) return -1;
@@ -1760,17 +1984,12 @@ xaccTransOrder_num_action (const Transaction *ta, const char *actna,
     /* if dates differ, return */
     DATE_CMP(ta, tb, date_posted);
 
-    /* otherwise, sort on number string */
-    if (actna && actnb) /* split action string, if not NULL */
-    {
-        na = atoi(actna);
-        nb = atoi(actnb);
-    }
-    else                /* else transaction num string */
-    {
-        na = atoi(ta->num);
-        nb = atoi(tb->num);
-    }
+    /* otherwise, sort on number: the split actions if given, else the
+     * transaction nums */
+    ka = trans_get_sort_key (ta);
+    kb = trans_get_sort_key (tb);
+    na = actna ? *actna : ka->num_value;
+    nb = actnb ? *actnb : kb->num_value;
     if (na < nb) return -1;
     if (na > nb) return +1;
 
@@ -1778,9 +1997,7 @@ xaccTransOrder_num_action (const Transaction *ta, const char *actna,
     DATE_CMP(ta, tb, date_entered);
 
     /* otherwise, sort on description string */
-    da = ta->description ? ta->description : "";
-    db = tb->description ? tb->description : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (ka->description_key, kb->description_key);
     if (retval)
         return retval;
 
@@ -1804,6 +2021,7 @@ xaccTransSetDateInternal(Transaction *trans, Timespec *dadate, Timespec val)
         g_free(tstr);
     }
 
+    xaccTransJournalValue (trans, dadate, sizeof (*dadate));
     *dadate = val;
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);
@@ -1847,10 +2065,12 @@ xaccTransSetDatePostedGDate (Transaction *trans, GDate date)
     KvpValue* kvp_value;
     KvpFrame* frame;
     if (!trans) return;
+    xaccTransBeginEdit(trans);
 
     /* We additionally save this date into a kvp frame to ensure in
      * the future a date which was set as *date* (without time) can
      * clearly be distinguished from the Timespec. */
+    xaccTransJournalSlots (trans, &trans->inst);
     kvp_value = kvp_value_new_gdate(date);
     frame = kvp_frame_set_value_nc(trans->inst.kvp_data, TRANS_DATE_POSTED, kvp_value);
     if (!frame)
@@ -1862,6 +2082,7 @@ xaccTransSetDatePostedGDate (Transaction *trans, GDate date)
     xaccTransSetDateInternal(trans, &trans->date_posted,
                              gdate_to_timespec(date));
     set_gains_date_dirty (trans);
+    xaccTransCommitEdit(trans);
 }
 
 void
@@ -1924,6 +2145,7 @@ xaccTransSetDateDueTS (Transaction *trans, const Timespec *ts)
 {
     if (!trans || !ts) return;
     xaccTransBeginEdit(trans);
+    xaccTransJournalSlots (trans, &trans->inst);
     kvp_frame_set_timespec (trans->inst.kvp_data, TRANS_DATE_DUE_KVP, *ts);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
@@ -1935,6 +2157,7 @@ xaccTransSetTxnType (Transaction *trans, char type)
     char s[2] = {type, '\0'};
     g_return_if_fail(trans);
     xaccTransBeginEdit(trans);
+    xaccTransJournalSlots (trans, &trans->inst);
     kvp_frame_set_str (trans->inst.kvp_data, TRANS_TXN_TYPE_KVP, s);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
@@ -1945,6 +2168,7 @@ void xaccTransClearReadOnly (Transaction *trans)
     if (trans)
     {
         xaccTransBeginEdit(trans);
+        xaccTransJournalSlots (trans, &trans->inst);
         kvp_frame_set_slot_path (trans->inst.kvp_data, NULL,
                                  TRANS_READ_ONLY_REASON, NULL);
         qof_instance_set_dirty(QOF_INSTANCE(trans));
@@ -1958,6 +2182,7 @@ xaccTransSetReadOnly (Transaction *trans, const char *reason)
     if (trans && reason)
     {
         xaccTransBeginEdit(trans);
+        xaccTransJournalSlots (trans, &trans->inst);
         kvp_frame_set_str (trans->inst.kvp_data,
                            TRANS_READ_ONLY_REASON, reason);
         qof_instance_set_dirty(QOF_INSTANCE(trans));
@@ -1984,7 +2209,9 @@ xaccTransSetNum (Transaction *trans, const char *xnum)
     if (!trans || !xnum) return;
     xaccTransBeginEdit(trans);
 
+    xaccTransJournalString (trans, &trans->num);
     CACHE_REPLACE(trans->num, xnum);
+    trans_clear_sort_key (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);  /* Dirty balance of every account in trans */
     xaccTransCommitEdit(trans);
@@ -2004,7 +2231,9 @@ xaccTransSetDescription (Transaction *trans, const char *desc)
     if (!trans || !desc) return;
     xaccTransBeginEdit(trans);
 
+    xaccTransJournalString (trans, &trans->description);
     CACHE_REPLACE(trans->description, desc);
+    trans_clear_sort_key (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
 }
@@ -2015,6 +2244,7 @@ xaccTransSetAssociation (Transaction *trans, const char *assoc)
     if (!trans || !assoc) return;
     xaccTransBeginEdit(trans);
 
+    xaccTransJournalSlots (trans, &trans->inst);
     kvp_frame_set_str (trans->inst.kvp_data, assoc_uri_str, assoc);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
@@ -2034,6 +2264,7 @@ xaccTransSetNotes (Transaction *trans, const char *notes)
     if (!trans || !notes) return;
     xaccTransBeginEdit(trans);
 
+    xaccTransJournalSlots (trans, &trans->inst);
     kvp_frame_set_str (trans->inst.kvp_data, trans_notes_str, notes);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
@@ -2044,6 +2275,7 @@ xaccTransSetIsClosingTxn (Transaction *trans, gboolean is_closing)
 {
     if (!trans) return;
     xaccTransBeginEdit(trans);
+    xaccTransJournalSlots (trans, &trans->inst);
 
     if (is_closing)
         kvp_frame_set_gint64 (trans->inst.kvp_data, trans_is_closing_str, 1);
@@ -2117,6 +2349,14 @@ xaccTransGetNotes (const Transaction *trans)
            kvp_frame_get_string (trans->inst.kvp_data, trans_notes_str) : NULL;
 }
 
+KvpFrame *
+xaccTransGetSlotsForEdit (Transaction *trans)
+{
+    if (!trans) return NULL;
+    xaccTransJournalSlots (trans, &trans->inst);
+    return trans->inst.kvp_data;
+}
+
 gboolean
 xaccTransGetIsClosingTxn (const Transaction *trans)
 {
@@ -2238,37 +2478,19 @@ xaccTransGetReadOnly (const Transaction *trans)
 
 gboolean xaccTransIsReadonlyByPostedDate(const Transaction *trans)
 {
-    GDate *threshold_date;
+    GDate threshold_date;
     GDate trans_date;
     const QofBook *book = xaccTransGetBook (trans);
-    gboolean result;
     g_assert(trans);
 
-    if (!qof_book_uses_autoreadonly(book))
+    if (!qof_book_get_autoreadonly_date(book, &threshold_date))
     {
         return FALSE;
     }
 
-    threshold_date = qof_book_get_autoreadonly_gdate(book);
-    g_assert(threshold_date); // ok because we checked uses_autoreadonly before
     trans_date = xaccTransGetDatePostedGDate(trans);
 
-//    g_warning("there is auto-read-only with days=%d, trans_date_day=%d, threshold_date_day=%d",
-//              qof_book_get_num_days_autofreeze(book),
-//              g_date_get_day(&trans_date),
-//              g_date_get_day(threshold_date));
-
-    if (g_date_compare(&trans_date, threshold_date) < 0)
-    {
-        //g_warning("we are auto-read-only");
-        result = TRUE;
-    }
-    else
-    {
-        result = FALSE;
-    }
-    g_date_free(threshold_date);
-    return result;
+    return (g_date_compare(&trans_date, &threshold_date) < 0);
 }
 
 /*################## Added for Reg2 #################*/
@@ -2393,6 +2615,7 @@ xaccTransVoid(Transaction *trans, const char *reason)
     g_return_if_fail(trans && reason);
 
     xaccTransBeginEdit(trans);
+    xaccTransJournalSlots (trans, &trans->inst);
     frame = trans->inst.kvp_data;
 
     val = kvp_frame_get_slot(frame, trans_notes_str);
@@ -2452,6 +2675,7 @@ xaccTransUnvoid (Transaction *trans)
     if (!val) return; /* Transaction isn't voided. Bail. */
 
     xaccTransBeginEdit(trans);
+    xaccTransJournalSlots (trans, &trans->inst);
 
     val = kvp_frame_get_slot(frame, void_former_notes_str);
     kvp_frame_set_slot(frame, trans_notes_str, val);
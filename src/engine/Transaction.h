@@ -333,6 +333,12 @@ const char *  xaccTransGetAssociation(const Transaction *trans);
  The Notes field is only visible in the register in double-line mode */
 const char *  xaccTransGetNotes (const Transaction *trans);
 
+/** Returns the transaction's kvp frame for changing it.  While the
+ *  transaction is open, the frame is recorded first, so that the
+ *  changes are undone by xaccTransRollbackEdit.  Use xaccTransGetSlots
+ *  to only read it. */
+KvpFrame *    xaccTransGetSlotsForEdit (Transaction *trans);
+
 
 /** Sets whether or not this transaction is a "closing transaction" */
 void          xaccTransSetIsClosingTxn (Transaction *trans, gboolean is_closing);
@@ -71,6 +71,19 @@
  * A "split" is more commonly referred to as an "entry" in a "transaction".
  */
 
+/* The parts of a transaction's sort order that are costly to derive
+ * from the strings; see SplitSortKey. */
+typedef struct
+{
+    const char *num;            /* trans->num the key was built from */
+    const char *description;    /* trans->description the key was built from */
+    int num_value;              /* atoi (num) */
+    char *description_key;      /* g_utf8_collate_key (description) */
+} TransSortKey;
+
+/* The edit journal of an open transaction, private to Transaction.c. */
+typedef struct _TransJournal TransJournal;
+
 struct transaction_s
 {
     QofInstance inst;     /* glbally unique id */
@@ -105,11 +118,15 @@ struct transaction_s
      * corresponding to the current traversal. */
     unsigned char  marker;
 
-    /* The orig pointer points at a copy of the original transaction,
-     * before editing was started.  This orig copy is used to rollback
-     * any changes made if/when the edit is abandoned.
+    /* The journal records the value each field of the transaction and
+     * of its splits had before it was first changed in the current
+     * edit.  It is replayed to rollback the changes if/when the edit is
+     * abandoned, and discarded on commit.  NULL until a field changes.
      */
-    Transaction *orig;
+    TransJournal *journal;
+
+    /* Cached sort key, NULL until the transaction is first compared. */
+    TransSortKey *sort_key;
 };
 
 struct _TransactionClass
@@ -117,6 +134,19 @@ struct _TransactionClass
     QofInstanceClass parent_class;
 };
 
+/* Record the current contents of a field of the transaction, or of
+ * one of its splits, in the transaction's edit journal before changing
+ * it.  Only the first change of a field in an edit is recorded, and
+ * nothing is recorded unless the transaction is open.  Plain values are
+ * copied with xaccTransJournalValue (or the TRANS_JOURNAL_FIELD
+ * shorthand), cached strings with xaccTransJournalString, and kvp
+ * frames with xaccTransJournalSlots. */
+void xaccTransJournalValue (Transaction *trans, gpointer field, gsize size);
+void xaccTransJournalString (Transaction *trans, char **field);
+void xaccTransJournalSlots (Transaction *trans, QofInstance *inst);
+#define TRANS_JOURNAL_FIELD(trans, field) \
+    xaccTransJournalValue ((trans), &(field), sizeof (field))
+
 /* Set the transaction's GncGUID. This should only be done when reading
  * a transaction from a datafile, or some other external source. Never
  * call this on an existing transaction! */
@@ -172,8 +202,18 @@ void xaccDisableDataScrubbing(void);
 #define xaccTransSetSlots_nc(T,F) qof_instance_set_slots(QOF_INSTANCE(T),F)
 
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
+
+/* xaccTransOrder_num_action with the split action numbers already
+ * parsed; pass NULL for both to compare the transaction numbers. */
+int xaccTransOrder_parsed (const Transaction *ta, const int *actna,
+                           const Transaction *tb, const int *actnb);
 void check_open (const Transaction *trans);
 
+/* TRUE if any transaction of the book is open for editing.  The splits
+ * of open transactions may be missing from, or out of date in, their
+ * accounts' split lists. */
+gboolean xaccBookHasOpenTransactions (const QofBook *book);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
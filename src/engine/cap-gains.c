@@ -550,6 +550,7 @@ xaccSplitAssignToLot (Split *split, GNCLot *lot)
         /* Add kvp markup to indicate that these two splits used
          * to be one before being 'split'
          */
+        xaccSplitJournalSlots (split);
         gnc_kvp_bag_add (split->inst.kvp_data, "lot-split", now,
                          "peer_guid", xaccSplitGetGUID (new_split),
                          NULL);
@@ -760,6 +761,7 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
         if (!s)
         {
             PERR ("Bad gains-split pointer! .. trying to recover.");
+            xaccSplitJournalGainsSplit (split);
             split->gains_split = xaccSplitGetCapGainsSplit (split);
             s = split->gains_split;
             if (!s) return;
@@ -970,10 +972,12 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
              * to the gains source.
              */
             xaccTransBeginEdit (base_txn);
+            xaccSplitJournalSlots (split);
             kvp_frame_set_guid (split->inst.kvp_data, "gains-split",
                                 xaccSplitGetGUID (lot_split));
             qof_instance_set_dirty (QOF_INSTANCE (split));
             xaccTransCommitEdit (base_txn);
+            xaccSplitJournalSlots (lot_split);
             kvp_frame_set_guid (lot_split->inst.kvp_data, "gains-source",
                                 xaccSplitGetGUID (split));
 
@@ -1032,6 +1036,9 @@ xaccSplitComputeCapGains(Split *split, Account *gain_acc)
             xaccSplitSetValue (gain_split, negvalue);
 
             /* Some short-cuts to help avoid the above kvp lookup. */
+            xaccSplitJournalGainsSplit (split);
+            xaccSplitJournalGainsSplit (lot_split);
+            xaccSplitJournalGainsSplit (gain_split);
             split->gains = GAINS_STATUS_CLEAN;
             split->gains_split = lot_split;
             lot_split->gains = GAINS_STATUS_GAINS;
@@ -57,6 +57,9 @@ struct gnc_price_db_s
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
+    GHashTable *conversion_cache;  /* memoized balance conversion rates */
+    GHashTable *conversion_graph;  /* commodity -> commodities it has
+                                      prices with; NULL if stale */
 };
 
 struct _GncPriceDBClass
@@ -34,6 +34,9 @@ static QofLogModule log_module = GNC_MOD_PRICE;
 
 static gboolean add_price(GNCPriceDB *db, GNCPrice *p);
 static gboolean remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup);
+static void pricedb_invalidate_conversions (GNCPriceDB *db);
+static guint price_rate_key_hash (gconstpointer key);
+static gboolean price_rate_key_equal (gconstpointer a, gconstpointer b);
 static GNCPrice *lookup_nearest_in_time(GNCPriceDB *db, const gnc_commodity *c,
                                         const gnc_commodity *currency,
                                         Timespec t, gboolean sameday);
@@ -482,6 +485,7 @@ gnc_price_set_value(GNCPrice *p, gnc_numeric value)
         p->value = value;
         gnc_price_set_dirty(p);
         gnc_price_commit_edit (p);
+        pricedb_invalidate_conversions (p->db);
     }
 }
 
@@ -733,12 +737,200 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
 
    Structurally a GNCPriceDB contains a hash mapping price commodities
    (of type gnc_commodity*) to hashes mapping price currencies (of
-   type gnc_commodity*) to GNCPrice lists (see gnc-pricedb.h for a
-   description of GNCPrice lists).  The top-level key is the commodity
-   you want the prices for, and the second level key is the commodity
-   that the value is expressed in terms of.
+   type gnc_commodity*) to PriceSeries arrays (see below).  The
+   top-level key is the commodity you want the prices for, and the
+   second level key is the commodity that the value is expressed in
+   terms of.
  */
 
+/* The prices for one commodity/currency pair.  The array is kept in
+ * compare_prices_by_date order (most recent first) so that the date
+ * lookups can binary search it.  While the db is in bulk update mode
+ * new prices are just appended; if that breaks the order the array is
+ * sorted again the first time it is read. */
+typedef struct
+{
+    GPtrArray *prices;
+    gboolean sorted;
+} PriceSeries;
+
+#define price_series_index(series, i) \
+    ((GNCPrice *) g_ptr_array_index ((series)->prices, (i)))
+
+static PriceSeries *
+price_series_new (void)
+{
+    PriceSeries *series = g_new0 (PriceSeries, 1);
+    series->prices = g_ptr_array_new ();
+    series->sorted = TRUE;
+    return series;
+}
+
+static void
+price_series_destroy (PriceSeries *series)
+{
+    guint i;
+
+    for (i = 0; i < series->prices->len; i++)
+    {
+        GNCPrice *p = price_series_index (series, i);
+        p->db = NULL;
+        gnc_price_unref (p);
+    }
+    g_ptr_array_free (series->prices, TRUE);
+    g_free (series);
+}
+
+static gint
+compare_price_ptrs_by_date (gconstpointer a, gconstpointer b)
+{
+    return compare_prices_by_date (*(GNCPrice * const *) a,
+                                   *(GNCPrice * const *) b);
+}
+
+static void
+price_series_sort (PriceSeries *series)
+{
+    if (series->sorted) return;
+    g_ptr_array_sort (series->prices, compare_price_ptrs_by_date);
+    series->sorted = TRUE;
+}
+
+/* Returns the index of the most recent price not later than t, or the
+ * length of the series if all of its prices are later than t. */
+static guint
+price_series_find_at_or_before (PriceSeries *series, Timespec t)
+{
+    guint lo = 0, hi;
+
+    price_series_sort (series);
+    hi = series->prices->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        Timespec price_time = gnc_price_get_time (price_series_index (series, mid));
+
+        if (timespec_cmp (&price_time, &t) > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Returns the index at which p sorts in the series. */
+static guint
+price_series_find_position (PriceSeries *series, GNCPrice *p)
+{
+    guint lo = 0, hi;
+
+    price_series_sort (series);
+    hi = series->prices->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (compare_prices_by_date (price_series_index (series, mid), p) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Prices on the same day are adjacent in the series, so only the
+ * neighbours of p's position need to be checked for a duplicate. */
+static gboolean
+price_series_has_duplicate (PriceSeries *series, GNCPrice *p, guint pos)
+{
+    PriceListIsDuplStruct dupl;
+    Timespec p_day = timespecCanonicalDayTime (gnc_price_get_time (p));
+    guint i;
+
+    dupl.pPrice = p;
+    dupl.isDupl = FALSE;
+
+    for (i = pos; i > 0 && !dupl.isDupl; i--)
+    {
+        GNCPrice *other = price_series_index (series, i - 1);
+        Timespec day = timespecCanonicalDayTime (gnc_price_get_time (other));
+        if (!timespec_equal (&day, &p_day)) break;
+        price_list_is_duplicate (other, &dupl);
+    }
+    for (i = pos; i < series->prices->len && !dupl.isDupl; i++)
+    {
+        GNCPrice *other = price_series_index (series, i);
+        Timespec day = timespecCanonicalDayTime (gnc_price_get_time (other));
+        if (!timespec_equal (&day, &p_day)) break;
+        price_list_is_duplicate (other, &dupl);
+    }
+    return dupl.isDupl;
+}
+
+/* Same contract as gnc_price_list_insert(): the series takes a
+ * reference to p, and a duplicate is silently not inserted. */
+static gboolean
+price_series_insert (PriceSeries *series, GNCPrice *p, gboolean bulk_update)
+{
+    GPtrArray *prices = series->prices;
+    guint pos;
+
+    gnc_price_ref (p);
+
+    if (bulk_update)
+    {
+        /* Loads normally come in most-recent-first order, so appending
+         * usually keeps the series sorted. */
+        if (series->sorted && prices->len > 0 &&
+                compare_prices_by_date (price_series_index (series, prices->len - 1), p) > 0)
+            series->sorted = FALSE;
+        g_ptr_array_add (prices, p);
+        return TRUE;
+    }
+
+    pos = price_series_find_position (series, p);
+    if (price_series_has_duplicate (series, p, pos))
+        return TRUE;
+
+    g_ptr_array_add (prices, NULL);
+    memmove (prices->pdata + pos + 1, prices->pdata + pos,
+             (prices->len - 1 - pos) * sizeof (gpointer));
+    prices->pdata[pos] = p;
+    return TRUE;
+}
+
+static gboolean
+price_series_remove (PriceSeries *series, GNCPrice *p)
+{
+    guint pos = price_series_find_position (series, p);
+
+    if (pos >= series->prices->len || price_series_index (series, pos) != p)
+    {
+        /* Not where its date says it should be; fall back to a scan. */
+        for (pos = 0; pos < series->prices->len; pos++)
+            if (price_series_index (series, pos) == p) break;
+        if (pos == series->prices->len) return TRUE;
+    }
+
+    g_ptr_array_remove_index (series->prices, pos);
+    gnc_price_unref (p);
+    return TRUE;
+}
+
+/* Returns a new list of the prices in the series, most recent first.
+ * The prices are not reffed. */
+static GList *
+price_series_to_list (PriceSeries *series)
+{
+    GList *result = NULL;
+    guint i;
+
+    price_series_sort (series);
+    for (i = series->prices->len; i > 0; i--)
+        result = g_list_prepend (result, price_series_index (series, i - 1));
+    return result;
+}
+
 /* GObject Initialization */
 QOF_GOBJECT_IMPL(gnc_pricedb, GNCPriceDB, QOF_TYPE_INSTANCE);
 
@@ -787,6 +979,10 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(NULL, NULL);
     g_return_val_if_fail (result->commodity_hash, NULL);
+    result->conversion_cache = g_hash_table_new_full (price_rate_key_hash,
+                               price_rate_key_equal,
+                               g_free,
+                               (GDestroyNotify) g_list_free);
     return result;
 }
 
@@ -795,18 +991,7 @@ destroy_pricedb_currency_hash_data(gpointer key,
                                    gpointer data,
                                    gpointer user_data)
 {
-    GList *price_list = (GList *) data;
-    GList *node;
-    GNCPrice *p;
-
-    for (node = price_list; node; node = node->next)
-    {
-        p = node->data;
-
-        p->db = NULL;
-    }
-
-    gnc_price_list_destroy(price_list);
+    price_series_destroy ((PriceSeries *) data);
 }
 
 static void
@@ -834,6 +1019,9 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    pricedb_invalidate_conversions (db);
+    g_hash_table_destroy (db->conversion_cache);
+    db->conversion_cache = NULL;
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -916,7 +1104,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
     GNCPriceDBEqualData *equal_data = user_data;
     gnc_commodity *currency = key;
-    GList *price_list1 = val;
+    GList *price_list1 = price_series_to_list ((PriceSeries *) val);
     GList *price_list2;
 
     price_list2 = gnc_pricedb_get_prices (equal_data->db2,
@@ -926,6 +1114,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
     if (!gnc_price_list_equal (price_list1, price_list2))
         equal_data->equal = FALSE;
 
+    g_list_free (price_list1);
     gnc_price_list_destroy (price_list2);
 }
 
@@ -975,7 +1164,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
 {
     /* This function will use p, adding a ref, so treat p as read-only
        if this function succeeds. */
-    GList *price_list;
+    PriceSeries *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1019,18 +1208,18 @@ add_price(GNCPriceDB *db, GNCPrice *p)
         g_hash_table_insert(db->commodity_hash, commodity, currency_hash);
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
     {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
+        series = price_series_new();
+        g_hash_table_insert(currency_hash, currency, series);
     }
-    if (!price_list)
+    if (!price_series_insert(series, p, db->bulk_update))
     {
-        LEAVE (" no price list");
+        LEAVE ("price_series_insert failed");
         return FALSE;
     }
-    g_hash_table_insert(currency_hash, currency, price_list);
+    pricedb_invalidate_conversions (db);
     p->db = db;
     qof_event_gen (&p->inst, QOF_EVENT_ADD, NULL);
 
@@ -1080,7 +1269,7 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
 static gboolean
 remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
 {
-    GList *price_list;
+    PriceSeries *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1116,24 +1305,27 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
     }
 
     qof_event_gen (&p->inst, QOF_EVENT_REMOVE, NULL);
-    price_list = g_hash_table_lookup(currency_hash, currency);
+    pricedb_invalidate_conversions (db);
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
+    {
+        LEAVE (" no price series");
+        return FALSE;
+    }
     gnc_price_ref(p);
-    if (!gnc_price_list_remove(&price_list, p))
+    if (!price_series_remove(series, p))
     {
         gnc_price_unref(p);
-        LEAVE (" cannot remove price list");
+        LEAVE (" cannot remove price from series");
         return FALSE;
     }
 
-    /* if the price list is empty, then remove this currency from the
+    /* if the price series is empty, then remove this currency from the
        commodity hash */
-    if (price_list)
-    {
-        g_hash_table_insert(currency_hash, currency, price_list);
-    }
-    else
+    if (series->prices->len == 0)
     {
         g_hash_table_remove(currency_hash, currency);
+        price_series_destroy(series);
 
         if (cleanup)
         {
@@ -1228,18 +1420,21 @@ pricedb_remove_foreach_pricelist (gpointer key,
                                   gpointer val,
                                   gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    PriceSeries *series = (PriceSeries *) val;
     remove_info *data = (remove_info *) user_data;
+    guint i = 0;
 
     ENTER("key %p, value %p, data %p", key, val, user_data);
 
-    /* The most recent price is the first in the list */
+    price_series_sort(series);
+
+    /* The most recent price is the first in the series */
     if (!data->delete_last)
-        node = g_list_next(node);
+        i = 1;
 
-    /* now check each item in the list */
-    g_list_foreach(node, (GFunc)check_one_price_date, data);
+    /* now check each item in the series */
+    for (; i < series->prices->len; i++)
+        check_one_price_date(price_series_index(series, i), data);
 
     LEAVE(" ");
 }
@@ -1308,7 +1503,7 @@ gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
+    PriceSeries *series;
     GNCPrice *result;
     GHashTable *currency_hash;
     QofBook *book;
@@ -1337,17 +1532,18 @@ gnc_pricedb_lookup_latest(GNCPriceDB *db,
         return NULL;
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!price_list)
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
     {
         LEAVE (" no price list");
         return NULL;
     }
 
-    /* This works magically because prices are inserted in date-sorted
+    /* This works magically because prices are kept in date-sorted
      * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = price_list->data;
+     * first in the series.  */
+    price_series_sort(series);
+    result = price_series_index(series, 0);
     gnc_price_ref(result);
     LEAVE(" ");
     return result;
@@ -1358,13 +1554,14 @@ static void
 lookup_latest(gpointer key, gpointer val, gpointer user_data)
 {
     //gnc_commodity *currency = (gnc_commodity *)key;
-    GList *price_list = (GList *)val;
+    PriceSeries *series = (PriceSeries *)val;
     GList **return_list = (GList **)user_data;
 
-    if (!price_list) return;
+    if (!series || series->prices->len == 0) return;
 
-    /* the latest price is the first in list */
-    gnc_price_list_insert(return_list, price_list->data, FALSE);
+    /* the latest price is the first in the series */
+    price_series_sort(series);
+    gnc_price_list_insert(return_list, price_series_index(series, 0), FALSE);
 }
 
 PriceList *
@@ -1419,7 +1616,7 @@ static void
 hash_values_helper(gpointer key, gpointer value, gpointer data)
 {
     GList ** l = data;
-    *l = g_list_concat(*l, g_list_copy (value));
+    *l = g_list_concat(*l, price_series_to_list ((PriceSeries *) value));
 }
 
 gboolean
@@ -1427,7 +1624,7 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
                        const gnc_commodity *commodity,
                        const gnc_commodity *currency)
 {
-    GList *price_list;
+    PriceSeries *series;
     GHashTable *currency_hash;
     gint size;
     QofBook *book;
@@ -1457,8 +1654,8 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
 
     if (currency)
     {
-        price_list = g_hash_table_lookup(currency_hash, currency);
-        if (price_list)
+        series = g_hash_table_lookup(currency_hash, currency);
+        if (series)
         {
             LEAVE("yes");
             return TRUE;
@@ -1478,7 +1675,7 @@ gnc_pricedb_get_prices(GNCPriceDB *db,
                        const gnc_commodity *commodity,
                        const gnc_commodity *currency)
 {
-    GList *price_list;
+    PriceSeries *series;
     GList *result;
     GList *node;
     GHashTable *currency_hash;
@@ -1509,13 +1706,13 @@ gnc_pricedb_get_prices(GNCPriceDB *db,
 
     if (currency)
     {
-        price_list = g_hash_table_lookup(currency_hash, currency);
-        if (!price_list)
+        series = g_hash_table_lookup(currency_hash, currency);
+        if (!series)
         {
             LEAVE (" no price list");
             return NULL;
         }
-        result = g_list_copy (price_list);
+        result = price_series_to_list (series);
     }
     else
     {
@@ -1545,9 +1742,9 @@ gnc_pricedb_lookup_at_time(GNCPriceDB *db,
                            const gnc_commodity *currency,
                            Timespec t)
 {
-    GList *price_list;
+    PriceSeries *series;
     GList *result = NULL;
-    GList *item = NULL;
+    guint i;
     GHashTable *currency_hash;
     QofBook *book;
     QofBackend *be;
@@ -1575,24 +1772,23 @@ gnc_pricedb_lookup_at_time(GNCPriceDB *db,
         return NULL;
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!price_list)
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
     {
         LEAVE (" no price list");
         return NULL;
     }
 
-    item = price_list;
-    while (item)
+    /* Any prices at exactly t follow the last price later than t. */
+    for (i = price_series_find_at_or_before(series, t);
+            i < series->prices->len; i++)
     {
-        GNCPrice *p = item->data;
+        GNCPrice *p = price_series_index(series, i);
         Timespec price_time = gnc_price_get_time(p);
-        if (timespec_equal(&price_time, &t))
-        {
-            result = g_list_prepend(result, p);
-            gnc_price_ref(p);
-        }
-        item = item->next;
+        if (!timespec_equal(&price_time, &t))
+            break;
+        result = g_list_prepend(result, p);
+        gnc_price_ref(p);
     }
     LEAVE (" ");
     return result;
@@ -1605,11 +1801,11 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        Timespec t,
                        gboolean sameday)
 {
-    GList *price_list;
+    PriceSeries *series;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
+    guint i;
     GHashTable *currency_hash;
     QofBook *book;
     QofBackend *be;
@@ -1637,32 +1833,21 @@ lookup_nearest_in_time(GNCPriceDB *db,
         return NULL;
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!price_list)
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series || series->prices->len == 0)
     {
         LEAVE ("no price list");
         return NULL;
     }
 
-    item = price_list;
-
-    /* default answer */
-    current_price = item->data;
-
     /* find the first candidate past the one we want.  Remember that
        prices are in most-recent-first order. */
-    while (!next_price && item)
-    {
-        GNCPrice *p = item->data;
-        Timespec price_time = gnc_price_get_time(p);
-        if (timespec_cmp(&price_time, &t) <= 0)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
-    }
+    i = price_series_find_at_or_before(series, t);
+    if (i < series->prices->len)
+        next_price = price_series_index(series, i);
+
+    /* the candidate before it, or the first price if there is none */
+    current_price = price_series_index(series, i > 0 ? i - 1 : 0);
 
     if (current_price)      /* How can this be null??? */
     {
@@ -1753,15 +1938,12 @@ gnc_pricedb_lookup_latest_before (GNCPriceDB *db,
                                   gnc_commodity *currency,
                                   Timespec t)
 {
-    GList *price_list;
+    PriceSeries *series;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
+    guint i;
     GHashTable *currency_hash;
     QofBook *book;
     QofBackend *be;
-    Timespec price_time;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
@@ -1786,22 +1968,16 @@ gnc_pricedb_lookup_latest_before (GNCPriceDB *db,
         return NULL;
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!price_list)
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
     {
         LEAVE ("no price list");
         return NULL;
     }
 
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time (item->data);
-        if (timespec_cmp(&price_time, &t) <= 0)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (timespec_cmp(&price_time, &t) > 0 && item);
+    i = price_series_find_at_or_before(series, t);
+    if (i < series->prices->len)
+        current_price = price_series_index(series, i);
     gnc_price_ref(current_price);
     LEAVE (" ");
     return current_price;
@@ -1812,34 +1988,25 @@ static void
 lookup_nearest(gpointer key, gpointer val, gpointer user_data)
 {
     //gnc_commodity *currency = (gnc_commodity *)key;
-    GList *price_list = (GList *)val;
+    PriceSeries *series = (PriceSeries *)val;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
+    guint i;
     GNCPriceLookupHelper *lookup_helper = (GNCPriceLookupHelper *)user_data;
     GList **return_list = lookup_helper->return_list;
     Timespec t = lookup_helper->time;
 
-    item = price_list;
-
-    /* default answer */
-    current_price = item->data;
+    if (!series || series->prices->len == 0) return;
 
     /* find the first candidate past the one we want.  Remember that
        prices are in most-recent-first order. */
-    while (!next_price && item)
-    {
-        GNCPrice *p = item->data;
-        Timespec price_time = gnc_price_get_time(p);
-        if (timespec_cmp(&price_time, &t) <= 0)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
-    }
+    i = price_series_find_at_or_before(series, t);
+    if (i < series->prices->len)
+        next_price = price_series_index(series, i);
+
+    /* the candidate before it, or the first price if there is none */
+    current_price = price_series_index(series, i > 0 ? i - 1 : 0);
 
     if (current_price)
     {
@@ -1875,27 +2042,18 @@ static void
 lookup_latest_before(gpointer key, gpointer val, gpointer user_data)
 {
     //gnc_commodity *currency = (gnc_commodity *)key;
-    GList *price_list = (GList *)val;
+    PriceSeries *series = (PriceSeries *)val;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
     GNCPriceLookupHelper *lookup_helper = (GNCPriceLookupHelper *)user_data;
     GList **return_list = lookup_helper->return_list;
     Timespec t = lookup_helper->time;
-    Timespec price_time;
+    guint i;
 
-    if (price_list)
+    if (series)
     {
-        item = price_list;
-        do
-        {
-            price_time = gnc_price_get_time (item->data);
-            if (timespec_cmp(&price_time, &t) <= 0)
-                current_price = item->data;
-            item = item->next;
-        }
-        while (timespec_cmp(&price_time, &t) > 0 && item);
+        i = price_series_find_at_or_before(series, t);
+        if (i < series->prices->len)
+            current_price = price_series_index(series, i);
     }
 
     gnc_price_list_insert(return_list, current_price, FALSE);
@@ -2004,201 +2162,360 @@ gnc_pricedb_lookup_latest_before_any_currency(GNCPriceDB *db,
 }
 
 
-/*
- * Convert a balance from one currency to another.
+/* ==================================================================== */
+/* Balance conversion
+
+   A conversion uses the shortest chain of prices linking the two
+   commodities, each price usable in either direction.  At every step
+   the fresher price is tried first: the most recent one for "latest"
+   conversions, the one nearest the requested time otherwise.  The
+   chain is memoized per (from, to, day) until a price in the db is
+   added, removed or revalued; it is the one found at noon of the day,
+   but its prices are looked up at the exact time of each conversion.
+   The memo holds at most CONVERSION_CACHE_MAX chains and is emptied
+   when it is full.
  */
-gnc_numeric
-gnc_pricedb_convert_balance_latest_price(GNCPriceDB *pdb,
-        gnc_numeric balance,
-        const gnc_commodity *balance_currency,
-        const gnc_commodity *new_currency)
+
+#define CONVERSION_CACHE_MAX 4096
+
+typedef struct
 {
-    GNCPrice *price, *currency_price;
-    GList *price_list, *list_helper;
-    gnc_numeric currency_price_value;
-    gnc_commodity *intermediate_currency;
+    const gnc_commodity *from;
+    const gnc_commodity *to;
+    gboolean latest;
+    Timespec t;
+} PriceRateKey;
 
-    if (gnc_numeric_zero_p (balance) ||
-            gnc_commodity_equiv (balance_currency, new_currency))
-        return balance;
+typedef struct
+{
+    const gnc_commodity *commodity;
+    gnc_numeric rate;
+    Timespec price_time;
+} ConversionEdge;
 
-    /* Look for a direct price. */
-    price = gnc_pricedb_lookup_latest (pdb, balance_currency, new_currency);
-    if (price)
+static guint
+price_rate_key_hash (gconstpointer key)
+{
+    const PriceRateKey *k = key;
+    guint hash = g_direct_hash (k->from) * 31 + g_direct_hash (k->to);
+
+    return hash * 31 + (guint) (k->t.tv_sec ^ (k->t.tv_sec >> 32)) +
+           (k->latest ? 1 : 0);
+}
+
+static gboolean
+price_rate_key_equal (gconstpointer a, gconstpointer b)
+{
+    const PriceRateKey *ka = a;
+    const PriceRateKey *kb = b;
+
+    return ka->from == kb->from && ka->to == kb->to &&
+           ka->latest == kb->latest && timespec_equal (&ka->t, &kb->t);
+}
+
+static void
+pricedb_invalidate_conversions (GNCPriceDB *db)
+{
+    if (!db) return;
+    if (db->conversion_cache && g_hash_table_size (db->conversion_cache))
+        g_hash_table_remove_all (db->conversion_cache);
+    if (db->conversion_graph)
     {
-        balance = gnc_numeric_mul (balance, gnc_price_get_value (price),
-                                   gnc_commodity_get_fraction (new_currency),
-                                   GNC_HOW_RND_ROUND);
-        gnc_price_unref (price);
-        return balance;
+        g_hash_table_destroy (db->conversion_graph);
+        db->conversion_graph = NULL;
     }
+}
 
-    /* Look for a price of the new currency in the balance currency and use
-     * the reciprocal if we find it
-     */
-    price = gnc_pricedb_lookup_latest (pdb, new_currency, balance_currency);
-    if (price)
+static void
+add_conversion_edge (GHashTable *graph, gnc_commodity *a, gnc_commodity *b)
+{
+    GList *neighbours = g_hash_table_lookup (graph, a);
+
+    if (g_list_find (neighbours, b)) return;
+    /* Steal so that the old head isn't freed by the insert. */
+    g_hash_table_steal (graph, a);
+    g_hash_table_insert (graph, a, g_list_prepend (neighbours, b));
+}
+
+static void
+conversion_graph_add_currencies (gpointer key, gpointer val, gpointer user_data)
+{
+    GHashTable *currency_hash = val;
+    GHashTable *graph = user_data;
+    GList *currencies = g_hash_table_get_keys (currency_hash);
+    GList *node;
+
+    for (node = currencies; node; node = node->next)
     {
-        balance = gnc_numeric_div (balance, gnc_price_get_value (price),
-                                   gnc_commodity_get_fraction (new_currency),
-                                   GNC_HOW_RND_ROUND);
-        gnc_price_unref (price);
-        return balance;
+        add_conversion_edge (graph, key, node->data);
+        add_conversion_edge (graph, node->data, key);
     }
+    g_list_free (currencies);
+}
 
-    /*
-     * no direct price found, try if we find a price in another currency
-     * and convert in two stages
-     */
-    price_list = gnc_pricedb_lookup_latest_any_currency(pdb, balance_currency);
-    if (!price_list)
+/* Maps each commodity to the commodities it has a price with, in
+ * either direction. */
+static GHashTable *
+pricedb_get_conversion_graph (GNCPriceDB *db)
+{
+    if (!db->conversion_graph)
     {
-        balance =  gnc_numeric_zero ();
-        return balance;
+        db->conversion_graph =
+            g_hash_table_new_full (NULL, NULL, NULL,
+                                   (GDestroyNotify) g_list_free);
+        g_hash_table_foreach (db->commodity_hash,
+                              conversion_graph_add_currencies,
+                              db->conversion_graph);
     }
+    return db->conversion_graph;
+}
+
+static GNCPrice *
+conversion_lookup (GNCPriceDB *db, const gnc_commodity *c,
+                   const gnc_commodity *currency, const Timespec *t)
+{
+    if (t)
+        return gnc_pricedb_lookup_nearest_in_time (db, c, currency, *t);
+    return gnc_pricedb_lookup_latest (db, c, currency);
+}
 
-    list_helper = price_list;
-    currency_price_value = gnc_numeric_zero();
+/* Fills in the rate converting an amount of from into edge->commodity
+ * using a single price, preferring a price of from in the other
+ * commodity over the reciprocal of one the other way round.  Returns
+ * FALSE if there is no usable price. */
+static gboolean
+conversion_edge_init (ConversionEdge *edge, GNCPriceDB *db,
+                      const gnc_commodity *from, const gnc_commodity *to,
+                      const Timespec *t)
+{
+    GNCPrice *price;
 
-    do
+    edge->commodity = to;
+    edge->rate = gnc_numeric_zero ();
+
+    price = conversion_lookup (db, from, to, t);
+    if (price)
+    {
+        edge->rate = gnc_price_get_value (price);
+    }
+    else
     {
-        price = (GNCPrice *)(list_helper->data);
+        price = conversion_lookup (db, to, from, t);
+        if (!price) return FALSE;
+        if (!gnc_numeric_zero_p (gnc_price_get_value (price)))
+            edge->rate = gnc_numeric_div (gnc_numeric_create (1, 1),
+                                          gnc_price_get_value (price),
+                                          GNC_DENOM_AUTO,
+                                          GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
+    }
+    edge->price_time = gnc_price_get_time (price);
+    gnc_price_unref (price);
+
+    return !gnc_numeric_zero_p (edge->rate) && !gnc_numeric_check (edge->rate);
+}
 
-        intermediate_currency = gnc_price_get_currency(price);
-        currency_price = gnc_pricedb_lookup_latest(pdb, intermediate_currency,
-                         new_currency);
-        if (currency_price)
+static gint
+compare_conversion_edges (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const ConversionEdge *ea = a;
+    const ConversionEdge *eb = b;
+    const Timespec *t = user_data;
+    Timespec da, db;
+
+    if (!t)
+        return -timespec_cmp (&ea->price_time, &eb->price_time);
+
+    da = timespec_diff (&ea->price_time, t);
+    db = timespec_diff (&eb->price_time, t);
+    da = timespec_abs (&da);
+    db = timespec_abs (&db);
+    return timespec_cmp (&da, &db);
+}
+
+/* Breadth-first search of the conversion graph.  Returns the
+ * commodities of the chain from from to to, both included, or NULL if
+ * they aren't connected. */
+static GList *
+pricedb_find_conversion_path (GNCPriceDB *db, const gnc_commodity *from,
+                              const gnc_commodity *to, const Timespec *t)
+{
+    GHashTable *graph = pricedb_get_conversion_graph (db);
+    GHashTable *rates = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    GHashTable *parents = g_hash_table_new (NULL, NULL);
+    GQueue *queue = g_queue_new ();
+    GList *path = NULL;
+    gboolean found = FALSE;
+    gnc_numeric *rate = g_new (gnc_numeric, 1);
+
+    *rate = gnc_numeric_create (1, 1);
+    g_hash_table_insert (rates, (gpointer) from, rate);
+    g_queue_push_tail (queue, (gpointer) from);
+
+    while (!g_queue_is_empty (queue) && !found)
+    {
+        const gnc_commodity *c = g_queue_pop_head (queue);
+        gnc_numeric c_rate = *(gnc_numeric *) g_hash_table_lookup (rates, c);
+        GList *neighbours = g_list_copy (g_hash_table_lookup (graph, c));
+        GList *edges = NULL;
+        GList *node;
+
+        for (node = neighbours; node; node = node->next)
         {
-            currency_price_value = gnc_price_get_value(currency_price);
-            gnc_price_unref(currency_price);
+            ConversionEdge *edge;
+
+            if (g_hash_table_lookup (rates, node->data)) continue;
+            edge = g_new (ConversionEdge, 1);
+            if (conversion_edge_init (edge, db, c, node->data, t))
+                edges = g_list_prepend (edges, edge);
+            else
+                g_free (edge);
         }
-        else
+        g_list_free (neighbours);
+        edges = g_list_sort_with_data (edges, compare_conversion_edges,
+                                       (gpointer) t);
+
+        for (node = edges; node; node = node->next)
         {
-            currency_price = gnc_pricedb_lookup_latest(pdb, new_currency,
-                             intermediate_currency);
-            if (currency_price)
+            ConversionEdge *edge = node->data;
+            gnc_numeric edge_rate = gnc_numeric_mul (c_rate, edge->rate,
+                                    GNC_DENOM_AUTO,
+                                    GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
+
+            if (gnc_numeric_check (edge_rate)) continue;
+            g_hash_table_insert (parents, (gpointer) edge->commodity,
+                                 (gpointer) c);
+            if (edge->commodity == to)
             {
-                /* here we need the reciprocal */
-                currency_price_value = gnc_numeric_div(gnc_numeric_create(1, 1),
-                                                       gnc_price_get_value(currency_price),
-                                                       GNC_DENOM_AUTO,
-                                                       GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
-                gnc_price_unref(currency_price);
+                found = TRUE;
+                break;
             }
+            rate = g_new (gnc_numeric, 1);
+            *rate = edge_rate;
+            g_hash_table_insert (rates, (gpointer) edge->commodity, rate);
+            g_queue_push_tail (queue, (gpointer) edge->commodity);
         }
-
-        list_helper = list_helper->next;
+        g_list_free_full (edges, g_free);
     }
-    while ((list_helper != NULL) &&
-            (gnc_numeric_zero_p(currency_price_value)));
 
-    balance = gnc_numeric_mul (balance, currency_price_value,
-                               GNC_DENOM_AUTO,
-                               GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
-    balance = gnc_numeric_mul (balance, gnc_price_get_value (price),
-                               gnc_commodity_get_fraction (new_currency),
-                               GNC_HOW_RND_ROUND);
+    if (found)
+    {
+        const gnc_commodity *c;
+
+        for (c = to; c != from; c = g_hash_table_lookup (parents, c))
+            path = g_list_prepend (path, (gpointer) c);
+        path = g_list_prepend (path, (gpointer) from);
+    }
 
-    gnc_price_list_destroy(price_list);
-    return balance;
+    g_queue_free (queue);
+    g_hash_table_destroy (parents);
+    g_hash_table_destroy (rates);
+    return path;
 }
 
-gnc_numeric
-gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
-        gnc_numeric balance,
-        const gnc_commodity *balance_currency,
-        const gnc_commodity *new_currency,
-        Timespec t)
+/* The rate converting the first commodity of path into the last one,
+ * with the prices nearest to t, or the latest ones if t is NULL.
+ * Returns zero if a price is missing or the rate overflows. */
+static gnc_numeric
+conversion_path_rate (GNCPriceDB *db, GList *path, const Timespec *t)
 {
-    GNCPrice *price, *currency_price;
-    GList *price_list, *list_helper;
-    gnc_numeric currency_price_value;
-    gnc_commodity *intermediate_currency;
-
-    if (gnc_numeric_zero_p (balance) ||
-            gnc_commodity_equiv (balance_currency, new_currency))
-        return balance;
+    gnc_numeric rate = gnc_numeric_create (1, 1);
+    GList *node;
 
-    /* Look for a direct price. */
-    price = gnc_pricedb_lookup_nearest_in_time (pdb, balance_currency, new_currency, t);
-    if (price)
+    for (node = path; node && node->next; node = node->next)
     {
-        balance = gnc_numeric_mul (balance, gnc_price_get_value (price),
-                                   gnc_commodity_get_fraction (new_currency),
-                                   GNC_HOW_RND_ROUND);
-        gnc_price_unref (price);
-        return balance;
-    }
+        ConversionEdge edge;
 
-    /* Look for a price of the new currency in the balance currency and use
-     * the reciprocal if we find it
-     */
-    price = gnc_pricedb_lookup_nearest_in_time (pdb, new_currency, balance_currency, t);
-    if (price)
-    {
-        balance = gnc_numeric_div (balance, gnc_price_get_value (price),
-                                   gnc_commodity_get_fraction (new_currency),
-                                   GNC_HOW_RND_ROUND);
-        gnc_price_unref (price);
-        return balance;
+        if (!conversion_edge_init (&edge, db, node->data, node->next->data, t))
+            return gnc_numeric_zero ();
+        rate = gnc_numeric_mul (rate, edge.rate, GNC_DENOM_AUTO,
+                                GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
+        if (gnc_numeric_check (rate))
+            return gnc_numeric_zero ();
     }
+    return rate;
+}
 
-    /*
-     * no direct price found, try if we find a price in another currency
-     * and convert in two stages
-     */
-    price_list = gnc_pricedb_lookup_nearest_in_time_any_currency(pdb, balance_currency, t);
-    if (!price_list)
-    {
-        balance =  gnc_numeric_zero ();
-        return balance;
-    }
+/* Returns the rate converting from into to at t, or at the latest
+ * prices if t is NULL, or zero if there is none.  The chain of
+ * commodities is memoized per day, the prices are not. */
+static gnc_numeric
+pricedb_get_conversion_rate (GNCPriceDB *db, const gnc_commodity *from,
+                             const gnc_commodity *to, const Timespec *t)
+{
+    PriceRateKey key;
+    PriceRateKey *new_key;
+    GList *path;
+    Timespec noon;
 
-    list_helper = price_list;
-    currency_price_value = gnc_numeric_zero();
+    key.from = from;
+    key.to = to;
+    key.latest = (t == NULL);
+    key.t.tv_sec = t ? gnc_time64_get_day_start (t->tv_sec) : 0;
+    key.t.tv_nsec = 0;
 
-    do
+    if (!g_hash_table_lookup_extended (db->conversion_cache, &key, NULL,
+                                       (gpointer *) &path))
     {
-        price = (GNCPrice *)(list_helper->data);
+        if (g_hash_table_size (db->conversion_cache) >= CONVERSION_CACHE_MAX)
+            g_hash_table_remove_all (db->conversion_cache);
 
-        intermediate_currency = gnc_price_get_currency(price);
-        currency_price = gnc_pricedb_lookup_nearest_in_time(pdb, intermediate_currency,
-                         new_currency, t);
-        if (currency_price)
-        {
-            currency_price_value = gnc_price_get_value(currency_price);
-            gnc_price_unref(currency_price);
-        }
-        else
-        {
-            currency_price = gnc_pricedb_lookup_nearest_in_time(pdb, new_currency,
-                             intermediate_currency, t);
-            if (currency_price)
-            {
-                /* here we need the reciprocal */
-                currency_price_value = gnc_numeric_div(gnc_numeric_create(1, 1),
-                                                       gnc_price_get_value(currency_price),
-                                                       GNC_DENOM_AUTO,
-                                                       GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
-                gnc_price_unref(currency_price);
-            }
-        }
-
-        list_helper = list_helper->next;
+        noon.tv_sec = key.t.tv_sec + 12 * 3600;
+        noon.tv_nsec = 0;
+        path = pricedb_find_conversion_path (db, from, to, t ? &noon : NULL);
+        new_key = g_new (PriceRateKey, 1);
+        *new_key = key;
+        g_hash_table_insert (db->conversion_cache, new_key, path);
     }
-    while ((list_helper != NULL) &&
-            (gnc_numeric_zero_p(currency_price_value)));
+    if (!path)
+        return gnc_numeric_zero ();
+    return conversion_path_rate (db, path, t);
+}
+
+static gnc_numeric
+convert_balance (GNCPriceDB *pdb, gnc_numeric balance,
+                 const gnc_commodity *balance_currency,
+                 const gnc_commodity *new_currency, const Timespec *t)
+{
+    gnc_numeric rate;
 
-    balance = gnc_numeric_mul (balance, currency_price_value,
-                               GNC_DENOM_AUTO,
-                               GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
+    if (gnc_numeric_zero_p (balance) ||
+            gnc_commodity_equiv (balance_currency, new_currency))
+        return balance;
+    if (!pdb || !balance_currency || !new_currency)
+        return gnc_numeric_zero ();
 
-    balance = gnc_numeric_mul (balance, gnc_price_get_value (price),
-                               gnc_commodity_get_fraction (new_currency),
-                               GNC_HOW_RND_ROUND);
+    rate = pricedb_get_conversion_rate (pdb, balance_currency,
+                                        new_currency, t);
+    if (gnc_numeric_zero_p (rate))
+        return gnc_numeric_zero ();
 
-    gnc_price_list_destroy(price_list);
-    return balance;
+    return gnc_numeric_mul (balance, rate,
+                            gnc_commodity_get_fraction (new_currency),
+                            GNC_HOW_RND_ROUND);
+}
+
+/*
+ * Convert a balance from one currency to another.
+ */
+gnc_numeric
+gnc_pricedb_convert_balance_latest_price(GNCPriceDB *pdb,
+        gnc_numeric balance,
+        const gnc_commodity *balance_currency,
+        const gnc_commodity *new_currency)
+{
+    return convert_balance (pdb, balance, balance_currency, new_currency,
+                            NULL);
+}
+
+gnc_numeric
+gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
+        gnc_numeric balance,
+        const gnc_commodity *balance_currency,
+        const gnc_commodity *new_currency,
+        Timespec t)
+{
+    return convert_balance (pdb, balance, balance_currency, new_currency,
+                            &t);
 }
 
 
@@ -2216,16 +2533,17 @@ typedef struct
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    PriceSeries *series = (PriceSeries *) val;
     GNCPriceDBForeachData *foreach_data = (GNCPriceDBForeachData *) user_data;
+    guint i;
+
+    price_series_sort (series);
 
     /* stop traversal when func returns FALSE */
-    while (foreach_data->ok && node)
+    for (i = 0; foreach_data->ok && i < series->prices->len; i++)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
+        GNCPrice *p = price_series_index (series, i);
         foreach_data->ok = foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
     }
 }
 
@@ -2310,12 +2628,13 @@ stable_price_traversal(GNCPriceDB *db,
         for (j = price_lists; j; j = j->next)
         {
             GHashTableKVPair *pricelist_kvp = (GHashTableKVPair *) j->data;
-            GList *price_list = (GList *) pricelist_kvp->value;
-            GList *node;
+            PriceSeries *series = (PriceSeries *) pricelist_kvp->value;
+            guint k;
 
-            for (node = (GList *) price_list; node; node = node->next)
+            price_series_sort (series);
+            for (k = 0; k < series->prices->len; k++)
             {
-                GNCPrice *price = (GNCPrice *) node->data;
+                GNCPrice *price = price_series_index (series, k);
 
                 /* stop traversal when f returns FALSE */
                 if (FALSE == ok) break;
@@ -2535,16 +2854,13 @@ VoidGNCPriceDBForeachData;
 static void
 void_pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    PriceSeries *series = (PriceSeries *) val;
     VoidGNCPriceDBForeachData *foreach_data = (VoidGNCPriceDBForeachData *) user_data;
+    guint i;
 
-    while (node)
-    {
-        GNCPrice *p = (GNCPrice *) node->data;
-        foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
-    }
+    price_series_sort (series);
+    for (i = 0; i < series->prices->len; i++)
+        foreach_data->func(price_series_index (series, i), foreach_data->user_data);
 }
 
 static void
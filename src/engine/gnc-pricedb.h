@@ -392,7 +392,7 @@ gnc_pricedb_convert_balance_latest_price(GNCPriceDB *pdb,
         const gnc_commodity *new_currency);
 
 /** gnc_pricedb_convert_balance_nearest_price - Convert a balance
-    from one currency to another. */
+    from one currency to another, using the prices nearest in time to t. */
 gnc_numeric
 gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
         gnc_numeric balance,
@@ -200,6 +200,24 @@ impl_refers_to_object(const QofInstance* inst, const QofInstance* ref)
     return FALSE;
 }
 
+/** Returns the objects this object refers to, the ones for which
+    impl_refers_to_object returns TRUE. */
+static GList*
+impl_get_references(const QofInstance* inst)
+{
+    GncCustomer* cust;
+    GList* refs = NULL;
+
+    g_return_val_if_fail(inst != NULL, NULL);
+    g_return_val_if_fail(GNC_IS_CUSTOMER(inst), NULL);
+
+    cust = GNC_CUSTOMER(inst);
+    refs = g_list_prepend(refs, cust->terms);
+    refs = g_list_prepend(refs, cust->taxtable);
+
+    return refs;
+}
+
 /** Returns a list of my type of object which refers to an object.  For example, when called as
         qof_instance_get_typed_referring_object_list(taxtable, account);
     it will return the list of taxtables which refer to a specific account.  The result should be the
@@ -230,6 +248,7 @@ gnc_customer_class_init (GncCustomerClass *klass)
 
     qof_class->get_display_name = impl_get_display_name;
     qof_class->refers_to_object = impl_refers_to_object;
+    qof_class->get_references = impl_get_references;
     qof_class->get_typed_referring_object_list = impl_get_typed_referring_object_list;
 
     g_object_class_install_property
@@ -268,7 +287,10 @@ GncCustomer *gncCustomerCreate (QofBook *book)
 
     if (gs_address_event_handler_id == 0)
     {
-        gs_address_event_handler_id = qof_event_register_handler(listen_for_address_events, NULL);
+        static const QofIdTypeConst address_types[] = { GNC_ID_ADDRESS, NULL };
+        gs_address_event_handler_id =
+            qof_event_register_filtered_handler(listen_for_address_events, NULL,
+                                                QOF_EVENT_MODIFY, address_types);
     }
 
     qof_event_gen (&cust->inst, QOF_EVENT_CREATE, NULL);
@@ -238,6 +238,24 @@ impl_refers_to_object(const QofInstance* inst, const QofInstance* ref)
     return FALSE;
 }
 
+/** Returns the objects this object refers to, the ones for which
+    impl_refers_to_object returns TRUE. */
+static GList*
+impl_get_references(const QofInstance* inst)
+{
+    GncEmployee* emp;
+    GList* refs = NULL;
+
+    g_return_val_if_fail(inst != NULL, NULL);
+    g_return_val_if_fail(GNC_IS_EMPLOYEE(inst), NULL);
+
+    emp = GNC_EMPLOYEE(inst);
+    refs = g_list_prepend(refs, emp->currency);
+    refs = g_list_prepend(refs, emp->ccard_acc);
+
+    return refs;
+}
+
 /** Returns a list of my type of object which refers to an object.  For example, when called as
         qof_instance_get_typed_referring_object_list(taxtable, account);
     it will return the list of taxtables which refer to a specific account.  The result should be the
@@ -268,6 +286,7 @@ gnc_employee_class_init (GncEmployeeClass *klass)
 
     qof_class->get_display_name = NULL;
     qof_class->refers_to_object = impl_refers_to_object;
+    qof_class->get_references = impl_get_references;
     qof_class->get_typed_referring_object_list = impl_get_typed_referring_object_list;
 
     g_object_class_install_property
@@ -390,7 +409,10 @@ GncEmployee *gncEmployeeCreate (QofBook *book)
 
     if (gs_address_event_handler_id == 0)
     {
-        gs_address_event_handler_id = qof_event_register_handler(listen_for_address_events, NULL);
+        static const QofIdTypeConst address_types[] = { GNC_ID_ADDRESS, NULL };
+        gs_address_event_handler_id =
+            qof_event_register_filtered_handler(listen_for_address_events, NULL,
+                                                QOF_EVENT_MODIFY, address_types);
     }
 
     qof_event_gen (&employee->inst, QOF_EVENT_CREATE, NULL);
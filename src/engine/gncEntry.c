@@ -339,6 +339,26 @@ impl_refers_to_object(const QofInstance* inst, const QofInstance* ref)
     return FALSE;
 }
 
+/** Returns the objects this object refers to, the ones for which
+    impl_refers_to_object returns TRUE. */
+static GList*
+impl_get_references(const QofInstance* inst)
+{
+    GncEntry* entry;
+    GList* refs = NULL;
+
+    g_return_val_if_fail(inst != NULL, NULL);
+    g_return_val_if_fail(GNC_IS_ENTRY(inst), NULL);
+
+    entry = GNC_ENTRY(inst);
+    refs = g_list_prepend(refs, entry->i_account);
+    refs = g_list_prepend(refs, entry->b_account);
+    refs = g_list_prepend(refs, entry->i_tax_table);
+    refs = g_list_prepend(refs, entry->b_tax_table);
+
+    return refs;
+}
+
 /** Returns a list of my type of object which refers to an object.  For example, when called as
         qof_instance_get_typed_referring_object_list(taxtable, account);
     it will return the list of taxtables which refer to a specific account.  The result should be the
@@ -369,6 +389,7 @@ gnc_entry_class_init (GncEntryClass *klass)
 
     qof_class->get_display_name = impl_get_display_name;
     qof_class->refers_to_object = impl_refers_to_object;
+    qof_class->get_references = impl_get_references;
     qof_class->get_typed_referring_object_list = impl_get_typed_referring_object_list;
 
     g_object_class_install_property
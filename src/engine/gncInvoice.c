@@ -248,6 +248,28 @@ impl_refers_to_object(const QofInstance* inst, const QofInstance* ref)
     return FALSE;
 }
 
+/** Returns the objects this object refers to, the ones for which
+    impl_refers_to_object returns TRUE. */
+static GList*
+impl_get_references(const QofInstance* inst)
+{
+    GncInvoice* inv;
+    GList* refs = NULL;
+
+    g_return_val_if_fail(inst != NULL, NULL);
+    g_return_val_if_fail(GNC_IS_INVOICE(inst), NULL);
+
+    inv = GNC_INVOICE(inst);
+    refs = g_list_prepend(refs, inv->terms);
+    refs = g_list_prepend(refs, inv->job);
+    refs = g_list_prepend(refs, inv->currency);
+    refs = g_list_prepend(refs, inv->posted_acc);
+    refs = g_list_prepend(refs, inv->posted_txn);
+    refs = g_list_prepend(refs, inv->posted_lot);
+
+    return refs;
+}
+
 /** Returns a list of my type of object which refers to an object.  For example, when called as
         qof_instance_get_typed_referring_object_list(taxtable, account);
     it will return the list of taxtables which refer to a specific account.  The result should be the
@@ -279,6 +301,7 @@ gnc_invoice_class_init (GncInvoiceClass *klass)
 
     qof_class->get_display_name = impl_get_display_name;
     qof_class->refers_to_object = impl_refers_to_object;
+    qof_class->get_references = impl_get_references;
     qof_class->get_typed_referring_object_list = impl_get_typed_referring_object_list;
 
     g_object_class_install_property
@@ -1128,6 +1151,7 @@ qofInvoiceSetJob (GncInvoice *invoice, GncJob *job)
         return;
     }
     invoice->job = job;
+    qof_instance_references_changed (QOF_INSTANCE (invoice));
 }
 
 static void
@@ -1194,7 +1218,7 @@ gncInvoiceAttachToTxn (GncInvoice *invoice, Transaction *txn)
     if (invoice->posted_txn) return;	/* Cannot reset invoice's txn */
 
     xaccTransBeginEdit (txn);
-    kvp = xaccTransGetSlots (txn);
+    kvp = xaccTransGetSlotsForEdit (txn);
     value = kvp_value_new_guid (qof_instance_get_guid(QOF_INSTANCE(invoice)));
     kvp_frame_set_slot_path (kvp, value, GNC_INVOICE_ID, GNC_INVOICE_GUID, NULL);
     kvp_value_delete (value);
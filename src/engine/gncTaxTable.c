@@ -333,6 +333,29 @@ impl_refers_to_object(const QofInstance* inst, const QofInstance* ref)
     return FALSE;
 }
 
+/** Returns the objects this object refers to, the ones for which
+    impl_refers_to_object returns TRUE. */
+static GList*
+impl_get_references(const QofInstance* inst)
+{
+    GncTaxTable* tt;
+    GList* node;
+    GList* refs = NULL;
+
+    g_return_val_if_fail(inst != NULL, NULL);
+    g_return_val_if_fail(GNC_IS_TAXTABLE(inst), NULL);
+
+    tt = GNC_TAXTABLE(inst);
+    for (node = tt->entries; node != NULL; node = node->next)
+    {
+        GncTaxTableEntry* tte = node->data;
+
+        refs = g_list_prepend(refs, tte->account);
+    }
+
+    return refs;
+}
+
 /** Returns a list of my type of object which refers to an object.  For example, when called as
         qof_instance_get_typed_referring_object_list(taxtable, account);
     it will return the list of taxtables which refer to a specific account.  The result should be the
@@ -363,6 +386,7 @@ gnc_taxtable_class_init (GncTaxTableClass *klass)
 
     qof_class->get_display_name = impl_get_display_name;
     qof_class->refers_to_object = impl_refers_to_object;
+    qof_class->get_references = impl_get_references;
     qof_class->get_typed_referring_object_list = impl_get_typed_referring_object_list;
 
     g_object_class_install_property
@@ -563,6 +587,7 @@ void gncTaxTableEntrySetAccount (GncTaxTableEntry *entry, Account *account)
     {
         mark_table (entry->table);
         mod_table (entry->table);
+        qof_instance_references_changed (QOF_INSTANCE (entry->table));
     }
 }
 
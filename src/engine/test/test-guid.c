@@ -28,13 +28,24 @@
 
 #include "config.h"
 #include <ctype.h>
+#include <stdio.h>
 #include <glib.h>
 #include "cashobjects.h"
 #include "test-stuff.h"
 #include "test-engine-stuff.h"
 #include "qof.h"
+#include "qofid-p.h"
 
+/* The timings of guid generation and of the collection table are only
+ * run, at full size, with GNC_TEST_PERF set in the environment. */
 #define NENT 50123
+#define NGUIDS 1000000
+#define NTHREADS 4
+#define NTHREAD_GUIDS 20000
+#define NCOLL_ENT 10000
+#define NCOLL_ENT_PERF 1000000
+
+static gboolean perf = FALSE;
 
 static void test_null_guid(void)
 {
@@ -49,6 +60,134 @@ static void test_null_guid(void)
     do_test(!guid_equal(&g, gp), "two guids equal");
 }
 
+static void test_guid_speed(void)
+{
+    GTimer *timer;
+    GncGUID guid;
+    int i;
+
+    timer = g_timer_new ();
+    for (i = 0; i < NGUIDS; i++)
+        guid_new_md5 (&guid);
+    g_timer_stop (timer);
+    printf ("Created %d md5 guids in %.3fs\n", NGUIDS,
+            g_timer_elapsed (timer, NULL));
+
+    g_timer_start (timer);
+    for (i = 0; i < NGUIDS; i++)
+        guid_new (&guid);
+    g_timer_stop (timer);
+    printf ("Created %d guids in %.3fs\n", NGUIDS,
+            g_timer_elapsed (timer, NULL));
+    g_timer_destroy (timer);
+}
+
+static gpointer
+make_guids (gpointer data)
+{
+    GncGUID *guids = data;
+    int i;
+
+    for (i = 0; i < NTHREAD_GUIDS; i++)
+        guid_new (&guids[i]);
+    return NULL;
+}
+
+static void test_guid_threads(void)
+{
+    GncGUID *guids = g_new (GncGUID, NTHREADS * NTHREAD_GUIDS);
+    GThread *threads[NTHREADS];
+    GHashTable *seen = guid_hash_table_new ();
+    int i, dups = 0;
+
+    for (i = 0; i < NTHREADS; i++)
+    {
+#ifndef HAVE_GLIB_2_32
+        threads[i] = g_thread_create (make_guids, guids + i * NTHREAD_GUIDS,
+                                      TRUE, NULL);
+#else
+        threads[i] = g_thread_new ("guid", make_guids,
+                                   guids + i * NTHREAD_GUIDS);
+#endif
+    }
+    for (i = 0; i < NTHREADS; i++)
+        g_thread_join (threads[i]);
+
+    for (i = 0; i < NTHREADS * NTHREAD_GUIDS; i++)
+    {
+        if (g_hash_table_lookup (seen, &guids[i]))
+            dups++;
+        g_hash_table_insert (seen, &guids[i], &guids[i]);
+    }
+    do_test (dups == 0, "duplicate guids across threads");
+
+    g_hash_table_destroy (seen);
+    g_free (guids);
+}
+
+static void test_collection_speed(void)
+{
+    int nent = perf ? NCOLL_ENT_PERF : NCOLL_ENT;
+    QofBook *book = qof_book_new ();
+    QofCollection *col;
+    QofInstance **ents = g_new (QofInstance *, nent);
+    GTimer *timer;
+    int i, found = 0;
+
+    col = qof_book_get_collection (book, "asdf");
+    qof_collection_reserve (col, nent);
+
+    timer = g_timer_new ();
+    for (i = 0; i < nent; i++)
+    {
+        ents[i] = g_object_new (QOF_TYPE_INSTANCE, NULL);
+        qof_instance_init_data (ents[i], "asdf", book);
+    }
+    g_timer_stop (timer);
+    if (perf)
+        printf ("Inserted %d entities in %.3fs\n", nent,
+                g_timer_elapsed (timer, NULL));
+    do_test (qof_collection_count (col) == nent, "collection count");
+
+    g_timer_start (timer);
+    for (i = 0; i < nent; i++)
+    {
+        if (qof_collection_lookup_entity (col, qof_instance_get_guid (ents[i]))
+                == ents[i])
+            found++;
+    }
+    g_timer_stop (timer);
+    if (perf)
+        printf ("Looked up %d entities in %.3fs\n", nent,
+                g_timer_elapsed (timer, NULL));
+    do_test (found == nent, "lookup of all entities");
+
+    g_timer_start (timer);
+    for (i = 0; i < nent; i += 2)
+        g_object_unref (ents[i]);
+    g_timer_stop (timer);
+    if (perf)
+        printf ("Removed %d entities in %.3fs\n", nent / 2,
+                g_timer_elapsed (timer, NULL));
+    do_test (qof_collection_count (col) == nent / 2,
+             "collection count after removal");
+
+    found = 0;
+    for (i = 1; i < nent; i += 2)
+    {
+        if (qof_collection_lookup_entity (col, qof_instance_get_guid (ents[i]))
+                == ents[i])
+            found++;
+        g_object_unref (ents[i]);
+    }
+    do_test (found == nent / 2, "lookup after removal");
+    do_test (qof_collection_count (col) == 0, "collection emptied");
+
+    g_timer_destroy (timer);
+    g_free (ents);
+    qof_book_destroy (book);
+}
+
 static void
 run_test (void)
 {
@@ -87,10 +226,18 @@ run_test (void)
 int
 main (int argc, char **argv)
 {
+#ifndef HAVE_GLIB_2_32
+    g_thread_init (NULL);
+#endif
     qof_init();
+    perf = (g_getenv ("GNC_TEST_PERF") != NULL);
     if (cashobjects_register())
     {
         test_null_guid();
+        if (perf)
+            test_guid_speed();
+        test_guid_threads();
+        test_collection_speed();
         run_test ();
         print_test_results();
     }
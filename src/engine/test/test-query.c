@@ -65,6 +65,287 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+static void
+apply_deltas (GList **list, GList *deltas)
+{
+    GList *node;
+
+    for (node = deltas; node; node = node->next)
+    {
+        QofQueryDelta *delta = node->data;
+
+        if (delta->type != QOF_QUERY_DELTA_INSERT)
+            *list = g_list_remove (*list, delta->object);
+        if (delta->type != QOF_QUERY_DELTA_REMOVE)
+            *list = g_list_insert (*list, delta->object, delta->new_index);
+    }
+}
+
+static gboolean
+same_lists (GList *l1, GList *l2)
+{
+    for (; l1 && l2; l1 = l1->next, l2 = l2->next)
+        if (l1->data != l2->data)
+            return FALSE;
+    return !l1 && !l2;
+}
+
+static void
+test_live_query (QofBook *book)
+{
+    QofQuery *q, *fresh;
+    GList *ran, *shown, *deltas;
+    Transaction *trans, *last_trans;
+    Split *first, *split;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    qof_query_set_live (q, TRUE);
+    qof_query_add_live_dependency (q, GNC_ID_TRANS,
+                                   (QofQueryLiveDependencyFunc)
+                                   xaccTransGetSplitList);
+    ran = qof_query_run (q);
+    shown = g_list_copy (ran);
+    if (!shown)
+    {
+        qof_query_destroy (q);
+        return;
+    }
+
+    /* Move the first transaction to the end and give it another
+     * split, and delete the last one */
+    first = g_list_first (shown)->data;
+    trans = xaccSplitGetParent (first);
+    last_trans = xaccSplitGetParent (g_list_last (shown)->data);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDatePostedSecs (trans, xaccTransGetDate (last_trans) + 86400);
+    split = xaccMallocSplit (book);
+    xaccSplitSetAccount (split, xaccSplitGetAccount (first));
+    xaccSplitSetParent (split, trans);
+    xaccTransCommitEdit (trans);
+
+    if (last_trans != trans)
+    {
+        xaccTransBeginEdit (last_trans);
+        xaccTransDestroy (last_trans);
+        xaccTransCommitEdit (last_trans);
+    }
+
+    /* The list handed out by the run is left as it was */
+    if (qof_query_last_run (q) == ran && same_lists (ran, shown))
+    {
+        success ("live query leaves the run's results alone");
+    }
+    else
+    {
+        failure ("live query changed the run's results");
+    }
+
+    if (!qof_query_take_live_changes (q, &deltas))
+    {
+        failure ("live query could not be kept up to date");
+        g_list_free (shown);
+        qof_query_destroy (q);
+        return;
+    }
+    apply_deltas (&shown, deltas);
+    qof_query_free_deltas (deltas);
+
+    fresh = qof_query_copy (q);
+    if (same_lists (shown, qof_query_last_run (q)) &&
+            same_lists (shown, qof_query_run (fresh)))
+    {
+        success ("live query results are up to date");
+    }
+    else
+    {
+        failure ("live query results differ from a new run");
+    }
+
+    qof_query_destroy (fresh);
+    qof_query_destroy (q);
+    g_list_free (shown);
+}
+
+typedef struct
+{
+    Account *account;
+    time64 start;
+    time64 end;
+    GList *splits;
+} split_filter;
+
+static void
+collect_matching_split (QofInstance *inst, gpointer data)
+{
+    split_filter *filter = data;
+    Split *split = (Split *) inst;
+    time64 posted;
+
+    if (xaccSplitGetAccount (split) != filter->account)
+        return;
+    posted = xaccTransGetDate (xaccSplitGetParent (split));
+    if (posted >= filter->start && posted <= filter->end)
+        filter->splits = g_list_prepend (filter->splits, split);
+}
+
+/* Whether the query gives the splits of the account posted in the range,
+ * as found by walking all of the splits of the book. */
+static gboolean
+account_query_is_complete (QofBook *book, QofQuery *q, split_filter *filter)
+{
+    GList *found = qof_query_run (q);
+    GList *node;
+    gboolean ok;
+
+    filter->splits = NULL;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            collect_matching_split, filter);
+    ok = (g_list_length (found) == g_list_length (filter->splits));
+    for (node = found; ok && node; node = node->next)
+        ok = (g_list_find (filter->splits, node->data) != NULL);
+    g_list_free (filter->splits);
+    return ok;
+}
+
+/* Split queries on an account and a date range are answered from the
+ * account's split list.  They must find the same splits as a walk of
+ * the whole book, including the splits of a transaction which is still
+ * open, and which therefore aren't in the account's list yet. */
+static void
+test_account_access_path (QofBook *book)
+{
+    QofQuery *q;
+    split_filter filter;
+    Transaction *trans, *open_trans;
+    Split *split;
+    GList *splits;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    splits = qof_query_run (q);
+    if (!splits || !xaccSplitGetAccount (splits->data))
+    {
+        qof_query_destroy (q);
+        return;
+    }
+    trans = xaccSplitGetParent (splits->data);
+    filter.account = xaccSplitGetAccount (splits->data);
+    filter.start = xaccTransGetDate (trans) - 30 * 86400;
+    filter.end = xaccTransGetDate (trans) + 30 * 86400;
+    qof_query_destroy (q);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, filter.account, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (q, TRUE, filter.start, TRUE, filter.end,
+                             QOF_QUERY_AND);
+    if (account_query_is_complete (book, q, &filter))
+    {
+        success ("account query matches a walk of the book");
+    }
+    else
+    {
+        failure ("account query differs from a walk of the book");
+    }
+
+    /* A split added to the account by a transaction still being edited */
+    open_trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (open_trans);
+    xaccTransSetCurrency (open_trans, xaccTransGetCurrency (trans));
+    xaccTransSetDatePostedSecs (open_trans, xaccTransGetDate (trans));
+    split = xaccMallocSplit (book);
+    xaccSplitSetAccount (split, filter.account);
+    xaccSplitSetParent (split, open_trans);
+    if (account_query_is_complete (book, q, &filter) &&
+            g_list_find (qof_query_last_run (q), split))
+    {
+        success ("account query finds the splits of open transactions");
+    }
+    else
+    {
+        failure ("account query misses the splits of open transactions");
+    }
+
+    xaccTransDestroy (open_trans);
+    xaccTransCommitEdit (open_trans);
+    if (account_query_is_complete (book, q, &filter))
+    {
+        success ("account query matches a walk of the book after commit");
+    }
+    else
+    {
+        failure ("account query differs from a walk of the book after commit");
+    }
+    qof_query_destroy (q);
+}
+
+/* A query with max_results keeps only the best matches while it runs;
+ * it must return the tail of the full sorted result, in either sort
+ * direction and with ties between the splits of a transaction. */
+static void
+test_query_max_results (QofBook *book)
+{
+    QofQuery *q;
+    GList *splits;
+    Account *account;
+    gboolean increasing;
+    gint limits[] = { 0, 1, 3, 20 };
+    guint i;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    splits = qof_query_run (q);
+    account = splits ? xaccSplitGetAccount (splits->data) : NULL;
+    qof_query_destroy (q);
+    if (!account)
+        return;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, account, QOF_QUERY_AND);
+
+    for (increasing = FALSE; increasing <= TRUE; ++increasing)
+    {
+        GList *all;
+        guint len;
+
+        qof_query_set_sort_order (q,
+                                  qof_query_build_param_list (SPLIT_TRANS,
+                                          TRANS_DATE_POSTED, NULL),
+                                  NULL, NULL);
+        qof_query_set_sort_increasing (q, increasing, TRUE, TRUE);
+        qof_query_set_max_results (q, -1);
+        all = g_list_copy (qof_query_run (q));
+        len = g_list_length (all);
+
+        for (i = 0; i < G_N_ELEMENTS (limits); ++i)
+        {
+            GList *tail = g_list_nth (all, MAX ((gint) len - limits[i], 0));
+            GList *found;
+
+            qof_query_set_max_results (q, limits[i]);
+            found = qof_query_run (q);
+            while (found && tail && found->data == tail->data)
+            {
+                found = found->next;
+                tail = tail->next;
+            }
+            if (!found && !tail)
+            {
+                success ("max results query is the tail of the full result");
+            }
+            else
+            {
+                failure ("max results query differs from the full result");
+            }
+        }
+        g_list_free (all);
+    }
+    qof_query_destroy (q);
+}
+
 static void
 run_test (void)
 {
@@ -80,6 +361,12 @@ run_test (void)
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
 
+    test_live_query (book);
+
+    test_account_access_path (book);
+
+    test_query_max_results (book);
+
     qof_session_end (session);
 }
 
@@ -29,8 +29,10 @@
 #include "../Account.h"
 #include "../AccountP.h"
 #include "../Split.h"
+#include "../SplitP.h"
 #include "../Transaction.h"
 #include "../gnc-lot.h"
+#include <qofbookslots.h>
 
 #ifdef HAVE_GLIB_2_38
 #define _Q "'"
@@ -1185,6 +1187,190 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     test_signal_free (sig3);
     test_signal_free (sig1);
 }
+static Split*
+make_dated_split (QofBook *book, time64 date)
+{
+    Transaction *txn = xaccMallocTransaction (book);
+    Split *split = xaccMallocSplit (book);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedSecs (txn, date);
+    xaccSplitSetParent (split, txn);
+    qof_commit_edit (QOF_INSTANCE (txn));
+    return split;
+}
+
+static void
+check_split_list_order (AccountPrivate *priv)
+{
+    GList *node;
+
+    for (node = priv->splits; node && node->next; node = node->next)
+        g_assert_cmpint (xaccSplitOrder (node->data, node->next->data), <, 0);
+    g_assert (priv->last_split == g_list_last (priv->splits));
+    g_assert_cmpuint (g_hash_table_size (priv->splits_hash), ==,
+                      g_list_length (priv->splits));
+    for (node = priv->splits; node; node = node->next)
+        g_assert (g_hash_table_lookup (priv->splits_hash, node->data) == node);
+}
+/* Inserts out of date order, at the head, in the middle and at the
+ * tail of the list, with and without deferred sorting, and checks
+ * that the list, its tail pointer and its node index stay consistent.
+ */
+static void
+test_gnc_account_insert_split_order (Fixture *fixture, gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    time64 base = gnc_time (NULL);
+    const gint offsets[] = {5, 1, 9, 3, 7, 0, 10, 4};
+    Split *splits[G_N_ELEMENTS (offsets)];
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (offsets); ++i)
+    {
+        splits[i] = make_dated_split (book, base + offsets[i] * 86400);
+        g_assert (gnc_account_insert_split (fixture->acct, splits[i]));
+        check_split_list_order (priv);
+    }
+    g_assert_cmpuint (g_list_length (priv->splits), ==, G_N_ELEMENTS (offsets));
+    g_assert (priv->splits->data == splits[5]);
+    g_assert (priv->last_split->data == splits[6]);
+
+    /* Remove the tail, the head and a middle split */
+    g_assert (gnc_account_remove_split (fixture->acct, splits[6]));
+    g_assert (gnc_account_remove_split (fixture->acct, splits[5]));
+    g_assert (gnc_account_remove_split (fixture->acct, splits[3]));
+    check_split_list_order (priv);
+    g_assert_cmpuint (g_list_length (priv->splits), ==, 5);
+
+    /* Deferred sorting while the account is open for editing */
+    xaccAccountBeginEdit (fixture->acct);
+    g_assert (gnc_account_insert_split (fixture->acct, splits[6]));
+    g_assert (gnc_account_insert_split (fixture->acct, splits[5]));
+    g_assert (!gnc_account_insert_split (fixture->acct, splits[5]));
+    g_assert (priv->sort_dirty);
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    check_split_list_order (priv);
+    xaccAccountCommitEdit (fixture->acct);
+    g_assert (priv->splits->data == splits[5]);
+    g_assert (priv->last_split->data == splits[6]);
+}
+/* Timing of a bulk load into a single account; run with "-m perf". */
+static void
+test_gnc_account_insert_split_perf (Fixture *fixture, gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    time64 base = gnc_time (NULL);
+    const guint num_splits = 100000;
+    GPtrArray *splits = g_ptr_array_sized_new (num_splits);
+    gdouble elapsed;
+    guint i;
+
+    if (!g_test_perf ())
+        return;
+
+    for (i = 0; i < num_splits; ++i)
+        g_ptr_array_add (splits,
+                         make_dated_split (book, base + i * 600));
+
+    /* The load pattern used by the backends: deferred sort */
+    g_test_timer_start ();
+    xaccAccountBeginEdit (fixture->acct);
+    for (i = 0; i < num_splits; ++i)
+        gnc_account_insert_split (fixture->acct,
+                                  g_ptr_array_index (splits, i));
+    xaccAccountCommitEdit (fixture->acct);
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Deferred insert of %u splits: %6.3f s",
+                             num_splits, elapsed);
+    g_assert_cmpuint (g_list_length (priv->splits), ==, num_splits);
+
+    for (i = 0; i < num_splits; ++i)
+        gnc_account_remove_split (fixture->acct,
+                                  g_ptr_array_index (splits, i));
+    g_assert (priv->splits == NULL);
+
+    /* Interactive inserts arriving in date order */
+    g_test_timer_start ();
+    for (i = 0; i < num_splits; ++i)
+        gnc_account_insert_split (fixture->acct,
+                                  g_ptr_array_index (splits, i));
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Ordered insert of %u splits: %6.3f s",
+                             num_splits, elapsed);
+    g_assert_cmpuint (g_list_length (priv->splits), ==, num_splits);
+    g_ptr_array_free (splits, TRUE);
+}
+/* What the register does with the book options for each split it
+ * loads: sort the splits, then check each one for the read-only
+ * threshold, trading accounts and the num field source.  With
+ * drop_cache the options are read from the book's slots again for every
+ * split, as they were before QofBook cached them. */
+static gint
+register_load_pass (QofBook *book, GList *splits, gboolean drop_cache)
+{
+    GList *sorted = g_list_sort (g_list_copy (splits),
+                                 (GCompareFunc) xaccSplitOrder);
+    GList *node;
+    gint count = 0;
+
+    for (node = sorted; node; node = node->next)
+    {
+        Transaction *txn = xaccSplitGetParent (node->data);
+
+        if (drop_cache)
+            book->cached_options.valid = FALSE;
+        count += xaccTransIsReadonlyByPostedDate (txn);
+        count += xaccTransUseTradingAccounts (txn);
+        count += qof_book_use_split_action_for_num_field (book);
+    }
+    g_list_free (sorted);
+    return count;
+}
+/* Timing of the book option reads of a register load; run with
+ * "-m perf". */
+static void
+test_register_load_book_options_perf (Fixture *fixture, gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    time64 base = gnc_time (NULL) - 60 * 86400;
+    const guint num_splits = 100000;
+    gchar *slot_path;
+    gdouble elapsed;
+    gint cached, uncached;
+    guint i;
+
+    if (!g_test_perf ())
+        return;
+
+    slot_path = g_strconcat (KVP_OPTION_PATH, "/", OPTION_SECTION_ACCOUNTS,
+                             "/", OPTION_NAME_AUTO_READONLY_DAYS, NULL);
+    kvp_frame_set_double (qof_book_get_slots (book), slot_path, 30);
+    qof_book_kvp_changed (book);
+    g_free (slot_path);
+
+    xaccAccountBeginEdit (fixture->acct);
+    for (i = 0; i < num_splits; ++i)
+        gnc_account_insert_split (fixture->acct,
+                                  make_dated_split (book, base + i * 60));
+    xaccAccountCommitEdit (fixture->acct);
+
+    g_test_timer_start ();
+    uncached = register_load_pass (book, priv->splits, TRUE);
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Register load of %u splits, options read every split: %6.3f s",
+                             num_splits, elapsed);
+
+    g_test_timer_start ();
+    cached = register_load_pass (book, priv->splits, FALSE);
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Register load of %u splits, cached options: %6.3f s",
+                             num_splits, elapsed);
+    g_assert_cmpint (cached, ==, uncached);
+}
 /* xaccAccountSortSplits
 void
 xaccAccountSortSplits (Account *acc, gboolean force)// C: 4 in 2
@@ -1340,6 +1526,93 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert (!priv->balance_dirty);
 }
 
+static void
+check_running_balances (AccountPrivate *priv)
+{
+    gnc_numeric bal = priv->starting_balance;
+    gnc_numeric clr_bal = priv->starting_cleared_balance;
+    GList *node;
+
+    for (node = priv->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        bal = gnc_numeric_add_fixed (bal, split->amount);
+        if (split->reconciled != NREC)
+            clr_bal = gnc_numeric_add_fixed (clr_bal, split->amount);
+        g_assert (gnc_numeric_eq (split->balance, bal));
+        g_assert (gnc_numeric_eq (split->cleared_balance, clr_bal));
+    }
+    g_assert (gnc_numeric_eq (priv->balance, bal));
+    g_assert (gnc_numeric_eq (priv->cleared_balance, clr_bal));
+}
+/* Appending, editing and removing splits only recompute the running
+ * balances from the affected split onwards. */
+static void
+test_xaccAccountRecomputeBalance_incremental (Fixture *fixture,
+                                              gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    time64 base = gnc_time (NULL);
+    Split *splits[6];
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (splits); ++i)
+    {
+        splits[i] = make_dated_split (book, base + i * 86400);
+        splits[i]->amount = gnc_numeric_create (100 * (i + 1), 100);
+        splits[i]->reconciled = (i % 2) ? CREC : NREC;
+        g_assert (gnc_account_insert_split (fixture->acct, splits[i]));
+        /* An append leaves every earlier balance alone. */
+        g_assert (priv->balance_dirty);
+        g_assert (priv->balance_valid_split == (i ? splits[i - 1] : NULL));
+        xaccAccountRecomputeBalance (fixture->acct);
+        check_running_balances (priv);
+    }
+
+    /* Edit a split in the middle */
+    splits[2]->amount = gnc_numeric_create (-1234, 100);
+    gnc_account_split_changed (fixture->acct, splits[2]);
+    g_assert (!priv->sort_dirty);
+    g_assert (priv->balance_valid_split == splits[1]);
+    /* A second edit to the same split doesn't widen the range */
+    gnc_account_split_changed (fixture->acct, splits[2]);
+    g_assert (priv->balance_valid_split == splits[1]);
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert (!priv->balance_dirty);
+    check_running_balances (priv);
+
+    /* Edits in two places fall back to a full recomputation */
+    splits[1]->amount = gnc_numeric_create (4321, 100);
+    gnc_account_split_changed (fixture->acct, splits[1]);
+    splits[4]->amount = gnc_numeric_create (-4321, 100);
+    gnc_account_split_changed (fixture->acct, splits[4]);
+    g_assert (priv->balance_dirty);
+    g_assert (priv->balance_valid_split == NULL);
+    xaccAccountRecomputeBalance (fixture->acct);
+    check_running_balances (priv);
+
+    /* Removals, which recompute immediately */
+    g_assert (gnc_account_remove_split (fixture->acct, splits[3]));
+    g_assert (!priv->balance_dirty);
+    check_running_balances (priv);
+    g_assert (gnc_account_remove_split (fixture->acct, splits[5]));
+    check_running_balances (priv);
+    g_assert (gnc_account_remove_split (fixture->acct, splits[0]));
+    check_running_balances (priv);
+
+    /* Moving a split out of order marks the list for sorting */
+    xaccTransBeginEdit (splits[1]->parent);
+    xaccTransSetDatePostedSecs (splits[1]->parent, base + 10 * 86400);
+    qof_commit_edit (QOF_INSTANCE (splits[1]->parent));
+    gnc_account_split_changed (fixture->acct, splits[1]);
+    g_assert (priv->sort_dirty);
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert (priv->last_split->data == splits[1]);
+    check_running_balances (priv);
+}
+
 /* xaccAccountOrder
 int
 xaccAccountOrder (const Account *aa, const Account *ab)// C: 11 in 3 */
@@ -1960,6 +2233,48 @@ test_xaccAccountGetPresentBalance (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* The date index behind xaccAccountGetBalanceAsOfDate is extended on
+ * appends and rebuilt after other changes; check it gives the same
+ * answers as a walk of the split list in both cases. */
+static void
+test_xaccAccountGetBalanceAsOfDate_index (Fixture *fixture,
+                                          gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    time64 base = gnc_time64_get_day_start (gnc_time (NULL)) - 30 * 86400;
+    Split *splits[8];
+    guint i, j;
+
+    g_assert (gnc_numeric_zero_p (xaccAccountGetBalanceAsOfDate (fixture->acct, base)));
+    for (i = 0; i < G_N_ELEMENTS (splits); ++i)
+    {
+        /* Two splits on each day */
+        splits[i] = make_dated_split (book, base + (i / 2) * 86400);
+        splits[i]->amount = gnc_numeric_create (i + 1, 1);
+        g_assert (gnc_account_insert_split (fixture->acct, splits[i]));
+        g_assert_cmpint (gnc_numeric_compare (xaccAccountGetBalanceAsOfDate (fixture->acct, base + 86400 * 10), priv->balance), ==, 0);
+    }
+    g_assert (priv->split_index != NULL);
+    g_assert_cmpuint (priv->split_index->len, ==, G_N_ELEMENTS (splits));
+
+    g_assert (gnc_account_remove_split (fixture->acct, splits[3]));
+    g_assert (priv->split_index == NULL);
+
+    for (j = 0; j <= G_N_ELEMENTS (splits) / 2; ++j)
+    {
+        time64 date = base + j * 86400;
+        gnc_numeric expected = gnc_numeric_zero ();
+        GList *node;
+
+        for (node = priv->splits; node; node = node->next)
+            if (xaccTransGetDate (xaccSplitGetParent (node->data)) < date)
+                expected = xaccSplitGetBalance (node->data);
+        g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (fixture->acct, date), expected));
+    }
+    g_assert (gnc_numeric_equal (xaccAccountGetPresentBalance (fixture->acct),
+                                 priv->balance));
+}
 /*
  * xaccAccountConvertBalanceToCurrency
  * xaccAccountConvertBalanceToCurrencyAsOfDate are wrappers around
@@ -2518,8 +2833,12 @@ test_suite_account (void)
 // GNC_TEST_ADD (suitename, "xaccAcctChildrenEqual", Fixture, NULL, setup, test_xaccAcctChildrenEqual,  teardown );
 // GNC_TEST_ADD (suitename, "xaccAccountEqual", Fixture, NULL, setup, test_xaccAccountEqual,  teardown );
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account insert split order", Fixture, NULL, setup, test_gnc_account_insert_split_order,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account insert split perf", Fixture, NULL, setup, test_gnc_account_insert_split_perf,  teardown );
+    GNC_TEST_ADD (suitename, "register load book options perf", Fixture, NULL, setup, test_register_load_book_options_perf,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance incremental", Fixture, NULL, setup, test_xaccAccountRecomputeBalance_incremental,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
@@ -2539,6 +2858,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate index", Fixture, NULL, setup, test_xaccAccountGetBalanceAsOfDate_index,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
 
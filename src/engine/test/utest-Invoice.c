@@ -24,7 +24,9 @@
 #include <glib.h>
 #include <qof.h>
 #include <unittest-support.h>
+#include "../gncCustomer.h"
 #include "../gncInvoice.h"
+#include "../gncTaxTable.h"
 
 static const gchar *suitename = "/engine/gncInvoice";
 void test_suite_gncInvoice ( void );
@@ -88,8 +90,69 @@ test_invoice_post ( Fixture *fixture, gconstpointer pData )
     g_assert(!gncInvoiceIsPosted(invoice));
 }
 
+/* The referring objects of the business types come from the book's
+ * index of references, which has to follow commits, changes made
+ * without a commit and destroyed objects. */
+static void
+test_referring_objects ( Fixture *fixture, gconstpointer pData )
+{
+    GncInvoice *invoice = gncInvoiceCreate(fixture->book);
+    GncTaxTable *table = gncTaxTableCreate(fixture->book);
+    GncTaxTableEntry *tte = gncTaxTableEntryCreate();
+    Account *other = xaccMallocAccount(fixture->book);
+    GList *list;
+
+    gncInvoiceSetCurrency(invoice, fixture->commodity);
+    gncTaxTableEntrySetAccount(tte, fixture->account);
+    gncTaxTableAddEntry(table, tte);
+    gncCustomerSetTaxTable(fixture->customer, table);
+
+    list = qof_instance_get_referring_object_list(QOF_INSTANCE(fixture->account));
+    g_assert_cmpint(g_list_length(list), ==, 1);
+    g_assert(list->data == table);
+    g_list_free(list);
+
+    list = qof_instance_get_referring_object_list(QOF_INSTANCE(fixture->commodity));
+    g_assert_cmpint(g_list_length(list), ==, 1);
+    g_assert(list->data == invoice);
+    g_list_free(list);
+
+    list = qof_instance_get_referring_object_list(QOF_INSTANCE(table));
+    g_assert_cmpint(g_list_length(list), ==, 1);
+    g_assert(list->data == fixture->customer);
+    g_list_free(list);
+
+    /* A committed change */
+    gncInvoiceSetPostedAcc(invoice, fixture->account);
+    list = qof_instance_get_referring_object_list(QOF_INSTANCE(fixture->account));
+    g_assert_cmpint(g_list_length(list), ==, 2);
+    g_assert(g_list_find(list, invoice) && g_list_find(list, table));
+    g_list_free(list);
+
+    /* A tax table entry is changed without a commit of the table */
+    gncTaxTableEntrySetAccount(tte, other);
+    list = qof_instance_get_referring_object_list(QOF_INSTANCE(fixture->account));
+    g_assert_cmpint(g_list_length(list), ==, 1);
+    g_assert(list->data == invoice);
+    g_list_free(list);
+    list = qof_instance_get_referring_object_list(QOF_INSTANCE(other));
+    g_assert_cmpint(g_list_length(list), ==, 1);
+    g_assert(list->data == table);
+    g_list_free(list);
+
+    /* A destroyed object */
+    gncInvoiceBeginEdit(invoice);
+    gncInvoiceDestroy(invoice);
+    g_assert(qof_instance_get_referring_object_list(QOF_INSTANCE(fixture->account)) == NULL);
+    g_assert(qof_instance_get_referring_object_list(QOF_INSTANCE(fixture->commodity)) == NULL);
+
+    gncCustomerSetTaxTable(fixture->customer, NULL);
+    g_assert(qof_instance_get_referring_object_list(QOF_INSTANCE(table)) == NULL);
+}
+
 void
 test_suite_gncInvoice ( void )
 {
     GNC_TEST_ADD( suitename, "post", Fixture, NULL, setup, test_invoice_post, teardown );
+    GNC_TEST_ADD( suitename, "referring objects", Fixture, NULL, setup, test_referring_objects, teardown );
 }
@@ -353,12 +353,30 @@ Not testable and wrong besides.
 */
 /* mark_split
 void mark_split (Split *s)// C: 2 in 2 SCM: 10 in 1 Local: 8:0:0
-OK, weird. Doesn't mark the split, marks the account sort-dirty and balance-dirty parameters.
+OK, weird. Doesn't mark the split, marks the account balance-dirty
+parameter, and sort-dirty if the split is now out of order.
 */
 static void
 test_mark_split (Fixture *fixture, gconstpointer pData)
 {
     gboolean sort_dirty, balance_dirty;
+    Account *acc = fixture->split->acc;
+    Split *other = xaccMallocSplit (xaccSplitGetBook (fixture->split));
+
+    /* A split that the account doesn't hold doesn't affect it */
+    other->acc = acc;
+    mark_split (other);
+    g_object_get (acc,
+                  "sort-dirty", &sort_dirty,
+                  "balance-dirty", &balance_dirty,
+                  NULL);
+    g_assert_cmpint (sort_dirty, ==, FALSE);
+    g_assert_cmpint (balance_dirty, ==, FALSE);
+    other->acc = NULL;
+    test_destroy (other);
+
+    gnc_account_insert_split (acc, fixture->split);
+    xaccAccountRecomputeBalance (acc);
     g_object_get (fixture->split->acc,
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
@@ -372,7 +390,7 @@ test_mark_split (Fixture *fixture, gconstpointer pData)
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
                   NULL);
-    g_assert_cmpint (sort_dirty, ==, TRUE);
+    g_assert_cmpint (sort_dirty, ==, FALSE);
     g_assert_cmpint (balance_dirty, ==, TRUE);
 }
 // Not Used
@@ -583,7 +601,7 @@ test_xaccSplitCommitEdit (Fixture *fixture, gconstpointer pData)
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
                   NULL);
-    g_assert_cmpint (sort_dirty, ==, TRUE);
+    g_assert_cmpint (sort_dirty, ==, FALSE);
     g_assert_cmpint (balance_dirty, ==, FALSE);
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split->parent)));
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split)));
@@ -608,7 +626,7 @@ test_xaccSplitCommitEdit (Fixture *fixture, gconstpointer pData)
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
                   NULL);
-    g_assert_cmpint (sort_dirty, ==, TRUE);
+    g_assert_cmpint (sort_dirty, ==, FALSE);
     g_assert_cmpint (balance_dirty, ==, FALSE);
     g_assert (!qof_instance_is_dirty (QOF_INSTANCE (fixture->split->parent)));
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split)));
@@ -1212,6 +1230,35 @@ test_xaccSplitOrder (Fixture *fixture, gconstpointer pData)
     test_destroy (o_split);
     test_destroy (o_txn);
 }
+/* The sort keys cached by xaccSplitOrder must follow the setters. */
+static void
+test_xaccSplitOrder_sort_key (Fixture *fixture, gconstpointer pData)
+{
+    Split *split = fixture->split;
+    Split *o_split = xaccMallocSplit (xaccSplitGetBook (split));
+
+    /* Same transaction, so the memo decides */
+    o_split->parent = split->parent;
+    xaccSplitSetMemo (split, "a");
+    xaccSplitSetMemo (o_split, "b");
+    g_assert_cmpint (xaccSplitOrder (split, o_split), <, 0);
+    xaccSplitSetMemo (split, "c");
+    g_assert_cmpint (xaccSplitOrder (split, o_split), >, 0);
+    xaccSplitSetMemo (split, "d");
+    xaccSplitSetMemo (split, "a");
+    g_assert_cmpint (xaccSplitOrder (split, o_split), <, 0);
+
+    /* Equal memos: the actions compare as numbers or as strings */
+    xaccSplitSetMemo (split, "b");
+    xaccSplitSetAction (split, "2");
+    xaccSplitSetAction (o_split, "10");
+    g_assert_cmpint (xaccSplitOrder_num_action (split, o_split, TRUE), ==, -1);
+    g_assert_cmpint (xaccSplitOrder_num_action (split, o_split, FALSE), >, 0);
+    g_assert_cmpint (xaccSplitOrder (split, o_split), >, 0);
+
+    o_split->parent = NULL;
+    test_destroy (o_split);
+}
 /* xaccSplitOrderDateOnly
 gint
 xaccSplitOrderDateOnly (const Split *sa, const Split *sb)// C: 2 in 1
@@ -1794,6 +1841,7 @@ test_xaccSplitGetOtherSplit (Fixture *fixture, gconstpointer pData)
     kvp_frame_set_slot_path (book_slots, kvptrue, KVP_OPTION_PATH,
                              OPTION_SECTION_ACCOUNTS,
                              OPTION_NAME_TRADING_ACCOUNTS, NULL);
+    qof_book_kvp_changed (book);
     g_assert (xaccTransUseTradingAccounts (txn));
     g_assert (xaccSplitGetOtherSplit (split) == NULL);
     split2->acc = acc2;
@@ -1890,6 +1938,7 @@ test_suite_split (void)
     GNC_TEST_ADD_FUNC (suitename, "xaccSplitConvertAmount", test_xaccSplitConvertAmount);
     GNC_TEST_ADD_FUNC (suitename, "xaccSplitDestroy", test_xaccSplitDestroy);
     GNC_TEST_ADD (suitename, "xaccSplitOrder", Fixture, NULL, setup, test_xaccSplitOrder, teardown);
+    GNC_TEST_ADD (suitename, "xaccSplitOrder sort key", Fixture, NULL, setup, test_xaccSplitOrder_sort_key, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitOrderDateOnly", Fixture, NULL, setup, test_xaccSplitOrderDateOnly, teardown);
     GNC_TEST_ADD (suitename, "get corr account split", Fixture, NULL, setup, test_get_corr_account_split, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitGetCorrAccountFullName", Fixture, NULL, setup, test_xaccSplitGetCorrAccountFullName, teardown);
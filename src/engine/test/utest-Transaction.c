@@ -274,7 +274,7 @@ test_xaccTransStillHasSplit (Fixture *fixture, gconstpointer pData)
 /* mark_trans
 void mark_trans (Transaction *trans)// Local: 3:0:0
 */
-#define check_split_dirty(xsplit, test)                \
+#define check_split_dirty(xsplit, sort, balance)       \
 {                                                      \
     gboolean sort_dirty, balance_dirty;                \
     Split *split = xsplit;                             \
@@ -282,8 +282,8 @@ void mark_trans (Transaction *trans)// Local: 3:0:0
 		  "sort-dirty", &sort_dirty,           \
 		  "balance-dirty", &balance_dirty,     \
 		  NULL);                               \
-    g_assert_cmpint (sort_dirty, ==, test);            \
-    g_assert_cmpint (balance_dirty, ==, test);         \
+    g_assert_cmpint (sort_dirty, ==, sort);            \
+    g_assert_cmpint (balance_dirty, ==, balance);      \
 }
 
 static void
@@ -296,7 +296,7 @@ test_mark_trans (Fixture *fixture, gconstpointer pData)
     {
         if (!splits->data) continue;
         g_assert (!qof_instance_get_dirty_flag (splits->data));
-        check_split_dirty (splits->data, FALSE);
+        check_split_dirty (splits->data, FALSE, FALSE);
     }
     fixture->func->mark_trans (fixture->txn);
     g_assert (!qof_instance_get_dirty_flag (fixture->txn));
@@ -304,7 +304,8 @@ test_mark_trans (Fixture *fixture, gconstpointer pData)
     {
         if (!splits->data) continue;
         g_assert (!qof_instance_get_dirty_flag (splits->data));
-        check_split_dirty (splits->data, TRUE);
+        /* Marking the splits doesn't change their order */
+        check_split_dirty (splits->data, FALSE, TRUE);
     }
 }
 /* gen_event_trans
@@ -347,7 +348,7 @@ test_gnc_transaction_init ()
     g_assert_cmpint (txn->date_posted.tv_sec, ==, 0);
     g_assert_cmpint (txn->date_posted.tv_nsec, ==, 0);
     g_assert_cmpint (txn->marker, ==, 0);
-    g_assert (txn->orig == NULL);
+    g_assert (txn->journal == NULL);
 
     test_destroy (txn);
 }
@@ -604,7 +605,7 @@ test_xaccDupeTransaction (Fixture *fixture, gconstpointer pData)
     g_assert (timespec_equal (&(new->date_entered), &entered));
     g_assert (qof_instance_version_cmp (QOF_INSTANCE (new),
                                         QOF_INSTANCE (old)) == 0);
-    g_assert (new->orig == NULL);
+    g_assert (new->journal == NULL);
     g_assert (new->common_currency == fixture->curr);
     g_assert (new->inst.e_type == NULL);
     g_assert (guid_equal (qof_instance_get_guid (QOF_INSTANCE (new)),
@@ -657,7 +658,7 @@ test_xaccTransClone (Fixture *fixture, gconstpointer pData)
                                         QOF_INSTANCE (old)) == 0);
     g_assert_cmpint (qof_instance_get_version_check (new), ==,
                      qof_instance_get_version_check (old));
-    g_assert (new->orig == NULL);
+    g_assert (new->journal == NULL);
     g_assert (new->common_currency == fixture->curr);
 
     g_assert (qof_instance_get_book (QOF_INSTANCE (new)) == old_book);
@@ -739,15 +740,14 @@ static void
 test_xaccFreeTransaction (Fixture *fixture, gconstpointer pData)
 {
     Transaction *txn = fixture->txn;
-    Transaction *orig = xaccMallocTransaction (qof_instance_get_book (QOF_INSTANCE (txn)));
     Split *split = txn->splits->data;
     gchar *txn_num = "321";
     g_object_add_weak_pointer (G_OBJECT (txn->splits->data), (gpointer)&split);
     /* so the "free" doesn't, leaving the structure for us to test */
     g_object_ref (txn);
-    g_object_ref (orig);
-    orig->num = CACHE_INSERT (txn_num);
-    txn->orig = orig;
+    xaccTransBeginEdit (txn);
+    xaccTransSetNum (txn, txn_num);
+    g_assert (txn->journal != NULL);
 
     fixture->func->xaccFreeTransaction (txn);
 
@@ -759,9 +759,7 @@ test_xaccFreeTransaction (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (txn->date_entered.tv_nsec, ==, 0);
     g_assert_cmpint (txn->date_posted.tv_sec, ==, 0);
     g_assert_cmpint (txn->date_posted.tv_nsec, ==, 0);
-    g_assert_cmpint (GPOINTER_TO_INT(orig->num), ==, 1);
-    g_assert (txn->orig == NULL);
-    test_destroy (orig);
+    g_assert (txn->journal == NULL);
 
     g_test_log_set_fatal_handler ((GTestLogFatalFunc) test_log_handler, NULL);
 
@@ -790,7 +788,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     gchar entered[DATE_BUF_SIZE], posted[DATE_BUF_SIZE];
     gchar *msg1 = "[xaccTransEqual] one is NULL";
     gchar *msg2 = NULL;
-    gchar *cleanup_fmt = "[trans_cleanup_commit] get rid of rollback trans=%p";
+    gchar *cleanup_fmt = "[trans_cleanup_commit] discard edit journal of trans=%p";
     gchar split_guid0[GUID_ENCODING_LENGTH + 1];
     gchar split_guid1[GUID_ENCODING_LENGTH + 1];
     gchar *logdomain = "gnc.engine";
@@ -828,7 +826,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     g_assert (xaccTransEqual (clone, txn0, TRUE, FALSE, TRUE, TRUE));
     g_assert_cmpint (check->hits, ==, 1);
     xaccTransBeginEdit (clone);
-    cleanup->msg = g_strdup_printf (cleanup_fmt, clone->orig);
+    cleanup->msg = g_strdup_printf (cleanup_fmt, clone);
     /* This changes the amount and value of the first split */
     xaccTransSetCurrency (clone, fixture->comm);
     xaccTransCommitEdit (clone);
@@ -841,7 +839,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     gnc_timespec_to_iso8601_buff (clone->date_posted, posted);
     gnc_timespec_to_iso8601_buff (clone->date_entered, entered);
     xaccTransBeginEdit (clone);
-    cleanup->msg = g_strdup_printf (cleanup_fmt, clone->orig);
+    cleanup->msg = g_strdup_printf (cleanup_fmt, clone);
     /* This puts the value of the first split back, but leaves the amount changed */
     xaccTransSetCurrency (clone, fixture->curr);
     clone->date_posted.tv_sec = txn0->date_entered.tv_sec;
@@ -853,7 +851,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (check->hits, ==, 3);
 
     xaccTransBeginEdit (clone);
-    cleanup->msg = g_strdup_printf (cleanup_fmt, clone->orig);
+    cleanup->msg = g_strdup_printf (cleanup_fmt, clone);
     clone->date_posted.tv_sec = txn0->date_posted.tv_sec;
     clone->date_entered.tv_sec = txn0->date_posted.tv_sec;
     xaccTransCommitEdit (clone);
@@ -864,7 +862,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (check->hits, ==, 4);
 
     xaccTransBeginEdit (clone);
-    cleanup->msg = g_strdup_printf (cleanup_fmt, clone->orig);
+    cleanup->msg = g_strdup_printf (cleanup_fmt, clone);
     clone->date_entered.tv_sec = txn0->date_entered.tv_sec;
     clone->num = "123";
     xaccTransCommitEdit (clone);
@@ -895,7 +893,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (check->hits, ==, 8);
 
     xaccTransBeginEdit (clone);
-    cleanup->msg = g_strdup_printf (cleanup_fmt, clone->orig);
+    cleanup->msg = g_strdup_printf (cleanup_fmt, clone);
     clone->description = CACHE_INSERT ("Waldo Pepper");
     kvp_frame_set_double (qof_instance_get_slots (QOF_INSTANCE (clone)),
                           "/qux/quux/corge", 654.321);
@@ -908,7 +906,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
 
     g_assert_cmpint (check->hits, ==, 9);
     xaccTransBeginEdit (clone);
-    cleanup->msg = g_strdup_printf (cleanup_fmt, clone->orig);
+    cleanup->msg = g_strdup_printf (cleanup_fmt, clone);
     clone->description = CACHE_INSERT ("Waldo Pepper");
     kvp_frame_set_double (qof_instance_get_slots (QOF_INSTANCE (clone)),
                           "/qux/quux/corge", 123.456);
@@ -1339,7 +1337,7 @@ test_xaccTransBeginEdit ()
 {
     QofBook *book = qof_book_new ();
     Transaction *txn = xaccMallocTransaction (book);
-    Transaction *dupe = NULL;
+    TransJournal *journal = NULL;
     gchar *msg1 = "[xaccOpenLog] Attempt to open disabled transaction log";
     gchar *msg2 = "[xaccTransWriteLog] Attempt to write disabled transaction log";
     guint loglevel = G_LOG_LEVEL_INFO;
@@ -1353,36 +1351,40 @@ test_xaccTransBeginEdit ()
 
 
     g_assert_cmpint (0, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    g_assert (txn->orig == NULL);
+    g_assert (txn->journal == NULL);
     xaccTransBeginEdit (txn);
     g_assert_cmpint (1, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    dupe = txn->orig;
-    g_assert (txn->orig != NULL);
+    /* Nothing is recorded until something changes */
+    g_assert (txn->journal == NULL);
     g_assert_cmpint (1, ==, check1->hits);
     g_assert_cmpint (1, ==, check2->hits);
+    xaccTransSetDescription (txn, "Waldo Pepper");
+    journal = txn->journal;
+    g_assert (journal != NULL);
     xaccTransBeginEdit (txn);
     g_assert_cmpint (2, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    g_assert (txn->orig == dupe);
+    xaccTransSetNum (txn, "123");
+    g_assert (txn->journal == journal);
     g_assert_cmpint (1, ==, check1->hits);
     g_assert_cmpint (1, ==, check2->hits);
     xaccTransRollbackEdit (txn);
     xaccTransRollbackEdit (txn);
     g_assert_cmpint (0, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    g_assert (txn->orig == NULL);
+    g_assert (txn->journal == NULL);
+    g_assert_cmpstr (xaccTransGetDescription (txn), ==, "");
+    g_assert_cmpstr (xaccTransGetNum (txn), ==, "");
     qof_book_mark_readonly (book);
     xaccTransBeginEdit (txn);
-    dupe = txn->orig;
     g_assert_cmpint (1, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    g_assert (txn->orig == dupe);
     g_assert_cmpint (1, ==, check1->hits);
     g_assert_cmpint (2, ==, check2->hits);
     xaccTransRollbackEdit (txn);
     g_assert_cmpint (0, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    g_assert (txn->orig == NULL);
+    g_assert (txn->journal == NULL);
     qof_book_destroy (book);
     xaccTransBeginEdit (txn);
     g_assert_cmpint (1, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
-    g_assert (txn->orig == NULL);
+    g_assert (txn->journal == NULL);
     g_assert_cmpint (1, ==, check1->hits);
     g_assert_cmpint (2, ==, check2->hits);
 
@@ -1529,7 +1531,6 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     Split *bogus_split = xaccMallocSplit (book);
     Split *split0 = fixture->txn->splits->data;
     Account *acct0 = split0->acc;
-    Transaction *orig = NULL;
     TestSignal *sig_d_remove = test_signal_new (QOF_INSTANCE (destr_split),
                                QOF_EVENT_REMOVE, NULL);
     TestSignal *sig_b_remove = test_signal_new (QOF_INSTANCE (bogus_split),
@@ -1544,8 +1545,8 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
                                 GNC_EVENT_ITEM_CHANGED, NULL);
 
     xaccTransBeginEdit (fixture->txn);
-    orig = fixture->txn->orig;
-    g_object_ref (orig);
+    xaccTransSetDescription (fixture->txn, "salt pork");
+    g_assert (fixture->txn->journal != NULL);
     /* Check the txn-isn't-the-parent path */
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, destr_split);
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, bogus_split);
@@ -1565,7 +1566,7 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (test_signal_return_hits (sig_a_changed), ==, 1);
     g_assert_cmpint (g_list_index (fixture->txn->splits, destr_split), ==, -1);
     g_assert_cmpint (g_list_index (fixture->txn->splits, bogus_split), ==, -1);
-    g_assert (fixture->txn->orig == NULL);
+    g_assert (fixture->txn->journal == NULL);
     g_assert (fixture->txn->splits->data == split0);
     g_assert (qof_instance_get_destroying (destr_split));
     /* Note that the function itself aborts if qof_instance_editlevel != 0 */
@@ -1576,10 +1577,8 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     bogus_split->parent = fixture->txn;
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, destr_split);
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, bogus_split);
-
-    fixture->txn->orig = orig;
-    orig->num = fixture->txn->num;
-    g_object_ref (orig);
+    xaccTransSetDescription (fixture->txn, "salt peanuts");
+    g_assert (fixture->txn->journal != NULL);
     fixture->func->trans_cleanup_commit (fixture->txn);
 
     g_assert_cmpint (test_signal_return_hits (sig_d_remove), ==, 2);
@@ -1590,8 +1589,8 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (test_signal_return_hits (sig_a_changed), ==, 2);
     g_assert_cmpint (g_list_index (fixture->txn->splits, destr_split), ==, -1);
     g_assert_cmpint (g_list_index (fixture->txn->splits, bogus_split), ==, 0);
-    g_assert_cmpint (GPOINTER_TO_INT(orig->num), ==, 1);
-    test_destroy (orig);
+    g_assert (fixture->txn->journal == NULL);
+    g_assert_cmpstr (fixture->txn->description, ==, "salt peanuts");
 
 }
 /* xaccTransCommitEdit
@@ -1684,53 +1683,57 @@ static void
 test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
 {
     Transaction *txn = fixture->txn;
-    Transaction *orig = NULL;
     QofBook *book = qof_instance_get_book (txn);
     Timespec new_post = timespec_now ();
     Timespec new_entered = timespecCanonicalDayTime (timespec_now ());
     Timespec orig_post = txn->date_posted;
     Timespec orig_entered = txn->date_entered;
-    KvpFrame *base_frame = NULL;
+    KvpFrame *base_frame = kvp_frame_copy (txn->inst.kvp_data);
     TestSignal *sig_account = test_signal_new (QOF_INSTANCE (fixture->acc1),
                               GNC_EVENT_ITEM_CHANGED, NULL);
     MockBackend *mbe = (MockBackend*)qof_book_get_backend (book);
     Split *split_00 = txn->splits->data, *split_01 = txn->splits->next->data;
     Split *split_02 = xaccMallocSplit (book);
-    Split *split_10 = NULL, *split_11 = NULL;
+    Split *split_10 = xaccDupeSplit (split_00);
+    Split *split_11 = xaccDupeSplit (split_01);
 
     xaccTransBeginEdit (txn);
     qof_instance_set_destroying (txn, TRUE);
-    orig = txn->orig;
-    base_frame = orig->inst.kvp_data; /* DupeTransaction copies the kvp_frame */
-    g_object_ref (orig); /* Keep rollback from actually freeing it */
-    txn->num = "321";
-    txn->description = "salt peanuts";
-    txn->common_currency = NULL;
-    txn->inst.kvp_data = NULL;
-    txn->date_entered = new_entered;
-    txn->date_posted = new_post;
-    txn->splits->data = split_01;
-    txn->splits->next->data = split_00;
-    qof_instance_set_dirty (QOF_INSTANCE (split_01));
+    xaccTransSetNum (txn, "321");
+    xaccTransSetDescription (txn, "salt peanuts");
+    /* This changes the values of the splits, too */
+    xaccTransSetCurrency (txn, fixture->comm);
+    xaccTransSetNotes (txn, "Salt peanuts");
+    kvp_frame_set_string (xaccTransGetSlotsForEdit (txn), "/foo/bar", "baz");
+    xaccTransSetDateEnteredTS (txn, &new_entered);
+    xaccTransSetDatePostedTS (txn, &new_post);
+    xaccSplitSetMemo (split_01, "baz");
+    xaccSplitSetAmount (split_01, gnc_numeric_create (-1000, 1));
+    xaccSplitSetMemo (split_01, "qux");
+    kvp_frame_set_string (xaccSplitGetSlotsForEdit (split_01), "online_id",
+                          "quux");
+    xaccSplitSetDateReconciledSecs (split_00, 1357000000);
+    /* As the lot scrubbers do */
+    xaccSplitJournalSlots (split_00);
+    kvp_frame_set_guid (split_00->inst.kvp_data, "gains-split",
+                        xaccSplitGetGUID (split_01));
+    xaccSplitJournalGainsSplit (split_00);
+    split_00->gains_split = split_01;
     xaccSplitSetParent (split_02, txn);
     g_object_ref (split_02);
-    split_10 = xaccDupeSplit(orig->splits->data);
-    g_object_ref (split_10);
-    split_11 = xaccDupeSplit(orig->splits->next->data);
-    g_object_ref (split_11);
+    g_assert (txn->journal != NULL);
     qof_instance_increase_editlevel (QOF_INSTANCE (txn)); /* So it's 2 */
     xaccTransRollbackEdit (txn);
-    g_assert (txn->orig == orig);
+    g_assert (txn->journal != NULL);
     qof_instance_reset_editlevel (QOF_INSTANCE (txn)); /* Now it's 0 */
     xaccTransRollbackEdit (txn);
-    g_assert (txn->orig == orig);
+    g_assert (txn->journal != NULL);
     qof_instance_increase_editlevel (QOF_INSTANCE (txn)); /* And back to 1 */
     xaccTransRollbackEdit (txn);
-    g_assert (txn->orig == NULL);
+    g_assert (txn->journal == NULL);
     g_assert_cmpstr (txn->num, ==, "123");
-    g_assert_cmpint (GPOINTER_TO_INT(orig->num), ==, 1);
     g_assert_cmpstr (txn->description, ==, "Waldo Pepper");
-    g_assert (txn->inst.kvp_data == base_frame);
+    g_assert (kvp_frame_compare (txn->inst.kvp_data, base_frame) == 0);
     g_assert (txn->common_currency == fixture->curr);
     g_assert (timespec_equal (&(txn->date_posted), &orig_post));
     g_assert (timespec_equal (&(txn->date_entered), &orig_entered));
@@ -1739,17 +1742,20 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (GPOINTER_TO_INT(split_02->memo), ==, 1);
     g_assert (xaccSplitEqual (txn->splits->data, split_10,
                               FALSE, FALSE, FALSE));
-    g_assert (xaccSplitEqual (txn->splits->next->data, split_10,
+    g_assert (xaccSplitEqual (txn->splits->next->data, split_11,
                               FALSE, FALSE, FALSE));
+    g_assert (kvp_frame_get_slot (split_00->inst.kvp_data, "gains-split") == NULL);
+    g_assert (split_00->gains_split == NULL);
+    g_assert (kvp_frame_get_slot (xaccSplitGetSlots (txn->splits->next->data),
+                                  "online_id") == NULL);
     g_assert_cmpstr (mbe->last_call, ==, "rollback");
     g_assert_cmpuint (qof_instance_get_editlevel (QOF_INSTANCE (txn)), ==, 0);
     g_assert (qof_instance_get_destroying (txn) == FALSE);
     test_signal_free (sig_account);
+    kvp_frame_delete (base_frame);
     g_object_unref (split_10);
     g_object_unref (split_11);
     g_object_unref (split_02);
-    g_object_unref (orig);
-
 }
 /* A second xaccTransRollbackEdit test to check the backend error handling */
 static void
@@ -0,0 +1,369 @@
+/********************************************************************
+ * utest-gnc-pricedb.c: GLib g_test test suite for gnc-pricedb.c.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+********************************************************************/
+#include "config.h"
+#include <string.h>
+#include <glib.h>
+#include <unittest-support.h>
+/* Add specific headers for this class */
+#include "../gnc-pricedb.h"
+#include "../gnc-pricedb-p.h"
+
+static const gchar *suitename = "/engine/gnc-pricedb";
+void test_suite_gnc_pricedb (void);
+
+typedef struct
+{
+    QofBook *book;
+    GNCPriceDB *db;
+    gnc_commodity *commodity;
+    gnc_commodity *currency;
+} Fixture;
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    gnc_pricedb_register ();
+    fixture->book = qof_book_new ();
+    fixture->db = gnc_pricedb_get_db (fixture->book);
+    fixture->commodity = gnc_commodity_new (fixture->book, "Foo Corp",
+                                            "NASDAQ", "FOO", "", 1000);
+    fixture->currency = gnc_commodity_new (fixture->book, "US Dollar",
+                                           "CURRENCY", "USD", "", 100);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    /* The book destroys the pricedb */
+    gnc_commodity_destroy (fixture->commodity);
+    gnc_commodity_destroy (fixture->currency);
+    qof_book_destroy (fixture->book);
+}
+
+static GNCPrice *
+add_price (Fixture *fixture, time64 secs, gint64 value)
+{
+    GNCPrice *p = gnc_price_create (fixture->book);
+    Timespec ts = {secs, 0};
+
+    gnc_price_begin_edit (p);
+    gnc_price_set_commodity (p, fixture->commodity);
+    gnc_price_set_currency (p, fixture->currency);
+    gnc_price_set_time (p, ts);
+    gnc_price_set_value (p, gnc_numeric_create (value, 100));
+    gnc_price_commit_edit (p);
+    g_assert (gnc_pricedb_add_price (fixture->db, p));
+    gnc_price_unref (p);
+    return p;
+}
+
+static Timespec
+ts_at (time64 secs)
+{
+    Timespec ts = {secs, 0};
+    return ts;
+}
+
+static void
+check_price_order (Fixture *fixture, guint expected)
+{
+    PriceList *prices = gnc_pricedb_get_prices (fixture->db,
+                        fixture->commodity,
+                        fixture->currency);
+    GList *node;
+    Timespec last = {G_MAXINT64, 0};
+
+    g_assert_cmpint (g_list_length (prices), ==, expected);
+    for (node = prices; node; node = node->next)
+    {
+        Timespec t = gnc_price_get_time (node->data);
+        g_assert (timespec_cmp (&t, &last) <= 0);
+        last = t;
+    }
+    gnc_price_list_destroy (prices);
+}
+
+/* Prices one day apart, added out of order. */
+static const time64 day = 86400;
+static const time64 base = 1388577600; /* 2014-01-01 12:00 UTC */
+
+static void
+test_gnc_pricedb_lookups (Fixture *fixture, gconstpointer pData)
+{
+    GNCPrice *p1 = add_price (fixture, base + 2 * day, 300);
+    GNCPrice *p0 = add_price (fixture, base, 100);
+    GNCPrice *p3 = add_price (fixture, base + 6 * day, 700);
+    GNCPrice *p2 = add_price (fixture, base + 4 * day, 500);
+    GNCPrice *p;
+    PriceList *prices;
+
+    check_price_order (fixture, 4);
+
+    p = gnc_pricedb_lookup_latest (fixture->db, fixture->commodity,
+                                   fixture->currency);
+    g_assert (p == p3);
+    gnc_price_unref (p);
+
+    p = gnc_pricedb_lookup_latest_before (fixture->db, fixture->commodity,
+                                          fixture->currency,
+                                          ts_at (base + 3 * day));
+    g_assert (p == p1);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_latest_before (fixture->db, fixture->commodity,
+                                          fixture->currency,
+                                          ts_at (base + 4 * day));
+    g_assert (p == p2);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_latest_before (fixture->db, fixture->commodity,
+                                          fixture->currency,
+                                          ts_at (base - day));
+    g_assert (p == NULL);
+
+    /* Before the first and after the last price. */
+    p = gnc_pricedb_lookup_nearest_in_time (fixture->db, fixture->commodity,
+                                            fixture->currency,
+                                            ts_at (base - 10 * day));
+    g_assert (p == p0);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_nearest_in_time (fixture->db, fixture->commodity,
+                                            fixture->currency,
+                                            ts_at (base + 10 * day));
+    g_assert (p == p3);
+    gnc_price_unref (p);
+    /* Closer to the later price, and a tie which picks the older one. */
+    p = gnc_pricedb_lookup_nearest_in_time (fixture->db, fixture->commodity,
+                                            fixture->currency,
+                                            ts_at (base + 3 * day + 1));
+    g_assert (p == p2);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_nearest_in_time (fixture->db, fixture->commodity,
+                                            fixture->currency,
+                                            ts_at (base + 3 * day));
+    g_assert (p == p1);
+    gnc_price_unref (p);
+
+    p = gnc_pricedb_lookup_day (fixture->db, fixture->commodity,
+                                fixture->currency, ts_at (base + 2 * day));
+    g_assert (p == p1);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_day (fixture->db, fixture->commodity,
+                                fixture->currency, ts_at (base + 3 * day));
+    g_assert (p == NULL);
+
+    prices = gnc_pricedb_lookup_at_time (fixture->db, fixture->commodity,
+                                         fixture->currency,
+                                         ts_at (base + 4 * day));
+    g_assert_cmpint (g_list_length (prices), ==, 1);
+    g_assert (prices->data == p2);
+    gnc_price_list_destroy (prices);
+    prices = gnc_pricedb_lookup_at_time (fixture->db, fixture->commodity,
+                                         fixture->currency,
+                                         ts_at (base + 5 * day));
+    g_assert (prices == NULL);
+
+    g_assert (gnc_pricedb_remove_price (fixture->db, p2));
+    check_price_order (fixture, 3);
+    p = gnc_pricedb_lookup_latest_before (fixture->db, fixture->commodity,
+                                          fixture->currency,
+                                          ts_at (base + 5 * day));
+    g_assert (p == p1);
+    gnc_price_unref (p);
+}
+
+static void
+test_gnc_pricedb_add_duplicate (Fixture *fixture, gconstpointer pData)
+{
+    add_price (fixture, base, 100);
+    add_price (fixture, base + day, 200);
+    /* Same day and value as an existing price */
+    add_price (fixture, base + 60, 100);
+    check_price_order (fixture, 2);
+    /* Same day, different value */
+    add_price (fixture, base + 60, 150);
+    check_price_order (fixture, 3);
+}
+
+static void
+test_gnc_pricedb_bulk_update (Fixture *fixture, gconstpointer pData)
+{
+    GNCPrice *p;
+    gint i;
+
+    gnc_pricedb_set_bulk_update (fixture->db, TRUE);
+    /* Out of order, and with a duplicate which bulk loads keep. */
+    for (i = 0; i < 10; i++)
+        add_price (fixture, base + ((i * 7) % 10) * day, 100 + i);
+    add_price (fixture, base, 100);
+    gnc_pricedb_set_bulk_update (fixture->db, FALSE);
+
+    check_price_order (fixture, 11);
+    p = gnc_pricedb_lookup_latest (fixture->db, fixture->commodity,
+                                   fixture->currency);
+    g_assert_cmpint (p->tmspec.tv_sec, ==, base + 9 * day);
+    gnc_price_unref (p);
+    p = gnc_pricedb_lookup_latest_before (fixture->db, fixture->commodity,
+                                          fixture->currency,
+                                          ts_at (base + 5 * day + 1));
+    g_assert_cmpint (p->tmspec.tv_sec, ==, base + 5 * day);
+    gnc_price_unref (p);
+}
+
+static GNCPrice *
+add_pair_price (Fixture *fixture, gnc_commodity *commodity,
+                gnc_commodity *currency, time64 secs, gint64 num, gint64 denom)
+{
+    GNCPrice *p = gnc_price_create (fixture->book);
+    Timespec ts = {secs, 0};
+
+    gnc_price_begin_edit (p);
+    gnc_price_set_commodity (p, commodity);
+    gnc_price_set_currency (p, currency);
+    gnc_price_set_time (p, ts);
+    gnc_price_set_value (p, gnc_numeric_create (num, denom));
+    gnc_price_commit_edit (p);
+    g_assert (gnc_pricedb_add_price (fixture->db, p));
+    gnc_price_unref (p);
+    return p;
+}
+
+static void
+test_gnc_pricedb_convert_balance (Fixture *fixture, gconstpointer pData)
+{
+    gnc_commodity *eur = gnc_commodity_new (fixture->book, "Euro",
+                                            "CURRENCY", "EUR", "", 100);
+    gnc_commodity *gbp = gnc_commodity_new (fixture->book, "Pound Sterling",
+                                            "CURRENCY", "GBP", "", 100);
+    gnc_commodity *chf = gnc_commodity_new (fixture->book, "Swiss Franc",
+                                            "CURRENCY", "CHF", "", 100);
+    gnc_numeric hundred = gnc_numeric_create (10000, 100);
+    gnc_numeric result;
+    GNCPrice *p;
+
+    /* FOO in USD, EUR in USD, GBP in EUR; nothing for CHF. */
+    add_pair_price (fixture, fixture->commodity, fixture->currency,
+                    base, 2, 1);
+    add_pair_price (fixture, eur, fixture->currency, base, 5, 4);
+    add_pair_price (fixture, gbp, eur, base, 6, 5);
+
+    /* Direct and reciprocal. */
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             fixture->commodity,
+             fixture->currency);
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (20000, 100)));
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             fixture->currency, eur);
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (8000, 100)));
+
+    /* Two and three steps, through USD and EUR. */
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             fixture->commodity, eur);
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (16000, 100)));
+    result = gnc_pricedb_convert_balance_nearest_price (fixture->db, hundred,
+             fixture->commodity, gbp,
+             ts_at (base));
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (13333, 100)));
+
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             fixture->commodity, chf);
+    g_assert (gnc_numeric_zero_p (result));
+
+    /* The memoized rates must follow changes to the prices. */
+    add_pair_price (fixture, chf, gbp, base, 2, 1);
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             chf, gbp);
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (20000, 100)));
+    p = gnc_pricedb_lookup_latest (fixture->db, chf, gbp);
+    gnc_price_set_value (p, gnc_numeric_create (3, 1));
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             chf, gbp);
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (30000, 100)));
+    g_assert (gnc_pricedb_remove_price (fixture->db, p));
+    gnc_price_unref (p);
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             chf, gbp);
+    g_assert (gnc_numeric_zero_p (result));
+
+    /* A later direct price is preferred over the older path. */
+    add_pair_price (fixture, fixture->commodity, eur, base + day, 3, 2);
+    result = gnc_pricedb_convert_balance_latest_price (fixture->db, hundred,
+             fixture->commodity, eur);
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (15000, 100)));
+
+    /* Conversions on the same day use the price nearest to their own
+     * time, not one shared rate for the day. */
+    add_pair_price (fixture, fixture->commodity, eur, base + day + 6 * 3600,
+                    2, 1);
+    result = gnc_pricedb_convert_balance_nearest_price (fixture->db, hundred,
+             fixture->commodity, eur,
+             ts_at (base + day + 60));
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (15000, 100)));
+    result = gnc_pricedb_convert_balance_nearest_price (fixture->db, hundred,
+             fixture->commodity, eur,
+             ts_at (base + day + 6 * 3600 - 60));
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (20000, 100)));
+    result = gnc_pricedb_convert_balance_nearest_price (fixture->db, hundred,
+             fixture->commodity, eur,
+             ts_at (base + day + 60));
+    g_assert (gnc_numeric_equal (result, gnc_numeric_create (15000, 100)));
+
+    gnc_commodity_destroy (eur);
+    gnc_commodity_destroy (gbp);
+    gnc_commodity_destroy (chf);
+}
+
+static void
+test_gnc_pricedb_lookup_perf (Fixture *fixture, gconstpointer pData)
+{
+    const gint num_prices = 20000;
+    GNCPrice *p;
+    gint i;
+
+    if (!g_test_perf ())
+        return;
+
+    gnc_pricedb_set_bulk_update (fixture->db, TRUE);
+    for (i = num_prices - 1; i >= 0; i--)
+        add_price (fixture, base + i * day, 100 + i);
+    gnc_pricedb_set_bulk_update (fixture->db, FALSE);
+
+    g_test_timer_start ();
+    for (i = 0; i < num_prices; i++)
+    {
+        p = gnc_pricedb_lookup_nearest_in_time (fixture->db,
+                                                fixture->commodity,
+                                                fixture->currency,
+                                                ts_at (base + i * day + 1));
+        g_assert_cmpint (p->tmspec.tv_sec, ==, base + i * day);
+        gnc_price_unref (p);
+    }
+    g_test_minimized_result (g_test_timer_elapsed (),
+                             "%d nearest-in-time lookups", num_prices);
+}
+
+void
+test_suite_gnc_pricedb (void)
+{
+    GNC_TEST_ADD (suitename, "gnc pricedb lookups", Fixture, NULL, setup, test_gnc_pricedb_lookups, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb add duplicate", Fixture, NULL, setup, test_gnc_pricedb_add_duplicate, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb bulk update", Fixture, NULL, setup, test_gnc_pricedb_bulk_update, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert balance", Fixture, NULL, setup, test_gnc_pricedb_convert_balance, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup perf", Fixture, NULL, setup, test_gnc_pricedb_lookup_perf, teardown);
+}
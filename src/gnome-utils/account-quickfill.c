@@ -163,6 +163,7 @@ static QFB *
 build_shared_quickfill (QofBook *book, Account *root, const char * key,
                         AccountBoolCB cb, gpointer data)
 {
+    static const QofIdTypeConst account_types[] = { GNC_ID_ACCOUNT, NULL };
     QFB *qfb;
 
     qfb = g_new0(QFB, 1);
@@ -190,7 +191,9 @@ build_shared_quickfill (QofBook *book, Account *root, const char * key,
     qfb->load_list_store = FALSE;
 
     qfb->listener =
-        qof_event_register_handler (listen_for_account_events, qfb);
+        qof_event_register_filtered_handler (listen_for_account_events, qfb,
+                QOF_EVENT_MODIFY | QOF_EVENT_ADD | QOF_EVENT_REMOVE,
+                account_types);
 
     qof_book_set_data_fin (book, key, qfb, shared_quickfill_destroy);
 
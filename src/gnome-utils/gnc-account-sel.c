@@ -144,6 +144,7 @@ combo_changed_cb(GNCAccountSel *gas, gpointer combo)
 static void
 gnc_account_sel_init (GNCAccountSel *gas)
 {
+    static const QofIdTypeConst account_types[] = { GNC_ID_ACCOUNT, NULL };
     GtkWidget *widget;
 
     gas->initDone = FALSE;
@@ -168,7 +169,9 @@ gnc_account_sel_init (GNCAccountSel *gas)
     gas_populate_list( gas );
 
     gas->eventHandlerId =
-        qof_event_register_handler( gnc_account_sel_event_cb, gas );
+        qof_event_register_filtered_handler( gnc_account_sel_event_cb, gas,
+                QOF_EVENT_CREATE | QOF_EVENT_MODIFY | QOF_EVENT_DESTROY,
+                account_types );
 
     gas->initDone = TRUE;
 }
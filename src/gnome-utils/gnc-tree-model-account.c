@@ -272,6 +272,7 @@ gnc_tree_model_account_dispose (GObject *object)
 GtkTreeModel *
 gnc_tree_model_account_new (Account *root)
 {
+    static const QofIdTypeConst account_types[] = { GNC_ID_ACCOUNT, NULL };
     GncTreeModelAccount *model;
     GncTreeModelAccountPrivate *priv;
     const GList *item;
@@ -297,8 +298,10 @@ gnc_tree_model_account_new (Account *root)
     priv->book = gnc_get_current_book();
     priv->root = root;
 
-    priv->event_handler_id = qof_event_register_handler
-                             ((QofEventHandler)gnc_tree_model_account_event_handler, model);
+    priv->event_handler_id = qof_event_register_filtered_handler
+                             ((QofEventHandler)gnc_tree_model_account_event_handler, model,
+                              QOF_EVENT_ADD | QOF_EVENT_REMOVE | QOF_EVENT_MODIFY,
+                              account_types);
 
     LEAVE("model %p", model);
     return GTK_TREE_MODEL (model);
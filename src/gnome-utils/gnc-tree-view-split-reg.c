@@ -4822,7 +4822,7 @@ gtv_sr_edited_template_cb (GtkCellRendererText *cell, const gchar *path_string,
                 }
 
                 acctGUID = xaccAccountGetGUID (acct);
-                kvpf = xaccSplitGetSlots (split);
+                kvpf = xaccSplitGetSlotsForEdit (split);
                 kvp_frame_set_slot_path (kvpf, kvp_value_new_guid (acctGUID),
                              GNC_SX_ID, GNC_SX_ACCOUNT, NULL);
 
@@ -4849,7 +4849,7 @@ gtv_sr_edited_template_cb (GtkCellRendererText *cell, const gchar *path_string,
                 gnc_numeric new_value;
                 gboolean parse_result;
 
-                kvpf = xaccSplitGetSlots (split);
+                kvpf = xaccSplitGetSlotsForEdit (split);
 
                 DEBUG ("kvp_frame debit before: %s\n", kvp_frame_to_string (kvpf));
 
@@ -4894,7 +4894,7 @@ gtv_sr_edited_template_cb (GtkCellRendererText *cell, const gchar *path_string,
                 gnc_numeric new_value;
                 gboolean parse_result;
 
-                kvpf = xaccSplitGetSlots (split);
+                kvpf = xaccSplitGetSlotsForEdit (split);
 
                 DEBUG ("kvp_frame credit before: %s\n", kvp_frame_to_string (kvpf));
 
@@ -1518,6 +1518,7 @@ gnc_split_reg_jump_to_split(GNCSplitReg *gsr, Split *split)
     gsr_emit_include_date_signal( gsr, xaccTransGetDate(trans) );
 
     reg = gnc_ledger_display_get_split_register( gsr->ledger );
+    gnc_split_register_include_split (reg, split);
 
     if (gnc_split_register_get_split_virt_loc(reg, split, &vcell_loc))
         gnucash_register_goto_virt_cell( gsr->reg, vcell_loc );
@@ -1542,6 +1543,7 @@ gnc_split_reg_jump_to_split_amount(GNCSplitReg *gsr, Split *split)
     gsr_emit_include_date_signal( gsr, xaccTransGetDate(trans) );
 
     reg = gnc_ledger_display_get_split_register (gsr->ledger);
+    gnc_split_register_include_split (reg, split);
 
     if (gnc_split_register_get_split_amount_virt_loc (reg, split, &virt_loc))
         gnucash_register_goto_virt_loc (gsr->reg, virt_loc);
@@ -40,6 +40,7 @@
 #include "Account.h"
 #include "Query.h"
 #include "gnc-engine.h"
+#include "gnc-event.h"
 #include "engine-helpers.h"
 #include "gnc-prefs.h"
 #include "gnc-ui-util.h"
@@ -825,18 +826,8 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
                                  TRUE, download_time + match_date_hardlimit * 86400,
                                  QOF_QUERY_AND);
         list_element = qof_query_run (query);
-        /* Sigh. Doesnt help too much. We still create and run one query
-           for each imported transaction. Maybe it would improve
-           performance further if there is one single (master-)query at
-           the beginning, matching the full date range and all accounts in
-           question. However, this doesnt quite work because this function
-           here is called from each gnc_gen_trans_list_add_trans(), which
-           is called one at a time. Therefore the whole importer would
-           have to change its behaviour: Accept the imported txns via
-           gnc_gen_trans_list_add_trans(), and only when
-           gnc_gen_trans_list_run() is called, then calculate all the
-           different match candidates. That's too much work for now.
-        */
+        /* This still runs one query for each imported transaction; use
+           gnc_import_find_split_matches_list() to match many of them. */
     }
 
     /* Traverse that list, calling split_find_match on each one. Note
@@ -853,6 +844,149 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
 }
 
 
+/* The splits of one account that batch matching compares against, with
+ * the transactions imported into that account. */
+typedef struct
+{
+    Account *account;
+    GList *trans_infos;
+    time64 first;
+    time64 last;
+} account_match_batch;
+
+typedef struct
+{
+    gint process_threshold;
+    double fuzzy_amount_difference;
+    gint match_date_hardlimit;
+} match_params;
+
+static void
+account_match_batch_free (gpointer data)
+{
+    account_match_batch *batch = data;
+    g_list_free (batch->trans_infos);
+    g_free (batch);
+}
+
+/* Returns the index of the first split in splits posted no earlier than
+ * ts.  The splits are sorted by date posted. */
+static guint
+first_split_posted_from (GPtrArray *splits, Timespec ts)
+{
+    guint lo = 0, hi = splits->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        Split *split = g_ptr_array_index (splits, mid);
+        Timespec posted =
+            xaccTransRetDatePostedTS (xaccSplitGetParent (split));
+
+        if (timespec_cmp (&posted, &ts) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void
+account_batch_find_matches (gpointer key, gpointer value, gpointer user_data)
+{
+    account_match_batch *batch = value;
+    match_params *params = user_data;
+    gint match_date_hardlimit = params->match_date_hardlimit;
+    Query *query = qof_query_create_for (GNC_ID_SPLIT);
+    GPtrArray *splits;
+    GList *node;
+
+    /* One query for every transaction imported into this account, over
+       the union of their date ranges. Split queries sort by date posted
+       first, so each transaction's own range is a contiguous run of the
+       result, in the same order as its own query would have returned. */
+    qof_query_set_book (query, gnc_get_current_book ());
+    xaccQueryAddSingleAccountMatch (query, batch->account, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (query,
+                             TRUE, batch->first - match_date_hardlimit * 86400,
+                             TRUE, batch->last + match_date_hardlimit * 86400,
+                             QOF_QUERY_AND);
+    splits = g_ptr_array_new ();
+    for (node = qof_query_run (query); node; node = node->next)
+        g_ptr_array_add (splits, node->data);
+
+    for (node = batch->trans_infos; node; node = node->next)
+    {
+        GNCImportTransInfo *trans_info = node->data;
+        time64 download_time =
+            xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+        Timespec from = { download_time - match_date_hardlimit * 86400, 0 };
+        Timespec to = { download_time + match_date_hardlimit * 86400, 0 };
+        guint i;
+
+        for (i = first_split_posted_from (splits, from); i < splits->len; i++)
+        {
+            Split *split = g_ptr_array_index (splits, i);
+            Timespec posted =
+                xaccTransRetDatePostedTS (xaccSplitGetParent (split));
+
+            if (timespec_cmp (&posted, &to) > 0)
+                break;
+            split_find_match (trans_info, split, params->process_threshold,
+                              params->fuzzy_amount_difference);
+        }
+    }
+
+    g_ptr_array_free (splits, TRUE);
+    qof_query_destroy (query);
+}
+
+/** /brief Find the split matches of all the given transactions at once.
+   This gives the same matches as calling gnc_import_find_split_matches()
+   on each of them, but runs one query per originating account instead of
+   one per transaction. */
+void gnc_import_find_split_matches_list (GList *trans_info_list,
+                                         gint process_threshold,
+                                         double fuzzy_amount_difference,
+                                         gint match_date_hardlimit)
+{
+    GHashTable *batches = g_hash_table_new_full (g_direct_hash,
+                          g_direct_equal,
+                          NULL,
+                          account_match_batch_free);
+    match_params params;
+    GList *node;
+
+    for (node = trans_info_list; node; node = node->next)
+    {
+        GNCImportTransInfo *trans_info = node->data;
+        Account *importaccount =
+            xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (trans_info));
+        time64 download_time =
+            xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+        account_match_batch *batch =
+            g_hash_table_lookup (batches, importaccount);
+
+        if (!batch)
+        {
+            batch = g_new0 (account_match_batch, 1);
+            batch->account = importaccount;
+            batch->first = batch->last = download_time;
+            g_hash_table_insert (batches, importaccount, batch);
+        }
+        batch->first = MIN (batch->first, download_time);
+        batch->last = MAX (batch->last, download_time);
+        batch->trans_infos = g_list_prepend (batch->trans_infos, trans_info);
+    }
+
+    params.process_threshold = process_threshold;
+    params.fuzzy_amount_difference = fuzzy_amount_difference;
+    params.match_date_hardlimit = match_date_hardlimit;
+    g_hash_table_foreach (batches, account_batch_find_matches, &params);
+    g_hash_table_destroy (batches);
+}
+
+
 /***********************************************************************
  */
 
@@ -1071,46 +1205,191 @@ gnc_import_process_trans_item (GncImportMatchMap *matchmap,
 }
 
 /********************************************************************\
- * check_trans_online_id() Callback function used by
- * gnc_import_exists_online_id.  Takes pointers to transaction and split,
- * returns 0 if their online_id kvp_frames do NOT match, or if the split
- * belongs to the transaction
+ * Online_id index.
+ *
+ * Every account the importer has checked for duplicates carries an
+ * index from online_id to the splits having it, attached as object
+ * data so that it goes away with the account.  It is built on first
+ * use by one pass over the account's splits and then kept current from
+ * the engine events, so checking an imported transaction no longer
+ * walks the account history.  Events dropped while they were suspended,
+ * as during backend loads and queries, may have changed the account
+ * unseen, so the index is built again on its next use after any.
+ *
+ * Only the first split of a transaction in the account is indexed, and
+ * its online_id is the split's own one or else the transaction's, the
+ * same rule the importer has always used for comparing.
 \********************************************************************/
-static gint check_trans_online_id(Transaction *trans1, void *user_data)
+#define ONLINE_ID_INDEX "import-online-id-index"
+
+typedef struct
 {
-    Account *account;
-    Split *split1;
-    Split *split2 = user_data;
-    const gchar *online_id1;
-    const gchar *online_id2;
-
-    account = xaccSplitGetAccount(split2);
-    split1 = xaccTransFindSplitByAccount(trans1, account);
-    if (split1 == split2)
-        return 0;
+    GHashTable *by_id;          /* online_id -> GQueue of Split* */
+    GHashTable *by_split;       /* Split* -> online_id (key of by_id) */
+    guint64 dropped_events;     /* qof_event_get_dropped_count when built */
+} OnlineIdIndex;
 
-    /* hack - we really want to iterate over the _splits_ of the account
-       instead of the transactions */
-    g_assert(split1 != NULL);
+/* The event handler is registered while any account has an index. */
+static gint online_id_index_handler_id = 0;
+static guint online_id_index_count = 0;
 
-    if (gnc_import_split_has_online_id(split1))
-        online_id1 = gnc_import_get_split_online_id(split1);
-    else
-        online_id1 = gnc_import_get_trans_online_id(trans1);
+static void
+online_id_index_free (gpointer data)
+{
+    OnlineIdIndex *index = data;
 
-    online_id2 = gnc_import_get_split_online_id(split2);
+    g_hash_table_destroy (index->by_split);
+    g_hash_table_destroy (index->by_id);
+    g_free (index);
 
-    if ((online_id1 == NULL) ||
-            (online_id2 == NULL) ||
-            (strcmp(online_id1, online_id2) != 0))
+    if (--online_id_index_count == 0 && online_id_index_handler_id != 0)
     {
-        return 0;
+        qof_event_unregister_handler (online_id_index_handler_id);
+        online_id_index_handler_id = 0;
     }
+}
+
+static void
+online_id_index_add (OnlineIdIndex *index, Split *split, Account *account)
+{
+    Transaction *trans = xaccSplitGetParent (split);
+    const gchar *online_id;
+    gchar *key;
+    GQueue *splits;
+
+    if (!trans || xaccTransFindSplitByAccount (trans, account) != split)
+        return;
+
+    if (gnc_import_split_has_online_id (split))
+        online_id = gnc_import_get_split_online_id (split);
     else
+        online_id = gnc_import_get_trans_online_id (trans);
+    if (online_id == NULL)
+        return;
+
+    if (!g_hash_table_lookup_extended (index->by_id, online_id,
+                                       (gpointer *)&key, (gpointer *)&splits))
+    {
+        key = g_strdup (online_id);
+        splits = g_queue_new ();
+        g_hash_table_insert (index->by_id, key, splits);
+    }
+    g_queue_push_tail (splits, split);
+    g_hash_table_insert (index->by_split, split, key);
+}
+
+static void
+online_id_index_remove (OnlineIdIndex *index, Split *split)
+{
+    gchar *key = g_hash_table_lookup (index->by_split, split);
+    GQueue *splits;
+
+    if (key == NULL)
+        return;
+
+    g_hash_table_remove (index->by_split, split);
+    splits = g_hash_table_lookup (index->by_id, key);
+    g_queue_remove (splits, split);
+    if (g_queue_is_empty (splits))
+        g_hash_table_remove (index->by_id, key);
+}
+
+/* Splits leaving an account are dropped when the account says so; the
+ * remaining changes (new splits, changed online_ids) all end in the
+ * commit of their transaction, when its splits are indexed again. */
+static void
+online_id_index_event_handler (QofInstance *entity, QofEventId event_type,
+                               gpointer handler_data, gpointer event_data)
+{
+    OnlineIdIndex *index;
+    GList *node;
+
+    if (GNC_IS_ACCOUNT (entity))
+    {
+        index = g_object_get_data (G_OBJECT (entity), ONLINE_ID_INDEX);
+        if (index == NULL)
+            return;
+
+        if (event_type & GNC_EVENT_ITEM_REMOVED)
+            online_id_index_remove (index, event_data);
+        else if (event_type & QOF_EVENT_DESTROY)
+            g_object_set_data (G_OBJECT (entity), ONLINE_ID_INDEX, NULL);
+    }
+    else if (GNC_IS_TRANS (entity) && (event_type & QOF_EVENT_MODIFY))
+    {
+        Transaction *trans = GNC_TRANS (entity);
+
+        if (xaccTransIsOpen (trans))
+            return;
+
+        for (node = xaccTransGetSplitList (trans); node; node = node->next)
+        {
+            Split *split = node->data;
+            Account *account = xaccSplitGetAccount (split);
+
+            if (account == NULL)
+                continue;
+            index = g_object_get_data (G_OBJECT (account), ONLINE_ID_INDEX);
+            if (index == NULL)
+                continue;
+
+            online_id_index_remove (index, split);
+            online_id_index_add (index, split, account);
+        }
+    }
+}
+
+static void
+online_id_index_fill (OnlineIdIndex *index, Account *account)
+{
+    GList *node;
+
+    index->dropped_events = qof_event_get_dropped_count ();
+    for (node = xaccAccountGetSplitList (account); node; node = node->next)
+        online_id_index_add (index, node->data, account);
+    DEBUG ("Indexed %u online_ids of account %s",
+           g_hash_table_size (index->by_id), xaccAccountGetName (account));
+}
+
+static OnlineIdIndex *
+online_id_index_get (Account *account)
+{
+    OnlineIdIndex *index;
+
+    index = g_object_get_data (G_OBJECT (account), ONLINE_ID_INDEX);
+    if (index)
+    {
+        if (index->dropped_events == qof_event_get_dropped_count ())
+            return index;
+        DEBUG ("Events were dropped, reindexing account %s",
+               xaccAccountGetName (account));
+        g_hash_table_remove_all (index->by_split);
+        g_hash_table_remove_all (index->by_id);
+        online_id_index_fill (index, account);
+        return index;
+    }
+
+    if (online_id_index_handler_id == 0)
     {
-        /*printf("test_trans_online_id(): Duplicate found\n");*/
-        return 1;
+        static const QofIdTypeConst types[] = { GNC_ID_ACCOUNT, GNC_ID_TRANS,
+                                                NULL
+                                              };
+        online_id_index_handler_id =
+            qof_event_register_filtered_handler (online_id_index_event_handler,
+                    NULL, GNC_EVENT_ITEM_REMOVED | QOF_EVENT_DESTROY |
+                    QOF_EVENT_MODIFY, types);
     }
+
+    index = g_new0 (OnlineIdIndex, 1);
+    online_id_index_count++;
+    index->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                          (GDestroyNotify) g_queue_free);
+    index->by_split = g_hash_table_new (g_direct_hash, g_direct_equal);
+    online_id_index_fill (index, account);
+
+    g_object_set_data_full (G_OBJECT (account), ONLINE_ID_INDEX, index,
+                            online_id_index_free);
+    return index;
 }
 
 /** Checks whether the given transaction's online_id already exists in
@@ -1120,6 +1399,9 @@ gboolean gnc_import_exists_online_id (Transaction *trans)
     gboolean online_id_exists = FALSE;
     Account *dest_acct;
     Split *source_split;
+    const gchar *online_id;
+    GQueue *splits;
+    GList *node;
 
     /* Look for an online_id in the first split */
     source_split = xaccTransGetSplit(trans, 0);
@@ -1127,9 +1409,20 @@ gboolean gnc_import_exists_online_id (Transaction *trans)
 
     /* DEBUG("%s%d%s","Checking split ",i," for duplicates"); */
     dest_acct = xaccSplitGetAccount(source_split);
-    online_id_exists = xaccAccountForEachTransaction(dest_acct,
-                       check_trans_online_id,
-                       source_split);
+    online_id = gnc_import_get_split_online_id(source_split);
+    if (dest_acct && online_id)
+    {
+        splits = g_hash_table_lookup (online_id_index_get (dest_acct)->by_id,
+                                      online_id);
+        for (node = splits ? splits->head : NULL; node; node = node->next)
+        {
+            if (node->data != source_split)
+            {
+                online_id_exists = TRUE;
+                break;
+            }
+        }
+    }
 
     /* If it does, abort the process for this transaction, since it is
        already in the system. */
@@ -1179,23 +1472,13 @@ static gint compare_probability (gconstpointer a,
            ((GNCImportMatchInfo *)a)->probability);
 }
 
-/** Iterates through all splits of the originating account of
- * trans_info. Sorts the resulting list and sets the selected_match
- * and action fields in the trans_info.
- */
-void
-gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
-                                   GNCImportSettings *settings)
+/* Sorts the matches found for trans_info and sets its selected_match
+ * and action fields from them. */
+static void
+trans_info_select_match (GNCImportTransInfo *trans_info,
+                         GNCImportSettings *settings)
 {
     GNCImportMatchInfo * best_match = NULL;
-    g_assert (trans_info);
-
-
-    /* Find all split matches in originating account. */
-    gnc_import_find_split_matches(trans_info,
-                                  gnc_import_Settings_get_display_threshold (settings),
-                                  gnc_import_Settings_get_fuzzy_amount (settings),
-                                  gnc_import_Settings_get_match_date_hardlimit (settings));
 
     if (trans_info->match_list != NULL)
     {
@@ -1246,6 +1529,41 @@ gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
     trans_info->previous_action = trans_info->action;
 }
 
+/** Iterates through all splits of the originating account of
+ * trans_info. Sorts the resulting list and sets the selected_match
+ * and action fields in the trans_info.
+ */
+void
+gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
+                                   GNCImportSettings *settings)
+{
+    g_assert (trans_info);
+
+
+    /* Find all split matches in originating account. */
+    gnc_import_find_split_matches(trans_info,
+                                  gnc_import_Settings_get_display_threshold (settings),
+                                  gnc_import_Settings_get_fuzzy_amount (settings),
+                                  gnc_import_Settings_get_match_date_hardlimit (settings));
+
+    trans_info_select_match (trans_info, settings);
+}
+
+void
+gnc_import_TransInfo_init_matches_list (GList *trans_info_list,
+                                        GNCImportSettings *settings)
+{
+    GList *node;
+
+    gnc_import_find_split_matches_list (trans_info_list,
+                                        gnc_import_Settings_get_display_threshold (settings),
+                                        gnc_import_Settings_get_fuzzy_amount (settings),
+                                        gnc_import_Settings_get_match_date_hardlimit (settings));
+
+    for (node = trans_info_list; node; node = node->next)
+        trans_info_select_match (node->data, settings);
+}
+
 
 /* Try to automatch a transaction to a destination account if the */
 /* transaction hasn't already been manually assigned to another account */
@@ -55,6 +55,10 @@ typedef enum _action
  * editing. If a matching online_id exists, the transaction is
  * destroyed (!) and TRUE is returned, otherwise FALSE is returned.
  *
+ * The online_ids of the account are looked up in an index that is
+ * built on the first call for that account and then kept up to date
+ * from the engine events.
+ *
  * @param trans The transaction for which to check for an existing
  * online_id. */
 gboolean gnc_import_exists_online_id (Transaction *trans);
@@ -88,6 +92,16 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
                                    double fuzzy_amount_difference,
                                    gint match_date_hardlimit);
 
+/** Like gnc_import_find_split_matches(), for every GNCImportTransInfo in
+ * trans_info_list. Runs a single query per originating account over the
+ * dates of all the transactions imported into it, instead of one query
+ * per transaction, and gives the same matches.
+ */
+void gnc_import_find_split_matches_list(GList *trans_info_list,
+                                        gint process_threshold,
+                                        double fuzzy_amount_difference,
+                                        gint match_date_hardlimit);
+
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
  * and action fields in the trans_info.
@@ -101,6 +115,13 @@ void
 gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
                                    GNCImportSettings *settings);
 
+/** Like gnc_import_TransInfo_init_matches(), for every GNCImportTransInfo
+ * in trans_info_list, using gnc_import_find_split_matches_list().
+ */
+void
+gnc_import_TransInfo_init_matches_list (GList *trans_info_list,
+                                        GNCImportSettings *settings);
+
 /** This function is intended to be called when the importer dialog is
  * finished. It should be called once for each imported transaction
  * and processes each ImportTransInfo according to its selected action:
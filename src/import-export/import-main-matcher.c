@@ -64,6 +64,8 @@ struct _main_matcher_info
     int selected_row;
     GNCTransactionProcessedCB transaction_processed_cb;
     gpointer user_data;
+    GList *pending;             /* GNCImportTransInfo not yet matched/shown */
+    guint pending_id;           /* idle source matching the pending list */
 };
 
 enum downloaded_cols
@@ -103,16 +105,35 @@ automatch_store_transactions(GNCImportMainMatcher *info,
 static void
 refresh_model_row(GNCImportMainMatcher *gui, GtkTreeModel *model,
                   GtkTreeIter *iter, GNCImportTransInfo *info);
+static void
+process_pending_matches (GNCImportMainMatcher *gui);
 
 void gnc_gen_trans_list_delete (GNCImportMainMatcher *info)
 {
     GtkTreeModel *model;
     GtkTreeIter iter;
     GNCImportTransInfo *trans_info;
+    GList *node;
 
     if (info == NULL)
         return;
 
+    if (info->pending_id)
+        g_source_remove (info->pending_id);
+    for (node = info->pending; node; node = node->next)
+    {
+        if (info->transaction_processed_cb)
+        {
+            info->transaction_processed_cb(node->data,
+                                           FALSE,
+                                           info->user_data);
+        }
+        gnc_import_TransInfo_delete(node->data);
+    }
+    g_list_free (info->pending);
+    info->pending = NULL;
+    info->pending_id = 0;
+
     model = gtk_tree_view_get_model(info->view);
     if (gtk_tree_model_get_iter_first(model, &iter))
     {
@@ -161,6 +182,7 @@ on_matcher_ok_clicked (GtkButton *button,
 
     /*   DEBUG ("Begin") */
 
+    process_pending_matches (info);
     model = gtk_tree_view_get_model(info->view);
     if (!gtk_tree_model_get_iter_first(model, &iter))
         return;
@@ -168,6 +190,7 @@ on_matcher_ok_clicked (GtkButton *button,
     /* Don't run any queries and/or split sorts while processing the matcher
     results. */
     gnc_suspend_gui_refresh();
+    qof_event_begin_batch();
 
     do
     {
@@ -193,6 +216,7 @@ on_matcher_ok_clicked (GtkButton *button,
     while (gtk_tree_model_iter_next (model, &iter));
 
     /* Allow GUI refresh again. */
+    qof_event_end_batch();
     gnc_resume_gui_refresh();
 
     gnc_gen_trans_list_delete (info);
@@ -668,6 +692,7 @@ gboolean gnc_gen_trans_list_run (GNCImportMainMatcher *info)
     gboolean result;
 
     /* DEBUG("Begin"); */
+    process_pending_matches (info);
     result = gtk_dialog_run (GTK_DIALOG (info->dialog));
     /* DEBUG("Result was %d", result); */
 
@@ -890,6 +915,47 @@ refresh_model_row (GNCImportMainMatcher *gui,
     gtk_tree_selection_unselect_all(selection);
 }
 
+/* Find the matches of all transactions added since the last call in one
+   pass (see gnc_import_TransInfo_init_matches_list) and append their rows
+   to the view in the order they were added. */
+static void
+process_pending_matches (GNCImportMainMatcher *gui)
+{
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    GList *node;
+
+    if (gui->pending_id)
+    {
+        g_source_remove (gui->pending_id);
+        gui->pending_id = 0;
+    }
+    if (gui->pending == NULL)
+        return;
+
+    gui->pending = g_list_reverse (gui->pending);
+    gnc_import_TransInfo_init_matches_list (gui->pending, gui->user_settings);
+
+    model = gtk_tree_view_get_model(gui->view);
+    for (node = gui->pending; node; node = node->next)
+    {
+        gtk_list_store_append(GTK_LIST_STORE(model), &iter);
+        refresh_model_row (gui, model, &iter, node->data);
+    }
+    g_list_free (gui->pending);
+    gui->pending = NULL;
+}
+
+static gboolean
+process_pending_matches_idle (gpointer user_data)
+{
+    GNCImportMainMatcher *gui = user_data;
+
+    gui->pending_id = 0;
+    process_pending_matches (gui);
+    return FALSE;
+}
+
 void gnc_gen_trans_list_add_trans(GNCImportMainMatcher *gui, Transaction *trans)
 {
     gnc_gen_trans_list_add_trans_with_ref_id(gui, trans, 0);
@@ -899,8 +965,6 @@ void gnc_gen_trans_list_add_trans(GNCImportMainMatcher *gui, Transaction *trans)
 void gnc_gen_trans_list_add_trans_with_ref_id(GNCImportMainMatcher *gui, Transaction *trans, guint32 ref_id)
 {
     GNCImportTransInfo * transaction_info = NULL;
-    GtkTreeModel *model;
-    GtkTreeIter iter;
     g_assert (gui);
     g_assert (trans);
 
@@ -912,12 +976,11 @@ void gnc_gen_trans_list_add_trans_with_ref_id(GNCImportMainMatcher *gui, Transac
         transaction_info = gnc_import_TransInfo_new(trans, NULL);
         gnc_import_TransInfo_set_ref_id(transaction_info, ref_id);
 
-        gnc_import_TransInfo_init_matches(transaction_info,
-                                          gui->user_settings);
-
-        model = gtk_tree_view_get_model(gui->view);
-        gtk_list_store_append(GTK_LIST_STORE(model), &iter);
-        refresh_model_row (gui, model, &iter, transaction_info);
+        /* Matching is deferred until the caller has added the whole
+           batch, so the candidate splits can be collected per account. */
+        gui->pending = g_list_prepend(gui->pending, transaction_info);
+        if (!gui->pending_id)
+            gui->pending_id = g_idle_add(process_pending_matches_idle, gui);
     }
     return;
 }/* end gnc_import_add_trans_with_ref_id() */
@@ -73,7 +73,7 @@ void gnc_import_set_trans_online_id(Transaction * transaction,
 {
     kvp_frame * frame;
     xaccTransBeginEdit (transaction);
-    frame = xaccTransGetSlots(transaction);
+    frame = xaccTransGetSlotsForEdit(transaction);
     kvp_frame_set_str (frame, "online_id", string_value);
     qof_instance_set_dirty (QOF_INSTANCE (transaction));
     xaccTransCommitEdit (transaction);
@@ -100,7 +100,7 @@ void gnc_import_set_split_online_id(Split * split,
 {
     kvp_frame * frame;
     xaccTransBeginEdit (xaccSplitGetParent (split));
-    frame = xaccSplitGetSlots(split);
+    frame = xaccSplitGetSlotsForEdit(split);
     kvp_frame_set_str (frame, "online_id", string_value);
     qof_instance_set_dirty (QOF_INSTANCE (split));
     xaccTransCommitEdit (xaccSplitGetParent (split));
@@ -0,0 +1,195 @@
+/*
+ * test-import-online-id.c -- Test the online_id duplicate detection.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, contact:
+ *
+ * Free Software Foundation           Voice:  +1-617-542-5942
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <libguile.h>
+
+#include "gnc-module.h"
+#include "gnc-engine.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "import-backend.h"
+#include "import-utilities.h"
+
+#include "test-stuff.h"
+
+/* Sizes of the history and of the import.  With GNC_TEST_PERF set in
+ * the environment the test runs on a large history and prints how long
+ * the duplicate checks took. */
+#define NUM_EXISTING 5000
+#define NUM_IMPORTED 200
+#define PERF_NUM_EXISTING 50000
+#define PERF_NUM_IMPORTED 2000
+
+static QofBook *book;
+static gnc_commodity *currency;
+static Account *bank, *other;
+
+/* A transaction from other to bank whose bank split carries the online
+ * id.  Imported transactions are left open, as the importers do. */
+static Transaction *
+make_trans (time64 date, const char *online_id, gboolean commit)
+{
+    Transaction *trans = xaccMallocTransaction (book);
+    Split *split;
+    gnc_numeric amount = gnc_numeric_create (1000, 100);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecs (trans, date);
+    xaccTransSetDescription (trans, "import test");
+
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, bank);
+    xaccSplitSetValue (split, amount);
+    xaccSplitSetAmount (split, amount);
+    gnc_import_set_split_online_id (split, online_id);
+
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, other);
+    xaccSplitSetValue (split, gnc_numeric_neg (amount));
+    xaccSplitSetAmount (split, gnc_numeric_neg (amount));
+
+    if (commit)
+        xaccTransCommitEdit (trans);
+    return trans;
+}
+
+/* Import one transaction; commits it unless it was a duplicate. */
+static gboolean
+import_trans (time64 date, const char *online_id)
+{
+    Transaction *trans = make_trans (date, online_id, FALSE);
+
+    if (gnc_import_exists_online_id (trans))
+        return TRUE;
+    xaccTransCommitEdit (trans);
+    return FALSE;
+}
+
+static void
+test_exists_online_id (void)
+{
+    Transaction *existing[2];
+    gboolean perf = (g_getenv ("GNC_TEST_PERF") != NULL);
+    GTimer *timer = NULL;
+    gchar id[32];
+    gint i, dups;
+    gint num_existing = NUM_EXISTING, num_imported = NUM_IMPORTED;
+    time64 base = 1388577600;
+
+    if (perf)
+    {
+        num_existing = PERF_NUM_EXISTING;
+        num_imported = PERF_NUM_IMPORTED;
+    }
+
+    book = qof_book_new ();
+    currency = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "",
+                                  100);
+    bank = xaccMallocAccount (book);
+    other = xaccMallocAccount (book);
+    xaccAccountSetCommodity (bank, currency);
+    xaccAccountSetCommodity (other, currency);
+
+    xaccAccountBeginEdit (bank);
+    xaccAccountBeginEdit (other);
+    for (i = 0; i < num_existing; i++)
+    {
+        Transaction *trans;
+
+        g_snprintf (id, sizeof (id), "E%d", i);
+        trans = make_trans (base + i * 60, id, TRUE);
+        if (i < 2)
+            existing[i] = trans;
+    }
+    xaccAccountCommitEdit (other);
+    xaccAccountCommitEdit (bank);
+
+    /* Half of the import overlaps the existing history. */
+    if (perf)
+        timer = g_timer_new ();
+    dups = 0;
+    for (i = 0; i < num_imported; i++)
+    {
+        if (i % 2)
+            g_snprintf (id, sizeof (id), "N%d", i);
+        else
+            g_snprintf (id, sizeof (id), "E%d", i * 25);
+        if (import_trans (base + i * 60, id))
+            dups++;
+    }
+    if (timer)
+    {
+        g_timer_stop (timer);
+        printf ("Checked %d imported against %d existing transactions in %.3fs\n",
+                num_imported, num_existing, g_timer_elapsed (timer, NULL));
+        g_timer_destroy (timer);
+    }
+    do_test (dups == num_imported / 2, "overlapping import");
+
+    /* The transactions committed by the first import are found now. */
+    dups = 0;
+    for (i = 1; i < num_imported; i += 2)
+    {
+        g_snprintf (id, sizeof (id), "N%d", i);
+        if (import_trans (base, id))
+            dups++;
+    }
+    do_test (dups == num_imported / 2, "repeated import");
+
+    /* Changing and deleting existing online_ids. */
+    gnc_import_set_split_online_id (xaccTransFindSplitByAccount (existing[0], bank),
+                                    "X0");
+    do_test (!import_trans (base, "E0"), "changed online_id, old value");
+    do_test (import_trans (base, "X0"), "changed online_id, new value");
+
+    xaccTransBeginEdit (existing[1]);
+    xaccTransDestroy (existing[1]);
+    xaccTransCommitEdit (existing[1]);
+    do_test (!import_trans (base, "E1"), "deleted transaction");
+    do_test (import_trans (base, "E1"), "imported again");
+
+    qof_book_destroy (book);
+}
+
+static void
+main_helper(void *closure, int argc, char **argv)
+{
+    gnc_module_system_init ();
+    gnc_module_load("gnucash/import-export", 0);
+    test_exists_online_id();
+    print_test_results();
+    exit(get_rv());
+}
+
+int
+main(int argc, char **argv)
+{
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    scm_boot_guile(argc, argv, main_helper, NULL);
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * test-import-split-matches.c -- Test that matching imported transactions
+ * in a batch gives the same matches as matching them one at a time.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, contact:
+ *
+ * Free Software Foundation           Voice:  +1-617-542-5942
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <libguile.h>
+
+#include "gnc-module.h"
+#include "gnc-engine.h"
+#include "gnc-ui-util.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "import-backend.h"
+
+#include "test-stuff.h"
+
+#define NUM_EXISTING 400
+#define NUM_IMPORTED 60
+
+#define PROCESS_THRESHOLD 1
+#define FUZZY_AMOUNT 3.0
+#define DATE_HARDLIMIT 14
+
+static QofBook *book;
+static gnc_commodity *currency;
+static Account *banks[2], *other;
+
+/* A transaction from other to bank.  Imported transactions are left
+ * open, as the importers do, so that they don't match each other. */
+static Transaction *
+make_trans (Account *bank, time64 date, gint64 cents, const char *num,
+            const char *description, const char *memo, gboolean commit)
+{
+    Transaction *trans = xaccMallocTransaction (book);
+    Split *split;
+    gnc_numeric amount = gnc_numeric_create (cents, 100);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecs (trans, date);
+    xaccTransSetNum (trans, num);
+    xaccTransSetDescription (trans, description);
+
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, bank);
+    xaccSplitSetValue (split, amount);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetMemo (split, memo);
+
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, other);
+    xaccSplitSetValue (split, gnc_numeric_neg (amount));
+    xaccSplitSetAmount (split, gnc_numeric_neg (amount));
+
+    if (commit)
+        xaccTransCommitEdit (trans);
+    return trans;
+}
+
+static Transaction *
+make_numbered_trans (gint i, time64 date, gboolean commit)
+{
+    gchar num[16], description[32], memo[32];
+
+    g_snprintf (num, sizeof (num), "%d", i % 13);
+    g_snprintf (description, sizeof (description), "Payee %d", i % 7);
+    g_snprintf (memo, sizeof (memo), "Memo %d", i % 5);
+    return make_trans (banks[i % 2], date, 1000 + (i % 4) * 100, num,
+                       description, memo, commit);
+}
+
+static gint
+compare_matches (gconstpointer a, gconstpointer b)
+{
+    GNCImportMatchInfo *ma = (GNCImportMatchInfo *)a;
+    GNCImportMatchInfo *mb = (GNCImportMatchInfo *)b;
+    Split *sa = gnc_import_MatchInfo_get_split (ma);
+    Split *sb = gnc_import_MatchInfo_get_split (mb);
+
+    if (sa != sb)
+        return guid_compare (xaccSplitGetGUID (sa), xaccSplitGetGUID (sb));
+    return gnc_import_MatchInfo_get_probability (ma) -
+           gnc_import_MatchInfo_get_probability (mb);
+}
+
+/* Whether the two match lists hold the same splits with the same scores,
+ * in any order. */
+static gboolean
+same_matches (const GNCImportTransInfo *single,
+              const GNCImportTransInfo *batch, gint *count)
+{
+    GList *la = g_list_copy (gnc_import_TransInfo_get_match_list (single));
+    GList *lb = g_list_copy (gnc_import_TransInfo_get_match_list (batch));
+    GList *na, *nb;
+    gboolean same = (g_list_length (la) == g_list_length (lb));
+
+    la = g_list_sort (la, compare_matches);
+    lb = g_list_sort (lb, compare_matches);
+    for (na = la, nb = lb; same && na && nb; na = na->next, nb = nb->next)
+    {
+        if (compare_matches (na->data, nb->data) != 0)
+            same = FALSE;
+    }
+    *count += g_list_length (la);
+    g_list_free (la);
+    g_list_free (lb);
+    return same;
+}
+
+static void
+test_find_split_matches_list (void)
+{
+    GList *singles = NULL, *batch = NULL, *na, *nb;
+    Transaction *imported[NUM_IMPORTED];
+    gint i, count = 0;
+    gboolean same = TRUE;
+    time64 base = 1388577600;
+
+    book = gnc_get_current_book ();
+    currency = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "",
+                                  100);
+    banks[0] = xaccMallocAccount (book);
+    banks[1] = xaccMallocAccount (book);
+    other = xaccMallocAccount (book);
+    xaccAccountSetCommodity (banks[0], currency);
+    xaccAccountSetCommodity (banks[1], currency);
+    xaccAccountSetCommodity (other, currency);
+
+    /* Existing history, two transactions a day in each account, with
+     * repeating numbers, payees, memos and amounts. */
+    for (i = 0; i < NUM_EXISTING; i++)
+        make_numbered_trans (i, base + i * 21600, TRUE);
+
+    /* Imports scattered over the history and past both of its ends, so
+     * that some of their date ranges overlap and some are cut off. */
+    for (i = 0; i < NUM_IMPORTED; i++)
+    {
+        time64 date = base - 20 * 86400 + (i * 7919 % 140) * 86400 + i * 600;
+
+        imported[i] = make_numbered_trans (i * 3, date, FALSE);
+        singles = g_list_prepend (singles,
+                                  gnc_import_TransInfo_new (imported[i], NULL));
+        batch = g_list_prepend (batch,
+                                gnc_import_TransInfo_new (imported[i], NULL));
+    }
+
+    for (na = singles; na; na = na->next)
+        gnc_import_find_split_matches (na->data, PROCESS_THRESHOLD,
+                                       FUZZY_AMOUNT, DATE_HARDLIMIT);
+    gnc_import_find_split_matches_list (batch, PROCESS_THRESHOLD,
+                                        FUZZY_AMOUNT, DATE_HARDLIMIT);
+
+    for (na = singles, nb = batch; na && nb; na = na->next, nb = nb->next)
+    {
+        if (!same_matches (na->data, nb->data, &count))
+            same = FALSE;
+    }
+    do_test (same, "batch matches equal single matches");
+    do_test (count > 0, "imports have matches");
+
+    /* Commit the imports so that deleting the infos leaves them alone. */
+    for (i = 0; i < NUM_IMPORTED; i++)
+        xaccTransCommitEdit (imported[i]);
+    g_list_free_full (singles, (GDestroyNotify)gnc_import_TransInfo_delete);
+    g_list_free_full (batch, (GDestroyNotify)gnc_import_TransInfo_delete);
+}
+
+static void
+main_helper(void *closure, int argc, char **argv)
+{
+    gnc_module_system_init ();
+    gnc_module_load("gnucash/import-export", 0);
+    test_find_split_matches_list();
+    print_test_results();
+    exit(get_rv());
+}
+
+int
+main(int argc, char **argv)
+{
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    scm_boot_guile(argc, argv, main_helper, NULL);
+    return 0;
+}
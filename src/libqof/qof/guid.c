@@ -37,6 +37,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
 #ifdef HAVE_SYS_TIMES_H
 # include <sys/times.h>
 #endif
@@ -56,10 +58,27 @@
 #define BLOCKSIZE 4096
 #define THRESHOLD (2 * BLOCKSIZE)
 
+/* New ids are cut from blocks of bytes read from the system's random
+ * device, GUID_POOL_SIZE ids at a time, into a per-thread pool. */
+#define GUID_POOL_SIZE 256
+#define GUID_RANDOM_DEVICE "/dev/urandom"
+
+typedef struct
+{
+    guint next;
+    guchar data[GUID_POOL_SIZE * GUID_DATA_SIZE];
+} GuidPool;
+
 
 /* Static global variables *****************************************/
 static gboolean guid_initialized = FALSE;
+static int guid_random_fd = -1;
+G_LOCK_DEFINE_STATIC(guid_random);
+
+/* The md5 generator is only used where there is no random device. */
+static gboolean guid_md5_initialized = FALSE;
 static struct md5_ctx guid_context;
+G_LOCK_DEFINE_STATIC(guid_md5);
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
@@ -358,8 +377,10 @@ init_from_buff(unsigned char * buf, size_t buflen)
     return buflen;
 }
 
-void
-guid_init(void)
+/* Seed the md5 generator from a variety of system sources.  This is
+ * slow, so it is only done when there is no random device. */
+static void
+guid_init_md5(void)
 {
     size_t bytes = 0;
 
@@ -522,28 +543,54 @@ guid_init(void)
               (unsigned long int)bytes);
 #endif
 
-    guid_initialized = TRUE;
+    guid_md5_initialized = TRUE;
     LEAVE();
 }
 
+void
+guid_init(void)
+{
+    ENTER("");
+    G_LOCK(guid_random);
+#ifndef G_OS_WIN32
+    if (guid_random_fd < 0)
+        guid_random_fd = g_open (GUID_RANDOM_DEVICE, O_RDONLY, 0);
+#endif
+    if (guid_random_fd < 0)
+    {
+        PWARN ("Cannot open %s, falling back to the md5 generator",
+               GUID_RANDOM_DEVICE);
+        G_LOCK(guid_md5);
+        guid_init_md5 ();
+        G_UNLOCK(guid_md5);
+    }
+    guid_initialized = TRUE;
+    G_UNLOCK(guid_random);
+    LEAVE("");
+}
+
 void
 guid_shutdown (void)
 {
+    G_LOCK(guid_random);
+    if (guid_random_fd >= 0)
+        close (guid_random_fd);
+    guid_random_fd = -1;
+    guid_initialized = FALSE;
+    G_UNLOCK(guid_random);
 }
 
 #define GUID_PERIOD 5000
 
 void
-guid_new(GncGUID *guid)
+guid_new_md5(GncGUID *guid)
 {
     static int counter = 0;
     struct md5_ctx ctx;
 
-    if (guid == NULL)
-        return;
-
-    if (!guid_initialized)
-        guid_init();
+    G_LOCK(guid_md5);
+    if (!guid_md5_initialized)
+        guid_init_md5();
 
     /* make the id */
     ctx = guid_context;
@@ -571,17 +618,101 @@ guid_new(GncGUID *guid)
         FILE *fp;
 
         fp = g_fopen ("/dev/urandom", "r");
-        if (fp == NULL)
-            return;
-
-        init_from_stream(fp, 32);
-
-        fclose(fp);
+        if (fp != NULL)
+        {
+            init_from_stream(fp, 32);
+            fclose(fp);
+        }
 
         counter = GUID_PERIOD;
     }
 
     counter--;
+    G_UNLOCK(guid_md5);
+}
+
+/* Refill the pool from the random device.  Returns FALSE if there is
+ * no device or it cannot be read. */
+static gboolean
+guid_pool_fill(GuidPool *pool)
+{
+    gsize got = 0;
+
+    if (guid_random_fd < 0)
+        return FALSE;
+
+    while (got < sizeof(pool->data))
+    {
+        gssize n = read (guid_random_fd, pool->data + got,
+                         sizeof(pool->data) - got);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            PERR ("Cannot read %s", GUID_RANDOM_DEVICE);
+            return FALSE;
+        }
+        got += n;
+    }
+    pool->next = 0;
+    return TRUE;
+}
+
+static GuidPool *
+guid_get_pool(void)
+{
+#ifdef G_THREADS_ENABLED
+#ifndef HAVE_GLIB_2_32
+    static GStaticPrivate guid_pool_key = G_STATIC_PRIVATE_INIT;
+    GuidPool *pool;
+
+    pool = g_static_private_get (&guid_pool_key);
+    if (pool == NULL)
+    {
+        pool = g_new (GuidPool, 1);
+        pool->next = GUID_POOL_SIZE;
+        g_static_private_set (&guid_pool_key, pool, g_free);
+    }
+#else
+    static GPrivate guid_pool_key = G_PRIVATE_INIT(g_free);
+    GuidPool *pool;
+
+    pool = g_private_get (&guid_pool_key);
+    if (pool == NULL)
+    {
+        pool = g_new (GuidPool, 1);
+        pool->next = GUID_POOL_SIZE;
+        g_private_set (&guid_pool_key, pool);
+    }
+#endif
+#else
+    static GuidPool static_pool = { GUID_POOL_SIZE };
+    GuidPool *pool = &static_pool;
+#endif
+    return pool;
+}
+
+void
+guid_new(GncGUID *guid)
+{
+    GuidPool *pool;
+
+    if (guid == NULL)
+        return;
+
+    if (!guid_initialized)
+        guid_init();
+
+    pool = guid_get_pool ();
+    if (pool->next == GUID_POOL_SIZE && !guid_pool_fill (pool))
+    {
+        guid_new_md5 (guid);
+        return;
+    }
+
+    memcpy (guid->data, pool->data + pool->next * GUID_DATA_SIZE,
+            GUID_DATA_SIZE);
+    pool->next++;
 }
 
 GncGUID
@@ -733,6 +864,7 @@ guint
 guid_hash_to_guint (gconstpointer ptr)
 {
     const GncGUID *guid = ptr;
+    guint64 lo, hi, h;
 
     if (!guid)
     {
@@ -740,26 +872,15 @@ guid_hash_to_guint (gconstpointer ptr)
         return 0;
     }
 
-    if (sizeof(guint) <= sizeof(guid->data))
-    {
-        const guint* ptr_data = (const guint *) guid->data;
-        return (*ptr_data);
-    }
-    else
-    {
-        guint hash = 0;
-        unsigned int i, j;
-
-        for (i = 0, j = 0; i < sizeof(guint); i++, j++)
-        {
-            if (j == GUID_DATA_SIZE) j = 0;
-
-            hash <<= 4;
-            hash |= guid->data[j];
-        }
-
-        return hash;
-    }
+    /* Mix all 128 bits, ids are not always random (e.g. when made up
+     * by hand or by importers). */
+    memcpy (&lo, guid->data, sizeof (lo));
+    memcpy (&hi, guid->data + sizeof (lo), sizeof (hi));
+    h = lo ^ (hi * G_GUINT64_CONSTANT(0x9e3779b97f4a7c15));
+    h ^= h >> 32;
+    h *= G_GUINT64_CONSTANT(0xd6e8feb86659fd93);
+    h ^= h >> 32;
+    return (guint) h;
 }
 
 gint
@@ -71,19 +71,14 @@ const GncGUID* gnc_value_get_guid (const GValue *value);
 #define GUID_ENCODING_LENGTH 32
 
 
-/** Initialize the id generator with a variety of random
- *  sources.
- *
- *  @note Only one of guid_init(), guid_init_with_salt() and
- *  guid_init_only_salt() should be called.  Calling any
- *  initialization function a second time will reset the generator and
- *  erase the effect of the first call.
+/** Initialize the id generator.  This opens the system's random
+ *  device; only if there is none is the md5 generator seeded from a
+ *  variety of random sources instead.
  */
 void guid_init(void);
 
-/** Release the memory chunk associated with gui storage. Use this
- *  only when shutting down the program, as it invalidates *all*
- *  GUIDs at once. */
+/** Close the random device opened by guid_init(). Use this only when
+ *  shutting down the program. */
 void guid_shutdown (void);
 
 /** Generate a new id. If no initialization function has been called,
@@ -92,7 +87,9 @@ void guid_shutdown (void);
  *  @param guid A pointer to an existing guid data structure.  The
  *  existing value will be replaced with a new value.
  *
- * This routine uses the md5 algorithm to build strong random guids.
+ * Ids are taken from a per-thread pool that is refilled from the
+ * system's random device a few hundred at a time, so this is cheap and
+ * safe to call from several threads.
  * Note that while guid's are generated randomly, the odds of this
  * routine returning a non-unique id are astronomically small.
  * (Literally astronomically: If you had Cray's on every solar
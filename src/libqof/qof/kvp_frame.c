@@ -36,12 +36,26 @@
  * qof_string_cache, as it is very likely we will see the
  * same keys over and over again  */
 
+/* Most frames hold only a handful of slots, so a frame starts out
+ * as a small array of slots sorted by key and only switches to a
+ * hash table once it grows past KVP_FRAME_MAX_SLOTS.  A frame in
+ * hash mode stays there. */
+#define KVP_FRAME_MAX_SLOTS 16
+
+typedef struct
+{
+    const gchar *key;
+    KvpValue    *value;
+} KvpSlot;
+
 struct _KvpFrame
 {
     GHashTable  * hash;
+    KvpSlot     * slots;
+    guint16       n_slots;
+    guint16       n_alloc;
 };
 
-
 typedef struct
 {
     void        *data;
@@ -88,11 +102,103 @@ kvp_comp_func(gconstpointer v, gconstpointer v2)
 static gboolean
 init_frame_body_if_needed(KvpFrame *f)
 {
-    if (!f->hash)
+    if (!f->hash && !f->slots)
     {
-        f->hash = g_hash_table_new(&kvp_hash_func, &kvp_comp_func);
+        f->n_alloc = 4;
+        f->slots = g_new(KvpSlot, f->n_alloc);
     }
-    return(f->hash != NULL);
+    return TRUE;
+}
+
+/* Compare the first len characters at key, taken as a string of its
+ * own, against slot_key, in strcmp order. */
+static inline gint
+kvp_key_compare(const char *key, gsize len, const char *slot_key)
+{
+    gint cmp = strncmp(key, slot_key, len);
+    if (cmp == 0 && slot_key[len] != '\0')
+        return -1;
+    return cmp;
+}
+
+/* Binary search the slot array for the key of length len.  Returns
+ * TRUE and its index if found, else FALSE and the insertion index. */
+static gboolean
+kvp_frame_find_slot(const KvpFrame *frame, const char *key, gsize len,
+                    guint *index)
+{
+    guint lo = 0, hi = frame->n_slots;
+
+    while (lo < hi)
+    {
+        guint mid = (lo + hi) / 2;
+        gint cmp = kvp_key_compare(key, len, frame->slots[mid].key);
+
+        if (cmp == 0)
+        {
+            *index = mid;
+            return TRUE;
+        }
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    *index = lo;
+    return FALSE;
+}
+
+/* Look up the slot named by the first len characters of key, which
+ * need not be nul-terminated there. */
+static KvpValue *
+kvp_frame_get_slot_len(const KvpFrame *frame, const char *key, gsize len)
+{
+    guint index;
+
+    if (frame->slots)
+    {
+        if (kvp_frame_find_slot(frame, key, len, &index))
+            return frame->slots[index].value;
+        return NULL;
+    }
+    if (frame->hash)
+    {
+        KvpValue *value;
+        gchar buf[128];
+
+        if (key[len] == '\0')
+            return g_hash_table_lookup(frame->hash, key);
+        if (len < sizeof(buf))
+        {
+            memcpy(buf, key, len);
+            buf[len] = '\0';
+            return g_hash_table_lookup(frame->hash, buf);
+        }
+        else
+        {
+            gchar *tmp = g_strndup(key, len);
+            value = g_hash_table_lookup(frame->hash, tmp);
+            g_free(tmp);
+            return value;
+        }
+    }
+    return NULL;
+}
+
+/* Move the slots of an array frame into a hash table. */
+static void
+kvp_frame_convert_to_hash(KvpFrame *frame)
+{
+    guint i;
+
+    if (frame->hash) return;
+    frame->hash = g_hash_table_new(&kvp_hash_func, &kvp_comp_func);
+    for (i = 0; i < frame->n_slots; i++)
+        g_hash_table_insert(frame->hash, (gpointer) frame->slots[i].key,
+                            frame->slots[i].value);
+    g_free(frame->slots);
+    frame->slots = NULL;
+    frame->n_slots = frame->n_alloc = 0;
 }
 
 KvpFrame *
@@ -102,6 +208,7 @@ kvp_frame_new(void)
 
     /* Save space until the frame is actually used */
     retval->hash = NULL;
+    retval->slots = NULL;
     return retval;
 }
 
@@ -115,6 +222,8 @@ kvp_frame_delete_worker(gpointer key, gpointer value, gpointer user_data)
 void
 kvp_frame_delete(KvpFrame * frame)
 {
+    guint i;
+
     if (!frame) return;
 
     if (frame->hash)
@@ -127,6 +236,14 @@ kvp_frame_delete(KvpFrame * frame)
         g_hash_table_destroy(frame->hash);
         frame->hash = NULL;
     }
+    if (frame->slots)
+    {
+        for (i = 0; i < frame->n_slots; i++)
+            kvp_frame_delete_worker((gpointer) frame->slots[i].key,
+                                    frame->slots[i].value, frame);
+        g_free(frame->slots);
+        frame->slots = NULL;
+    }
     g_free(frame);
 }
 
@@ -134,10 +251,18 @@ gboolean
 kvp_frame_is_empty(const KvpFrame * frame)
 {
     if (!frame) return TRUE;
-    if (!frame->hash) return TRUE;
+    if (!frame->hash && !frame->slots) return TRUE;
     return FALSE;
 }
 
+guint
+kvp_frame_get_slot_count(const KvpFrame * frame)
+{
+    if (!frame) return 0;
+    if (frame->hash) return g_hash_table_size(frame->hash);
+    return frame->n_slots;
+}
+
 static void
 kvp_frame_copy_worker(gpointer key, gpointer value, gpointer user_data)
 {
@@ -151,16 +276,30 @@ KvpFrame *
 kvp_frame_copy(const KvpFrame * frame)
 {
     KvpFrame * retval = kvp_frame_new();
+    guint i;
 
     if (!frame) return retval;
 
     if (frame->hash)
     {
-        if (!init_frame_body_if_needed(retval)) return(NULL);
+        retval->hash = g_hash_table_new(&kvp_hash_func, &kvp_comp_func);
         g_hash_table_foreach(frame->hash,
                              & kvp_frame_copy_worker,
                              (gpointer)retval);
     }
+    else if (frame->slots)
+    {
+        /* The source is already sorted, so copy it slot for slot. */
+        retval->n_alloc = MAX(frame->n_slots, 4);
+        retval->slots = g_new(KvpSlot, retval->n_alloc);
+        for (i = 0; i < frame->n_slots; i++)
+        {
+            retval->slots[i].key =
+                qof_string_cache_insert((gpointer) frame->slots[i].key);
+            retval->slots[i].value = kvp_value_copy(frame->slots[i].value);
+        }
+        retval->n_slots = frame->n_slots;
+    }
     return retval;
 }
 
@@ -175,10 +314,46 @@ kvp_frame_replace_slot_nc (KvpFrame * frame, const char * slot,
     gpointer orig_key;
     gpointer orig_value = NULL;
     int      key_exists;
+    guint    index;
 
     if (!frame || !slot) return NULL;
     if (!init_frame_body_if_needed(frame)) return NULL; /* Error ... */
 
+    if (frame->slots)
+    {
+        if (kvp_frame_find_slot(frame, slot, strlen(slot), &index))
+        {
+            orig_value = frame->slots[index].value;
+            if (new_value)
+            {
+                frame->slots[index].value = new_value;
+                return (KvpValue *) orig_value;
+            }
+            qof_string_cache_remove((gpointer) frame->slots[index].key);
+            frame->n_slots--;
+            memmove(frame->slots + index, frame->slots + index + 1,
+                    (frame->n_slots - index) * sizeof(KvpSlot));
+            return (KvpValue *) orig_value;
+        }
+        if (!new_value) return NULL;
+
+        if (frame->n_slots < KVP_FRAME_MAX_SLOTS)
+        {
+            if (frame->n_slots == frame->n_alloc)
+            {
+                frame->n_alloc = MIN(frame->n_alloc * 2, KVP_FRAME_MAX_SLOTS);
+                frame->slots = g_renew(KvpSlot, frame->slots, frame->n_alloc);
+            }
+            memmove(frame->slots + index + 1, frame->slots + index,
+                    (frame->n_slots - index) * sizeof(KvpSlot));
+            frame->slots[index].key = qof_string_cache_insert((gpointer) slot);
+            frame->slots[index].value = new_value;
+            frame->n_slots++;
+            return NULL;
+        }
+        kvp_frame_convert_to_hash(frame);
+    }
+
     key_exists = g_hash_table_lookup_extended(frame->hash, slot,
                  & orig_key, & orig_value);
     if (key_exists)
@@ -374,12 +549,21 @@ get_trailer_or_null (const KvpFrame * frame, const char * key_path, char **end_k
     }
     else
     {
-        char *root, *lkey;
-        root = g_strdup (key_path);
-        lkey = strrchr (root, '/');
-        *lkey = 0;
-        frame = kvp_frame_get_frame_or_null_slash_trash (frame, root);
-        g_free(root);
+        /* Walk the leading components in place rather than splitting
+         * a copy of the path. */
+        const char *key = key_path, *next;
+
+        while (frame && key < last_key)
+        {
+            next = strchr (key, '/');
+            if (next != key)
+            {
+                KvpValue *value = kvp_frame_get_slot_len (frame, key,
+                                  next - key);
+                frame = value ? kvp_value_get_frame (value) : NULL;
+            }
+            key = next + 1;
+        }
 
         last_key ++;
     }
@@ -598,11 +782,8 @@ kvp_frame_set_slot_nc(KvpFrame * frame, const char * slot,
 KvpValue *
 kvp_frame_get_slot(const KvpFrame * frame, const char * slot)
 {
-    KvpValue *v;
-    if (!frame) return NULL;
-    if (!frame->hash) return NULL;  /* Error ... */
-    v = g_hash_table_lookup(frame->hash, slot);
-    return v;
+    if (!frame || !slot) return NULL;
+    return kvp_frame_get_slot_len(frame, slot, strlen(slot));
 }
 
 /* ============================================================ */
@@ -1322,11 +1503,64 @@ kvp_frame_for_each_slot(KvpFrame *f,
                                      gpointer data),
                         gpointer data)
 {
+    guint i;
+
     if (!f) return;
     if (!proc) return;
-    if (!(f->hash)) return;
 
-    g_hash_table_foreach(f->hash, (GHFunc) proc, data);
+    if (f->hash)
+        g_hash_table_foreach(f->hash, (GHFunc) proc, data);
+    else
+        for (i = 0; i < f->n_slots; i++)
+            proc(f->slots[i].key, f->slots[i].value, data);
+}
+
+static gint
+kvp_slot_key_compare(gconstpointer a, gconstpointer b)
+{
+    return strcmp(((const KvpSlot *) a)->key, ((const KvpSlot *) b)->key);
+}
+
+static void
+kvp_frame_collect_slot(gpointer key, gpointer value, gpointer data)
+{
+    KvpSlot slot;
+    slot.key = key;
+    slot.value = value;
+    g_array_append_val((GArray *) data, slot);
+}
+
+void
+kvp_frame_for_each_slot_sorted(const KvpFrame *f,
+                               void (*proc)(const gchar *key,
+                                            KvpValue *value,
+                                            gpointer data),
+                               gpointer data)
+{
+    GArray *slots;
+    guint i;
+
+    if (!f) return;
+    if (!proc) return;
+
+    if (!f->hash)
+    {
+        /* The slot array is kept sorted. */
+        for (i = 0; i < f->n_slots; i++)
+            proc(f->slots[i].key, f->slots[i].value, data);
+        return;
+    }
+
+    slots = g_array_sized_new(FALSE, FALSE, sizeof(KvpSlot),
+                              g_hash_table_size(f->hash));
+    g_hash_table_foreach(f->hash, kvp_frame_collect_slot, slots);
+    g_array_sort(slots, kvp_slot_key_compare);
+    for (i = 0; i < slots->len; i++)
+    {
+        KvpSlot *slot = &g_array_index(slots, KvpSlot, i);
+        proc(slot->key, slot->value, data);
+    }
+    g_array_free(slots, TRUE);
 }
 
 #ifdef _MSC_VER
@@ -1434,8 +1668,8 @@ kvp_frame_compare(const KvpFrame *fa, const KvpFrame *fb)
     if (fa && !fb) return 1;
 
     /* nothing is always less than something */
-    if (!fa->hash && fb->hash) return -1;
-    if (fa->hash && !fb->hash) return 1;
+    if (kvp_frame_is_empty(fa) && !kvp_frame_is_empty(fb)) return -1;
+    if (!kvp_frame_is_empty(fa) && kvp_frame_is_empty(fb)) return 1;
 
     status.compare = 0;
     status.other_frame = (KvpFrame *) fb;
@@ -1625,8 +1859,9 @@ kvp_frame_to_string(const KvpFrame *frame)
 
     tmp1 = g_strdup_printf("{\n");
 
-    if (frame->hash)
-        g_hash_table_foreach(frame->hash, kvp_frame_to_string_helper, &tmp1);
+    kvp_frame_for_each_slot((KvpFrame *) frame,
+                            (void (*)(const gchar *, KvpValue *, gpointer))
+                            kvp_frame_to_string_helper, &tmp1);
 
     {
         gchar *tmp2;
@@ -1642,6 +1877,10 @@ GHashTable*
 kvp_frame_get_hash(const KvpFrame *frame)
 {
     g_return_val_if_fail (frame != NULL, NULL);
+    /* Callers may hold on to the table, so the frame has to stay in
+     * hash mode from now on. */
+    if (frame->slots)
+        kvp_frame_convert_to_hash((KvpFrame *) frame);
     return frame->hash;
 }
 
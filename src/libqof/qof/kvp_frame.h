@@ -130,6 +130,9 @@ KvpFrame   * kvp_frame_copy(const KvpFrame * frame);
 /** Return TRUE if the KvpFrame is empty */
 gboolean     kvp_frame_is_empty(const KvpFrame * frame);
 
+/** Return the number of slots stored directly in the KvpFrame. */
+guint        kvp_frame_get_slot_count(const KvpFrame * frame);
+
 /** @} */
 
 /** @name KvpFrame Basic Value Storing
@@ -581,6 +584,14 @@ void kvp_frame_for_each_slot(KvpFrame *f,
                                      gpointer data),
                              gpointer data);
 
+/** Like kvp_frame_for_each_slot, but visit the slots in strcmp order
+   of their keys, as needed for stable output. */
+void kvp_frame_for_each_slot_sorted(const KvpFrame *f,
+                                    void (*proc)(const gchar *key,
+                                            KvpValue *value,
+                                            gpointer data),
+                                    gpointer data);
+
 /** @} */
 
 /** Internal helper routines, you probably shouldn't be using these. */
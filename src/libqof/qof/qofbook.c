@@ -627,26 +627,56 @@ qof_book_validate_counter_format_internal(const gchar *p,
     return NULL;
 }
 
-/* Determine whether this book uses trading accounts */
-gboolean
-qof_book_use_trading_accounts (const QofBook *book)
+/* Option values are read from the slots only when the cache is stale,
+ * the getters below are plain field loads otherwise. */
+static gboolean
+book_option_is_true (KvpFrame *slots, const char *name)
 {
     const char *opt;
     kvp_value *kvp_val;
 
-    kvp_val = kvp_frame_get_slot_path (qof_book_get_slots (book),
-                                       KVP_OPTION_PATH,
-                                       OPTION_SECTION_ACCOUNTS,
-                                       OPTION_NAME_TRADING_ACCOUNTS,
-                                       NULL);
+    kvp_val = kvp_frame_get_slot_path (slots, KVP_OPTION_PATH,
+                                       OPTION_SECTION_ACCOUNTS, name, NULL);
     if (kvp_val == NULL)
         return FALSE;
 
     opt = kvp_value_get_string (kvp_val);
+    return (opt && opt[0] == 't' && opt[1] == 0);
+}
+
+static QofBook *
+qof_book_get_cached_options (const QofBook *book)
+{
+    QofBook *b = (QofBook *) book;
+    KvpFrame *slots = qof_book_get_slots (book);
+    kvp_value *kvp_val;
+
+    if (b->cached_options.valid && b->cached_options.slots == slots)
+        return b;
+
+    b->cached_options.trading_accounts =
+        book_option_is_true (slots, OPTION_NAME_TRADING_ACCOUNTS);
+    b->cached_options.split_action_for_num =
+        book_option_is_true (slots, OPTION_NAME_NUM_FIELD_SOURCE);
+
+    kvp_val = kvp_frame_get_slot_path (slots, KVP_OPTION_PATH,
+                                       OPTION_SECTION_ACCOUNTS,
+                                       OPTION_NAME_AUTO_READONLY_DAYS, NULL);
+    b->cached_options.num_days_autoreadonly =
+        kvp_val ? (gint) kvp_value_get_double (kvp_val) : 0;
+    b->cached_options.autoreadonly_until = 0;
 
-    if (opt && opt[0] == 't' && opt[1] == 0)
-        return TRUE;
-    return FALSE;
+    b->cached_options.slots = slots;
+    b->cached_options.valid = TRUE;
+    return b;
+}
+
+/* Determine whether this book uses trading accounts */
+gboolean
+qof_book_use_trading_accounts (const QofBook *book)
+{
+    if (!book) return FALSE;
+    return qof_book_get_cached_options (book)->cached_options.trading_accounts;
 }
 
 /* Returns TRUE if this book uses split action field as the 'Num' field, FALSE
@@ -654,23 +684,8 @@ qof_book_use_trading_accounts (const QofBook *book)
 gboolean
 qof_book_use_split_action_for_num_field (const QofBook *book)
 {
-    const char *opt;
-    kvp_value *kvp_val;
-
     g_assert(book);
-    kvp_val = kvp_frame_get_slot_path (qof_book_get_slots (book),
-                                       KVP_OPTION_PATH,
-                                       OPTION_SECTION_ACCOUNTS,
-                                       OPTION_NAME_NUM_FIELD_SOURCE,
-                                       NULL);
-    if (kvp_val == NULL)
-        return FALSE;
-
-    opt = kvp_value_get_string (kvp_val);
-
-    if (opt && opt[0] == 't' && opt[1] == 0)
-        return TRUE;
-    return FALSE;
+    return qof_book_get_cached_options (book)->cached_options.split_action_for_num;
 }
 
 gboolean qof_book_uses_autoreadonly (const QofBook *book)
@@ -681,38 +696,45 @@ gboolean qof_book_uses_autoreadonly (const QofBook *book)
 
 gint qof_book_get_num_days_autoreadonly (const QofBook *book)
 {
-    kvp_value *kvp_val;
-    double tmp;
     g_assert(book);
-    kvp_val = kvp_frame_get_slot_path (qof_book_get_slots (book),
-                                       KVP_OPTION_PATH,
-                                       OPTION_SECTION_ACCOUNTS,
-                                       OPTION_NAME_AUTO_READONLY_DAYS,
-                                       NULL);
+    return qof_book_get_cached_options (book)->cached_options.num_days_autoreadonly;
+}
 
-    if (kvp_val == NULL)
+gboolean
+qof_book_get_autoreadonly_date (const QofBook *book, GDate *date)
+{
+    QofBook *b;
+    time64 now;
+
+    g_assert(book);
+    g_return_val_if_fail (date, FALSE);
+    b = qof_book_get_cached_options (book);
+    if (b->cached_options.num_days_autoreadonly <= 0)
+        return FALSE;
+
+    /* The threshold moves at midnight */
+    now = gnc_time (NULL);
+    if (now > b->cached_options.autoreadonly_until)
     {
-        //PWARN("kvp_val for slot '%s' is NULL", OPTION_NAME_AUTO_READONLY_DAYS);
-        return 0;
-    }
+        GDate *today = gnc_g_date_new_today ();
 
-    tmp = kvp_value_get_double (kvp_val);
-    return (gint) tmp;
+        g_date_subtract_days (today, b->cached_options.num_days_autoreadonly);
+        b->cached_options.autoreadonly_date = *today;
+        b->cached_options.autoreadonly_until = gnc_time64_get_today_end ();
+        g_date_free (today);
+    }
+    *date = b->cached_options.autoreadonly_date;
+    return TRUE;
 }
 
 GDate* qof_book_get_autoreadonly_gdate (const QofBook *book)
 {
-    gint num_days;
-    GDate* result = NULL;
+    GDate date;
 
     g_assert(book);
-    num_days = qof_book_get_num_days_autoreadonly(book);
-    if (num_days > 0)
-    {
-        result = gnc_g_date_new_today();
-        g_date_subtract_days(result, num_days);
-    }
-    return result;
+    if (!qof_book_get_autoreadonly_date (book, &date))
+        return NULL;
+    return g_date_new_julian (g_date_get_julian (&date));
 }
 
 const char*
@@ -747,6 +769,10 @@ static void noop (QofInstance *inst) {}
 void
 qof_book_commit_edit(QofBook *book)
 {
+    /* Every change to the book's slots, whether through
+     * qof_book_set_string_option(), qof_book_kvp_changed() or a backend
+     * loading them, ends with a commit. */
+    book->cached_options.valid = FALSE;
     if (!qof_commit_edit (QOF_INSTANCE(book))) return;
     qof_commit_edit_part2 (&book->inst, commit_err, noop, noop/*lot_free*/);
 }
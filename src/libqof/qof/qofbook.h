@@ -133,6 +133,24 @@ struct _QofBook
      * except that it provides a nice convenience, avoiding a lookup
      * from the session.  Better solutions welcome ... */
     QofBackend *backend;
+
+    /* Typed copies of the book options that are read on hot paths
+     * (sorting, read-only checks, register loading).  They are read
+     * from the slots again after the next qof_book_commit_edit(), so
+     * code writing the book's slots directly must call
+     * qof_book_kvp_changed() as before. */
+    struct
+    {
+        gboolean valid;
+        KvpFrame *slots;
+        gboolean trading_accounts;
+        gboolean split_action_for_num;
+        gint num_days_autoreadonly;
+        /* The auto-read-only threshold, valid until the end of the day
+         * it was computed on. */
+        GDate autoreadonly_date;
+        time64 autoreadonly_until;
+    } cached_options;
 };
 
 struct _QofBookClass
@@ -267,6 +285,11 @@ gint qof_book_get_num_days_autoreadonly (const QofBook *book);
  * g_date_free() the object afterwards. */
 GDate* qof_book_get_autoreadonly_gdate (const QofBook *book);
 
+/** Like qof_book_get_autoreadonly_gdate(), but stores the threshold in
+ * the caller's GDate instead of allocating one.  Returns FALSE and leaves
+ * date untouched if the auto-read-only feature is not used. */
+gboolean qof_book_get_autoreadonly_date (const QofBook *book, GDate *date);
+
 /** Returns TRUE if this book uses split action field as the 'Num' field, FALSE
  *  if it uses transaction number field */
 gboolean qof_book_use_split_action_for_num_field (const QofBook *book);
@@ -34,6 +34,9 @@ typedef struct
     gpointer user_data;
 
     gint handler_id;
+    QofEventId event_mask;  /* 0 for all events */
+    guint64 seq;            /* registration order */
+    QofEventBatchHandler batch_handler;
 } HandlerInfo;
 
 /* generates an event even when events are suspended! */
@@ -29,11 +29,36 @@
 
 /* Static Variables ************************************************/
 static guint   suspend_counter   = 0;
+static guint64 dropped_events    = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
+static guint64 next_handler_seq  = 0;
 static GList   *handlers  =   NULL;
 
+/* Handlers are dispatched from two lists, both newest first: those
+ * for all entity types, and per entity type those registered for it.
+ * The handlers list above owns every HandlerInfo. */
+typedef struct
+{
+    GList *handlers;
+} TypeHandlers;
+
+static GList      *untyped_handlers = NULL;
+static GHashTable *type_handlers    = NULL;   /* QofIdType -> TypeHandlers */
+static guint       n_live_handlers  = 0;
+
+/* The current event batch: the entries, and a guid -> entry index. */
+static guint       batch_level      = 0;
+static guint       n_batch_handlers = 0;
+static GPtrArray  *batch_entries    = NULL;
+static GHashTable *batch_index      = NULL;
+
+/* Counts for qof_event_get_handler_counts */
+static guint64 handlers_invoked = 0;
+static guint64 handlers_avoided = 0;
+static guint64 handlers_batched = 0;
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -68,13 +93,61 @@ find_next_handler_id(void)
     return handler_id;
 }
 
+static TypeHandlers *
+get_type_handlers (QofIdTypeConst type, gboolean create)
+{
+    TypeHandlers *th;
+
+    if (!type_handlers)
+    {
+        if (!create) return NULL;
+        type_handlers = g_hash_table_new (g_str_hash, g_str_equal);
+    }
+    th = g_hash_table_lookup (type_handlers, type);
+    if (!th && create)
+    {
+        th = g_new0 (TypeHandlers, 1);
+        g_hash_table_insert (type_handlers,
+                             (gpointer) qof_string_cache_insert (type), th);
+    }
+    return th;
+}
+
 gint
 qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+{
+    return qof_event_register_filtered_handler (handler, user_data, 0, NULL);
+}
+
+gint
+qof_event_register_batch_handler (QofEventHandler handler,
+                                  QofEventBatchHandler batch_handler,
+                                  gpointer user_data)
+{
+    gint handler_id;
+
+    handler_id = qof_event_register_filtered_handler (handler, user_data,
+                 0, NULL);
+    if (handler_id && batch_handler)
+    {
+        /* The new handler is at the head of the list. */
+        HandlerInfo *hi = handlers->data;
+        hi->batch_handler = batch_handler;
+        n_batch_handlers++;
+    }
+    return handler_id;
+}
+
+gint
+qof_event_register_filtered_handler (QofEventHandler handler,
+                                     gpointer user_data,
+                                     QofEventId event_mask,
+                                     const QofIdTypeConst *types)
 {
     HandlerInfo *hi;
     gint handler_id;
 
-    ENTER ("(handler=%p, data=%p)", handler, user_data);
+    ENTER ("(handler=%p, data=%p, mask=%x)", handler, user_data, event_mask);
 
     /* sanity check */
     if (!handler)
@@ -92,12 +165,48 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
     hi->handler = handler;
     hi->user_data = user_data;
     hi->handler_id = handler_id;
+    hi->event_mask = event_mask;
+    hi->seq = next_handler_seq++;
 
     handlers = g_list_prepend (handlers, hi);
+    n_live_handlers++;
+
+    if (types && *types)
+    {
+        for (; *types; types++)
+        {
+            TypeHandlers *th = get_type_handlers (*types, TRUE);
+            th->handlers = g_list_prepend (th->handlers, hi);
+        }
+    }
+    else
+    {
+        untyped_handlers = g_list_prepend (untyped_handlers, hi);
+    }
+
     LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
     return handler_id;
 }
 
+static void
+remove_from_type_handlers (gpointer key, gpointer value, gpointer hi)
+{
+    TypeHandlers *th = value;
+    th->handlers = g_list_remove (th->handlers, hi);
+}
+
+/* Drop the handler from the dispatch lists and the handlers list,
+ * whose node it is, and free it. */
+static void
+handler_info_free (HandlerInfo *hi, GList *node)
+{
+    untyped_handlers = g_list_remove (untyped_handlers, hi);
+    if (type_handlers)
+        g_hash_table_foreach (type_handlers, remove_from_type_handlers, hi);
+    handlers = g_list_delete_link (handlers, node);
+    g_free (hi);
+}
+
 void
 qof_event_unregister_handler (gint handler_id)
 {
@@ -121,13 +230,17 @@ qof_event_unregister_handler (gint handler_id)
                    hi->handler, hi->user_data);
 
         /* safety -- clear the handler in case we're running events now */
+        if (hi->handler)
+        {
+            n_live_handlers--;
+            if (hi->batch_handler)
+                n_batch_handlers--;
+        }
         hi->handler = NULL;
 
         if (handler_run_level == 0)
         {
-            handlers = g_list_remove_link (handlers, node);
-            g_list_free_1 (node);
-            g_free (hi);
+            handler_info_free (hi, node);
         }
         else
         {
@@ -163,12 +276,115 @@ qof_event_resume (void)
     suspend_counter--;
 }
 
+/* If we're the outermost event runner and we have pending deletes
+ * then go delete the handlers now.
+ */
+static void
+purge_deleted_handlers (void)
+{
+    GList *node, *next_node;
+
+    if (handler_run_level != 0 || !pending_deletes)
+        return;
+
+    for (node = handlers; node; node = next_node)
+    {
+        HandlerInfo *hi = node->data;
+        next_node = node->next;
+        if (hi->handler == NULL)
+        {
+            /* remove this node from the lists, then free this node */
+            handler_info_free (hi, node);
+        }
+    }
+    pending_deletes = 0;
+}
+
+/* Fold the event into the entity's entry of the current batch. */
+static void
+batch_add_event (QofInstance *entity, QofEventId event_id)
+{
+    const GncGUID *guid = qof_instance_get_guid (entity);
+    QofEventBatchEntry *entry;
+
+    if (!batch_entries)
+    {
+        batch_entries = g_ptr_array_new ();
+        batch_index = guid_hash_table_new ();
+    }
+
+    entry = g_hash_table_lookup (batch_index, guid);
+    if (!entry)
+    {
+        entry = g_new0 (QofEventBatchEntry, 1);
+        entry->guid = *guid;
+        if (entity->e_type)
+            entry->type = qof_string_cache_insert (entity->e_type);
+        g_ptr_array_add (batch_entries, entry);
+        g_hash_table_insert (batch_index, &entry->guid, entry);
+    }
+    entry->event_mask |= event_id;
+}
+
+void
+qof_event_begin_batch (void)
+{
+    batch_level++;
+}
+
+void
+qof_event_end_batch (void)
+{
+    GPtrArray *entries;
+    GList *node, *next_node;
+    guint i;
+
+    if (batch_level == 0)
+    {
+        PERR ("batch level underflow");
+        return;
+    }
+    if (--batch_level > 0 || !batch_entries)
+        return;
+
+    /* Handlers may start batches of their own. */
+    entries = batch_entries;
+    g_hash_table_destroy (batch_index);
+    batch_entries = NULL;
+    batch_index = NULL;
+
+    handler_run_level++;
+    for (node = handlers; node; node = next_node)
+    {
+        HandlerInfo *hi = node->data;
+
+        next_node = node->next;
+        if (hi->handler && hi->batch_handler)
+            hi->batch_handler (entries, hi->user_data);
+    }
+    handler_run_level--;
+    purge_deleted_handlers ();
+
+    for (i = 0; i < entries->len; i++)
+    {
+        QofEventBatchEntry *entry = g_ptr_array_index (entries, i);
+        if (entry->type)
+            qof_string_cache_remove (entry->type);
+        g_free (entry);
+    }
+    g_ptr_array_free (entries, TRUE);
+}
+
 static void
 qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
                              gpointer event_data)
 {
     GList *node;
-    GList *next_node = NULL;
+    GList *untyped, *typed = NULL;
+    gboolean batching = batch_level > 0 && n_batch_handlers > 0;
+    guint n_live = n_live_handlers;
+    guint n_invoked = 0;
+    guint n_batched = 0;
 
     g_return_if_fail(entity);
 
@@ -181,40 +397,58 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
     }
     }
 
+    if (batching)
+        batch_add_event (entity, event_id);
+
+    if (entity->e_type)
+    {
+        TypeHandlers *th = get_type_handlers (entity->e_type, FALSE);
+        if (th)
+            typed = th->handlers;
+    }
+    untyped = untyped_handlers;
+
+    /* Merge the two lists, newest handler first as before. */
     handler_run_level++;
-    for (node = handlers; node; node = next_node)
+    while (untyped || typed)
     {
-        HandlerInfo *hi = node->data;
+        HandlerInfo *hi;
 
-        next_node = node->next;
-        if (hi->handler)
+        if (!typed || (untyped && ((HandlerInfo *) untyped->data)->seq >
+                       ((HandlerInfo *) typed->data)->seq))
+        {
+            node = untyped;
+            untyped = untyped->next;
+        }
+        else
+        {
+            node = typed;
+            typed = typed->next;
+        }
+
+        hi = node->data;
+        if (batching && hi->batch_handler)
+        {
+            if (hi->handler)
+                n_batched++;
+            continue;
+        }
+        if (hi->handler && (!hi->event_mask || (hi->event_mask & event_id)))
         {
             PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
                   hi->handler, event_data);
+            n_invoked++;
             hi->handler (entity, event_id, hi->user_data, event_data);
         }
     }
     handler_run_level--;
 
-    /* If we're the outermost event runner and we have pending deletes
-     * then go delete the handlers now.
-     */
-    if (handler_run_level == 0 && pending_deletes)
-    {
-        for (node = handlers; node; node = next_node)
-        {
-            HandlerInfo *hi = node->data;
-            next_node = node->next;
-            if (hi->handler == NULL)
-            {
-                /* remove this node from the list, then free this node */
-                handlers = g_list_remove_link (handlers, node);
-                g_list_free_1 (node);
-                g_free (hi);
-            }
-        }
-        pending_deletes = 0;
-    }
+    handlers_invoked += n_invoked;
+    handlers_batched += n_batched;
+    if (n_live > n_invoked + n_batched)
+        handlers_avoided += n_live - n_invoked - n_batched;
+
+    purge_deleted_handlers ();
 }
 
 void
@@ -233,9 +467,38 @@ qof_event_gen (QofInstance *entity, QofEventId event_id, gpointer event_data)
         return;
 
     if (suspend_counter)
+    {
+        dropped_events++;
         return;
+    }
 
     qof_event_generate_internal (entity, event_id, event_data);
 }
 
+guint64
+qof_event_get_dropped_count (void)
+{
+    return dropped_events;
+}
+
+void
+qof_event_get_handler_counts (guint64 *invoked, guint64 *avoided,
+                              guint64 *batched)
+{
+    if (invoked)
+        *invoked = handlers_invoked;
+    if (avoided)
+        *avoided = handlers_avoided;
+    if (batched)
+        *batched = handlers_batched;
+}
+
+void
+qof_event_reset_handler_counts (void)
+{
+    handlers_invoked = 0;
+    handlers_avoided = 0;
+    handlers_batched = 0;
+}
+
 /* =========================== END OF FILE ======================= */
@@ -93,6 +93,58 @@ typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
  */
 gint qof_event_register_handler (QofEventHandler handler, gpointer handler_data);
 
+/** \brief Register a handler for some events of some entity types.
+ *
+ * The handler is only invoked for events in event_mask that are
+ * generated by entities of one of the given types, so the events it
+ * would ignore are never dispatched to it.  Handlers are invoked in
+ * the same order as those registered with qof_event_register_handler.
+ *
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ * @param event_mask: the events to deliver, or 0 for all events
+ * @param types: NULL terminated array of entity types, or NULL for
+ * all types
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_filtered_handler (QofEventHandler handler,
+        gpointer handler_data,
+        QofEventId event_mask,
+        const QofIdTypeConst *types);
+
+/** \brief All the events one entity generated during an event batch. */
+typedef struct
+{
+    GncGUID guid;
+    QofIdType type;           /**< the entity's type, in the string cache */
+    QofEventId event_mask;    /**< the events or'ed together */
+} QofEventBatchEntry;
+
+/** \brief Handler invoked at the end of an event batch.
+ *
+ * @param entries: a QofEventBatchEntry for each entity that generated
+ * events during the batch.  The entities may no longer exist.
+ * @param handler_data: data supplied when handler was registered.
+ */
+typedef void (*QofEventBatchHandler) (const GPtrArray *entries,
+                                      gpointer handler_data);
+
+/** \brief Register a handler that coalesces batched events.
+ *
+ * Outside of a batch, handler is invoked for every event like one
+ * registered with qof_event_register_handler.  Events generated
+ * between qof_event_begin_batch and qof_event_end_batch are not passed
+ * to it; instead batch_handler is invoked once at the end of the batch
+ * with one entry per entity.  Only handlers that need neither the
+ * order of the events nor their event_data should use this.
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_batch_handler (QofEventHandler handler,
+                                       QofEventBatchHandler batch_handler,
+                                       gpointer handler_data);
+
 /** \brief Unregister an event handler.
  *
  * @param handler_id: the id of the handler to unregister
@@ -134,5 +186,34 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** Return how many events qof_event_gen has dropped because events
+ *  were suspended.  Caches kept current from events can compare it
+ *  with the value they saw when they were last in step, and rebuild
+ *  when it has changed. */
+guint64 qof_event_get_dropped_count (void);
+
+/** \brief Start a batch of events.
+ *
+ * Bulk operations that generate many events should bracket them with
+ * qof_event_begin_batch and qof_event_end_batch, see
+ * qof_event_register_batch_handler.  Batches may be nested; the events
+ * are delivered at the end of the outermost one.
+ */
+void qof_event_begin_batch (void);
+
+/** End a batch of events started with qof_event_begin_batch. */
+void qof_event_end_batch (void);
+
+/** Return how many handler invocations events have caused, how many
+ *  were avoided because the handlers registered for other types or
+ *  events, and how many were left to the batch handlers of a batch in
+ *  progress, since the last qof_event_reset_handler_counts().  Any of
+ *  the pointers may be NULL. */
+void qof_event_get_handler_counts (guint64 *invoked, guint64 *avoided,
+                                   guint64 *batched);
+
+/** Reset the counts returned by qof_event_get_handler_counts(). */
+void qof_event_reset_handler_counts (void);
+
 #endif
 /** @} */
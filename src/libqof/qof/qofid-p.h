@@ -46,6 +46,11 @@ void qof_collection_mark_clean (QofCollection *);
 void qof_collection_mark_dirty (QofCollection *);
 void qof_collection_print_dirty (const QofCollection *col, gpointer dummy);
 
+/** Make a new guid with the md5 generator, which guid_new() only falls
+ *  back to when there is no random device.  Exported so that the two
+ *  generators can be compared. */
+void guid_new_md5 (GncGUID *guid);
+
 /* @} */
 /* @} */
 /* @} */
@@ -33,12 +33,33 @@
 static QofLogModule log_module = QOF_MOD_ENGINE;
 static gboolean qof_alt_dirty_mode = FALSE;
 
+/* Collections map guids to instances with an open-addressing table
+ * specialised for guid keys.  Each slot holds a copy of the 16 byte
+ * key, compared as two 64 bit words, so a probe touches no other
+ * memory.  Slots are found by linear probing from the guid hash.
+ * Removed entries leave a tombstone, so probe chains stay intact,
+ * and the table is rebuilt when live entries plus tombstones pass
+ * three quarters of its size. */
+typedef struct
+{
+    guint64       key[2];
+    QofInstance * ent;
+} QofCollectionSlot;
+
+static gchar collection_tombstone;
+#define COLLECTION_TOMBSTONE ((QofInstance *) &collection_tombstone)
+#define COLLECTION_MIN_SLOTS 16
+
 struct QofCollection_s
 {
     QofIdType    e_type;
     gboolean     is_dirty;
 
-    GHashTable * hash_of_entities;
+    QofCollectionSlot * slots;
+    guint        n_slots;    /* zero or a power of two */
+    guint        n_live;
+    guint        n_used;     /* live entries plus tombstones */
+    GType        ent_type;   /* GType of the first instance inserted */
     gpointer     data;       /* place where object class can hang arbitrary data */
 };
 
@@ -58,13 +79,121 @@ qof_set_alt_dirty_mode (gboolean enabled)
 
 /* =============================================================== */
 
+/* Return the slot holding key, or if there is none, the slot where
+ * it should be inserted.  The table must have a free slot. */
+static QofCollectionSlot *
+collection_probe (const QofCollection *col, const GncGUID *guid,
+                  const guint64 *key, gboolean *found)
+{
+    QofCollectionSlot *free_slot = NULL;
+    guint mask = col->n_slots - 1;
+    guint i = guid_hash_to_guint (guid) & mask;
+
+    while (1)
+    {
+        QofCollectionSlot *slot = &col->slots[i];
+
+        if (slot->ent == NULL)
+        {
+            *found = FALSE;
+            return free_slot ? free_slot : slot;
+        }
+        if (slot->ent == COLLECTION_TOMBSTONE)
+        {
+            if (!free_slot)
+                free_slot = slot;
+        }
+        else if (slot->key[0] == key[0] && slot->key[1] == key[1])
+        {
+            *found = TRUE;
+            return slot;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+/* Rebuild the table with room for at least n entries, dropping the
+ * tombstones. */
+static void
+collection_resize (QofCollection *col, guint n)
+{
+    QofCollectionSlot *old_slots = col->slots;
+    guint old_n_slots = col->n_slots;
+    guint size = COLLECTION_MIN_SLOTS;
+    guint i;
+
+    while (size / 2 < n)
+        size *= 2;
+
+    col->slots = g_new0 (QofCollectionSlot, size);
+    col->n_slots = size;
+    col->n_used = col->n_live;
+
+    for (i = 0; i < old_n_slots; i++)
+    {
+        QofCollectionSlot *slot = &old_slots[i];
+        QofCollectionSlot *dest;
+        gboolean found;
+
+        if (slot->ent == NULL || slot->ent == COLLECTION_TOMBSTONE)
+            continue;
+        dest = collection_probe (col, (const GncGUID *) slot->key,
+                                 slot->key, &found);
+        *dest = *slot;
+    }
+    g_free (old_slots);
+}
+
+static void
+collection_insert (QofCollection *col, const GncGUID *guid, QofInstance *ent)
+{
+    QofCollectionSlot *slot;
+    guint64 key[2];
+    gboolean found;
+
+    if ((col->n_used + 1) * 4 > col->n_slots * 3)
+        collection_resize (col, col->n_live + 1);
+
+    memcpy (key, guid->data, sizeof (key));
+    slot = collection_probe (col, guid, key, &found);
+    if (!found)
+    {
+        if (slot->ent == NULL)
+            col->n_used++;
+        col->n_live++;
+        slot->key[0] = key[0];
+        slot->key[1] = key[1];
+    }
+    slot->ent = ent;
+    if (col->ent_type == G_TYPE_INVALID)
+        col->ent_type = G_OBJECT_TYPE (ent);
+}
+
+static void
+collection_remove (QofCollection *col, const GncGUID *guid)
+{
+    QofCollectionSlot *slot;
+    guint64 key[2];
+    gboolean found;
+
+    if (!col->n_live) return;
+    memcpy (key, guid->data, sizeof (key));
+    slot = collection_probe (col, guid, key, &found);
+    if (!found) return;
+    slot->ent = COLLECTION_TOMBSTONE;
+    col->n_live--;
+}
+
+/* =============================================================== */
+
 QofCollection *
 qof_collection_new (QofIdType type)
 {
     QofCollection *col;
     col = g_new0(QofCollection, 1);
     col->e_type = CACHE_INSERT (type);
-    col->hash_of_entities = guid_hash_table_new();
+    /* The table is allocated on the first insert. */
+    col->slots = NULL;
     col->data = NULL;
     return col;
 }
@@ -73,9 +202,9 @@ void
 qof_collection_destroy (QofCollection *col)
 {
     CACHE_REMOVE (col->e_type);
-    g_hash_table_destroy(col->hash_of_entities);
+    g_free(col->slots);
     col->e_type = NULL;
-    col->hash_of_entities = NULL;
+    col->slots = NULL;
     col->data = NULL;   /** XXX there should be a destroy notifier for this */
     g_free (col);
 }
@@ -89,6 +218,28 @@ qof_collection_get_type (const QofCollection *col)
     return col->e_type;
 }
 
+GType
+qof_collection_get_instance_type (const QofCollection *col)
+{
+    return col->ent_type;
+}
+
+QofInstance *
+qof_collection_get_any_entity (const QofCollection *col)
+{
+    guint i;
+
+    g_return_val_if_fail (col, NULL);
+    if (!col->n_live) return NULL;
+    for (i = 0; i < col->n_slots; i++)
+    {
+        QofInstance *ent = col->slots[i].ent;
+        if (ent != NULL && ent != COLLECTION_TOMBSTONE)
+            return ent;
+    }
+    return NULL;
+}
+
 /* =============================================================== */
 
 void
@@ -101,7 +252,7 @@ qof_collection_remove_entity (QofInstance *ent)
     col = qof_instance_get_collection(ent);
     if (!col) return;
     guid = qof_instance_get_guid(ent);
-    g_hash_table_remove (col->hash_of_entities, guid);
+    collection_remove (col, guid);
     if (!qof_alt_dirty_mode)
         qof_collection_mark_dirty(col);
     qof_instance_set_collection(ent, NULL);
@@ -117,7 +268,7 @@ qof_collection_insert_entity (QofCollection *col, QofInstance *ent)
     if (guid_equal(guid, guid_null())) return;
     g_return_if_fail (col->e_type == ent->e_type);
     qof_collection_remove_entity (ent);
-    g_hash_table_insert (col->hash_of_entities, (gpointer)guid, ent);
+    collection_insert (col, guid, ent);
     if (!qof_alt_dirty_mode)
         qof_collection_mark_dirty(col);
     qof_instance_set_collection(ent, col);
@@ -145,7 +296,7 @@ qof_collection_add_entity (QofCollection *coll, QofInstance *ent)
     {
         return FALSE;
     }
-    g_hash_table_insert (coll->hash_of_entities, (gpointer)guid, ent);
+    collection_insert (coll, guid, ent);
     if (!qof_alt_dirty_mode)
         qof_collection_mark_dirty(coll);
     return TRUE;
@@ -231,11 +382,25 @@ qof_collection_compare (QofCollection *target, QofCollection *merge)
 QofInstance *
 qof_collection_lookup_entity (const QofCollection *col, const GncGUID * guid)
 {
-    QofInstance *ent;
+    QofCollectionSlot *slot;
+    guint64 key[2];
+    gboolean found;
+
     g_return_val_if_fail (col, NULL);
     if (guid == NULL) return NULL;
-    ent = g_hash_table_lookup (col->hash_of_entities, guid);
-    return ent;
+    if (!col->n_live) return NULL;
+
+    memcpy (key, guid->data, sizeof (key));
+    slot = collection_probe (col, guid, key, &found);
+    return found ? slot->ent : NULL;
+}
+
+void
+qof_collection_reserve (QofCollection *col, guint n_entities)
+{
+    g_return_if_fail (col);
+    if ((guint64) n_entities * 4 > (guint64) col->n_slots * 3)
+        collection_resize (col, n_entities);
 }
 
 QofCollection *
@@ -260,10 +425,7 @@ qof_collection_from_glist (QofIdType type, const GList *glist)
 guint
 qof_collection_count (const QofCollection *col)
 {
-    guint c;
-
-    c = g_hash_table_size(col->hash_of_entities);
-    return c;
+    return col->n_live;
 }
 
 /* =============================================================== */
@@ -319,40 +481,30 @@ qof_collection_set_data (QofCollection *col, gpointer user_data)
 
 /* =============================================================== */
 
-struct _iterate
-{
-    QofInstanceForeachCB      fcn;
-    gpointer                data;
-};
-
-static void
-foreach_cb (gpointer item, gpointer arg)
-{
-    struct _iterate *iter = arg;
-    QofInstance *ent = item;
-
-    iter->fcn (ent, iter->data);
-}
-
 void
 qof_collection_foreach (const QofCollection *col, QofInstanceForeachCB cb_func,
                         gpointer user_data)
 {
-    struct _iterate iter;
-    GList *entries;
+    QofInstance **entries;
+    guint i, n = 0;
 
     g_return_if_fail (col);
     g_return_if_fail (cb_func);
 
-    iter.fcn = cb_func;
-    iter.data = user_data;
-
-    PINFO("Hash Table size of %s before is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s before is %d", col->e_type, col->n_live);
 
-    entries = g_hash_table_get_values (col->hash_of_entities);
-    g_list_foreach (entries, foreach_cb, &iter);
-    g_list_free (entries);
+    /* Work on a copy, the callback may add or remove entities. */
+    entries = g_new (QofInstance *, col->n_live + 1);
+    for (i = 0; i < col->n_slots; i++)
+    {
+        QofInstance *ent = col->slots[i].ent;
+        if (ent != NULL && ent != COLLECTION_TOMBSTONE)
+            entries[n++] = ent;
+    }
+    for (i = 0; i < n; i++)
+        cb_func (entries[i], user_data);
+    g_free (entries);
 
-    PINFO("Hash Table size of %s after is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s after is %d", col->e_type, col->n_live);
 }
 /* =============================================================== */
@@ -135,7 +135,7 @@ print error message if its bad  */
 
 @param e_type QofIdType
 @param is_dirty gboolean
-@param hash_of_entities GHashTable
+@param slots open-addressing table of guid copies and their instances
 @param data gpointer, place where object class can hang arbitrary data
 
 */
@@ -167,16 +167,29 @@ QofCollection * qof_collection_new (QofIdType type);
 /** return the number of entities in the collection. */
 guint qof_collection_count (const QofCollection *col);
 
+/** Make room for n_entities entities in the collection, so that
+ *  inserting that many does not have to grow it.  Loaders that know
+ *  how many objects are coming can call this first. */
+void qof_collection_reserve (QofCollection *col, guint n_entities);
+
 /** destroy the collection */
 void qof_collection_destroy (QofCollection *col);
 
 /** return the type that the collection stores */
 QofIdType qof_collection_get_type (const QofCollection *);
 
+/** return the GType of the instances the collection stores, or
+ *  G_TYPE_INVALID if nothing was ever added to it */
+GType qof_collection_get_instance_type (const QofCollection *);
+
 /** Find the entity going only from its guid */
 /*@ dependent @*/
 QofInstance * qof_collection_lookup_entity (const QofCollection *, const GncGUID *);
 
+/** Return some entity of the collection, or NULL if it is empty */
+/*@ dependent @*/
+QofInstance * qof_collection_get_any_entity (const QofCollection *);
+
 /** Callback type for qof_collection_foreach */
 typedef void (*QofInstanceForeachCB) (QofInstance *, gpointer user_data);
 
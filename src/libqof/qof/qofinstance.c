@@ -138,6 +138,7 @@ static void qof_instance_class_init(QofInstanceClass *klass)
     klass->get_display_name = NULL;
     klass->refers_to_object = NULL;
     klass->get_typed_referring_object_list = NULL;
+    klass->get_references = NULL;
 
     g_object_class_install_property
     (object_class,
@@ -321,6 +322,8 @@ qof_instance_init_data (QofInstance *inst, QofIdType type, QofBook *book)
     qof_collection_insert_entity (col, inst);
 }
 
+static void reference_index_update (QofInstance* inst, gboolean keep);
+
 static void
 qof_instance_dispose (GObject *instp)
 {
@@ -330,6 +333,7 @@ qof_instance_dispose (GObject *instp)
     priv = GET_PRIVATE(instp);
     if (!priv->collection)
         return;
+    reference_index_update (inst, FALSE);
     qof_collection_remove_entity(inst);
 
     CACHE_REMOVE(inst->e_type);
@@ -839,30 +843,214 @@ typedef struct
     GList* list;
 } GetReferringObjectHelperData;
 
+/* The class of the instances of the collection, or NULL if it never had
+ * any. */
+static QofInstanceClass*
+collection_instance_class(const QofCollection* coll)
+{
+    GType type = qof_collection_get_instance_type(coll);
+
+    if (type == G_TYPE_INVALID)
+        return NULL;
+    return g_type_class_peek(type);
+}
+
+/* The index of references of a book.  Objects whose class provides
+ * get_references are indexed by the GUIDs of the objects they refer
+ * to, so that the objects referring to an object can be found without
+ * asking every object of the book.  The index is built on the first
+ * question and then kept up to date on each commit. */
+#define REFERENCE_INDEX "qof-reference-index"
+
+typedef struct
+{
+    GHashTable* referrers;      /* GncGUID* -> set of QofInstance* */
+    GHashTable* references;     /* QofInstance* -> GList of GncGUID* */
+} ReferenceIndex;
+
 static void
-get_referring_object_instance_helper(QofInstance* inst, gpointer user_data)
+reference_index_remove (ReferenceIndex* index, QofInstance* inst)
 {
-    QofInstance** pInst = (QofInstance**)user_data;
+    GList* refs;
+    GList* node;
 
-    if (*pInst == NULL)
+    refs = g_hash_table_lookup (index->references, inst);
+    for (node = refs; node; node = node->next)
     {
-        *pInst = inst;
+        GHashTable* set = g_hash_table_lookup (index->referrers, node->data);
+
+        if (set)
+        {
+            g_hash_table_remove (set, inst);
+            if (g_hash_table_size (set) == 0)
+                g_hash_table_remove (index->referrers, node->data);
+        }
+        guid_free (node->data);
     }
+    g_list_free (refs);
+    g_hash_table_remove (index->references, inst);
 }
 
 static void
-get_referring_object_helper(QofCollection* coll, gpointer user_data)
+reference_index_add (ReferenceIndex* index, QofInstance* inst)
 {
-    QofInstance* first_instance = NULL;
-    GetReferringObjectHelperData* data = (GetReferringObjectHelperData*)user_data;
+    GList* refs;
+    GList* node;
+    GList* guids = NULL;
 
-    qof_collection_foreach(coll, get_referring_object_instance_helper, &first_instance);
+    refs = QOF_INSTANCE_GET_CLASS(inst)->get_references (inst);
+    for (node = refs; node; node = node->next)
+    {
+        const GncGUID* guid;
+        GHashTable* set;
+
+        if (node->data == NULL)
+            continue;
+        guid = qof_instance_get_guid (node->data);
+        set = g_hash_table_lookup (index->referrers, guid);
+        if (set == NULL)
+        {
+            set = g_hash_table_new (g_direct_hash, g_direct_equal);
+            g_hash_table_insert (index->referrers, guid_copy (guid), set);
+        }
+        g_hash_table_insert (set, inst, inst);
+        guids = g_list_prepend (guids, guid_copy (guid));
+    }
+    g_list_free (refs);
+
+    if (guids)
+        g_hash_table_insert (index->references, inst, guids);
+}
+
+static void
+reference_index_add_instance (QofInstance* inst, gpointer user_data)
+{
+    reference_index_add (user_data, inst);
+}
+
+static void
+reference_index_add_collection (QofCollection* coll, gpointer user_data)
+{
+    QofInstanceClass* klass = collection_instance_class(coll);
+
+    if (klass != NULL && klass->get_references != NULL)
+        qof_collection_foreach(coll, reference_index_add_instance, user_data);
+}
+
+static void
+reference_index_free (QofBook* book, gpointer key, gpointer user_data)
+{
+    ReferenceIndex* index = user_data;
+    GHashTableIter iter;
+    gpointer refs;
+
+    g_hash_table_iter_init (&iter, index->references);
+    while (g_hash_table_iter_next (&iter, NULL, &refs))
+        g_list_free_full (refs, (GDestroyNotify)guid_free);
+    g_hash_table_destroy (index->references);
+    g_hash_table_destroy (index->referrers);
+    g_free (index);
+}
 
-    if (first_instance != NULL)
+static ReferenceIndex*
+reference_index_get (QofBook* book)
+{
+    ReferenceIndex* index;
+
+    index = qof_book_get_data (book, REFERENCE_INDEX);
+    if (index)
+        return index;
+
+    index = g_new0 (ReferenceIndex, 1);
+    index->referrers = g_hash_table_new_full (guid_hash_to_guint,
+                       guid_g_hash_table_equal,
+                       (GDestroyNotify)guid_free,
+                       (GDestroyNotify)g_hash_table_destroy);
+    index->references = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qof_book_foreach_collection (book, reference_index_add_collection, index);
+    qof_book_set_data_fin (book, REFERENCE_INDEX, index, reference_index_free);
+    return index;
+}
+
+static void
+reference_index_update (QofInstance* inst, gboolean keep)
+{
+    QofInstancePrivate* priv;
+    ReferenceIndex* index;
+
+    if (QOF_INSTANCE_GET_CLASS(inst)->get_references == NULL)
+        return;
+
+    /* Nothing to do before the first question */
+    priv = GET_PRIVATE(inst);
+    if (!priv->book || qof_book_shutting_down (priv->book))
+        return;
+    index = qof_book_get_data (priv->book, REFERENCE_INDEX);
+    if (!index)
+        return;
+
+    reference_index_remove (index, inst);
+    if (keep)
+        reference_index_add (index, inst);
+}
+
+void
+qof_instance_references_changed (QofInstance* inst)
+{
+    g_return_if_fail (QOF_IS_INSTANCE(inst));
+    reference_index_update (inst, !GET_PRIVATE(inst)->do_free);
+}
+
+/* The objects of the collection, or of any collection if coll is NULL,
+ * that refer to ref according to the index of references. */
+static GList*
+reference_index_lookup (const QofCollection* coll, const QofInstance* ref)
+{
+    QofBook* book = qof_instance_get_book (ref);
+    ReferenceIndex* index;
+    GHashTable* set;
+    GHashTableIter iter;
+    gpointer inst;
+    GList* list = NULL;
+
+    if (book == NULL)
+        return NULL;
+    index = reference_index_get (book);
+    set = g_hash_table_lookup (index->referrers, qof_instance_get_guid (ref));
+    if (set == NULL)
+        return NULL;
+
+    g_hash_table_iter_init (&iter, set);
+    while (g_hash_table_iter_next (&iter, &inst, NULL))
     {
-        GList* new_list = qof_instance_get_typed_referring_object_list(first_instance, data->inst);
-        data->list = g_list_concat(data->list, new_list);
+        if (coll && qof_instance_get_collection (inst) != coll)
+            continue;
+        if (qof_instance_refers_to_object (inst, ref))
+            list = g_list_prepend (list, inst);
     }
+    return list;
+}
+
+static void
+get_referring_object_helper(QofCollection* coll, gpointer user_data)
+{
+    GetReferringObjectHelperData* data = (GetReferringObjectHelperData*)user_data;
+    QofInstanceClass* klass = collection_instance_class(coll);
+    QofInstance* first_instance;
+
+    /* Indexed types are answered from the index, and types which can't
+     * refer to anything need not be asked. */
+    if (klass == NULL || klass->get_references != NULL ||
+            (klass->refers_to_object == NULL &&
+             klass->get_typed_referring_object_list == NULL))
+        return;
+
+    first_instance = qof_collection_get_any_entity(coll);
+    if (first_instance == NULL)
+        return;
+
+    data->list = g_list_concat(data->list,
+                               qof_instance_get_typed_referring_object_list(first_instance, data->inst));
 }
 
 /* Returns a list of objects referring to this object */
@@ -872,14 +1060,14 @@ GList* qof_instance_get_referring_object_list(const QofInstance* inst)
 
     g_return_val_if_fail( inst != NULL, NULL );
 
-    /* scan all collections */
+    /* scan the collections of types without an index */
     data.inst = inst;
     data.list = NULL;
 
     qof_book_foreach_collection(qof_instance_get_book(inst),
                                 get_referring_object_helper,
                                 &data);
-    return data.list;
+    return g_list_concat(data.list, reference_index_lookup(NULL, inst));
 }
 
 static void
@@ -897,6 +1085,7 @@ GList*
 qof_instance_get_referring_object_list_from_collection(const QofCollection* coll, const QofInstance* ref)
 {
     GetReferringObjectHelperData data;
+    QofInstanceClass* klass;
 
     g_return_val_if_fail( coll != NULL, NULL );
     g_return_val_if_fail( ref != NULL, NULL );
@@ -904,6 +1093,10 @@ qof_instance_get_referring_object_list_from_collection(const QofCollection* coll
     data.inst = ref;
     data.list = NULL;
 
+    klass = collection_instance_class(coll);
+    if (klass != NULL && klass->get_references != NULL)
+        return reference_index_lookup(coll, ref);
+
     qof_collection_foreach(coll, get_typed_referring_object_instance_helper, &data);
     return data.list;
 }
@@ -1038,6 +1231,8 @@ qof_commit_edit_part2(QofInstance *inst,
 //    }
     priv->infant = FALSE;
 
+    qof_instance_references_changed (inst);
+
     if (priv->do_free)
     {
         if (on_free)
@@ -87,6 +87,12 @@ struct _QofInstanceClass
 
     /* Returns a list of my type of object which refers to an object */
     GList* (*get_typed_referring_object_list)(const QofInstance* inst, const QofInstance* ref);
+
+    /* Returns the list of objects this object refers to, which must be
+     * the objects for which refers_to_object returns TRUE.  Objects of
+     * a class providing it are kept in an index of references of the
+     * book, which is updated when they are committed. */
+    GList* (*get_references)(const QofInstance* inst);
 };
 
 /** Return the GType of a QofInstance */
@@ -247,6 +253,12 @@ gboolean qof_instance_refers_to_object(const QofInstance* inst, const QofInstanc
  */
 GList* qof_instance_get_typed_referring_object_list(const QofInstance* inst, const QofInstance* ref);
 
+/** Update the book's index of references for an object whose
+    references were changed without a commit of the object.  Changes
+    made between a begin and a commit edit are picked up by the commit.
+ */
+void qof_instance_references_changed (QofInstance* inst);
+
 /** Returns a list of objects from the collection which refer to the specific object.  The list must be
     freed by the caller but the objects on the list must not.
  */
@@ -225,6 +225,23 @@ qof_object_foreach (QofIdTypeConst type_name, QofBook *book,
     return;
 }
 
+gboolean
+qof_object_foreach_query_match (QofIdTypeConst type_name, QofBook *book,
+                                GList *and_terms, QofInstanceForeachCB cb,
+                                gpointer user_data)
+{
+    const QofObject *obj;
+
+    if (!book || !type_name || !and_terms)
+        return FALSE;
+
+    obj = qof_object_lookup (type_name);
+    if (!obj || !obj->foreach_query_match)
+        return FALSE;
+
+    return obj->foreach_query_match (book, and_terms, cb, user_data);
+}
+
 static void
 do_prepend (QofInstance *qof_p, gpointer list_p)
 {
@@ -119,6 +119,18 @@ struct _QofObject
      *  to or later than than 'instance_right'.
      */
     int                 (*version_cmp)(gpointer instance_left, gpointer instance_right);
+
+    /** Optional access path for queries.  Given a list of query terms
+     *  that are ANDed together, call the callback on the items of the
+     *  book that could satisfy them, found through an index kept by the
+     *  object instead of a walk over the whole collection.  Items that
+     *  fail some of the terms may be passed as well; the query checks
+     *  every term on the items it is given.  Return FALSE, without
+     *  calling the callback, if none of the terms can be used; the
+     *  query then falls back to (*foreach).
+     */
+    gboolean            (*foreach_query_match)(QofBook *, GList *and_terms,
+            QofInstanceForeachCB, gpointer);
 };
 
 /* -------------------------------------------------------------- */
@@ -162,6 +174,16 @@ void qof_object_foreach_type (QofForeachTypeCB cb, gpointer user_data);
 void qof_object_foreach (QofIdTypeConst type_name, QofBook *book,
                          QofInstanceForeachCB cb, gpointer user_data);
 
+/** Invoke the callback 'cb' on the instances of a particular object
+ *  type that could satisfy the ANDed query terms 'and_terms', using the
+ *  (*foreach_query_match) access path of the object.  Returns FALSE,
+ *  without invoking the callback, if the object has no access path for
+ *  these terms.
+ */
+gboolean qof_object_foreach_query_match (QofIdTypeConst type_name,
+        QofBook *book, GList *and_terms,
+        QofInstanceForeachCB cb, gpointer user_data);
+
 /** Invoke callback 'cb' on each instance in guid orted order */
 void qof_object_foreach_sorted (QofIdTypeConst type_name, QofBook *book,
                                 QofInstanceForeachCB cb, gpointer user_data);
@@ -38,6 +38,8 @@
 
 static QofLogModule log_module = QOF_MOD_QUERY;
 
+typedef struct _QofQueryLive QofQueryLive;
+
 struct _QofQueryTerm
 {
     QofQueryParamList *     param_list;
@@ -51,6 +53,10 @@ struct _QofQueryTerm
      */
     GSList *                param_fcns;
     QofQueryPredicateFunc   pred_fcn;
+
+    /* Evaluation order of the term within its and-terms; see
+     * plan_terms() */
+    gdouble                 rank;
 };
 
 struct _QofQuerySort
@@ -80,6 +86,11 @@ struct _QofQuery
      * logical expression. */
     GList *           terms;
 
+    /* The and-terms of each or-term in the order in which they are
+     * checked, computed along with the compiled terms.  The lists do
+     * not own the terms. */
+    GList *           plan;
+
     /* sorting and chopping is independent of the search filter */
 
     QofQuerySort      primary_sort;
@@ -101,6 +112,10 @@ struct _QofQuery
     gint              changed;
 
     GList *           results;
+
+    /* With qof_query_set_live(), the state for keeping the results
+     * up to date from engine events */
+    QofQueryLive *    live;
 };
 
 typedef struct _QofQueryCB
@@ -108,8 +123,29 @@ typedef struct _QofQueryCB
     QofQuery *        query;
     GList *           list;
     gint              count;
+
+    /* With max_results set, the best matches so far instead of list;
+     * see top_matches_add() */
+    GArray *          top;
+    gboolean          sorted;
 } QofQueryCB;
 
+typedef struct
+{
+    gpointer          object;
+    gint              seq;      /* order in which the object matched */
+} QofQueryMatch;
+
+static void free_plan (QofQuery *q)
+{
+    GList *node;
+
+    for (node = q->plan; node; node = node->next)
+        g_list_free (node->data);
+    g_list_free (q->plan);
+    q->plan = NULL;
+}
+
 /* initial_term will be owned by the new Query */
 static void query_init (QofQuery *q, QofQueryTerm *initial_term)
 {
@@ -139,6 +175,8 @@ static void query_init (QofQuery *q, QofQueryTerm *initial_term)
     g_slist_free (q->secondary_sort.param_fcns);
     g_slist_free (q->tertiary_sort.param_fcns);
 
+    free_plan (q);
+
     ht = q->be_compiled;
     memset (q, 0, sizeof (*q));
     q->be_compiled = ht;
@@ -257,6 +295,8 @@ static void free_members (QofQuery *q)
         cur_or->data = NULL;
     }
 
+    free_plan (q);
+
     free_sort (&(q->primary_sort));
     free_sort (&(q->secondary_sort));
     free_sort (&(q->tertiary_sort));
@@ -349,6 +389,89 @@ static int sort_func (const gconstpointer a, const gconstpointer b, const gpoint
     }
 }
 
+static gboolean
+query_is_sorted (const QofQuery *q)
+{
+    return (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+            (q->primary_sort.use_default && q->defaultSort));
+}
+
+/* The order of the results: the sort order of the query, and the order
+ * in which the objects matched among equal ones, just as the stable
+ * sort of the full list of matches would give. */
+static gint
+match_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const QofQueryCB *qcb = user_data;
+    const QofQueryMatch *ma = a, *mb = b;
+    int retval = 0;
+
+    if (qcb->sorted)
+        retval = sort_func (ma->object, mb->object, qcb->query);
+    if (retval == 0)
+        retval = (ma->seq > mb->seq) - (ma->seq < mb->seq);
+    return retval;
+}
+
+/* A query with max_results set returns the last max_results objects
+ * of the sorted matches.  Rather than collecting and sorting all of
+ * them, keep the last ones seen so far in a binary heap with the first
+ * of them at the top, and replace the top when an object that sorts
+ * after it matches.  This costs O(n log k) time and O(k) memory. */
+static void
+top_matches_add (QofQueryCB *qcb, gpointer object)
+{
+    GArray *top = qcb->top;
+    QofQueryMatch match;
+    guint pos;
+
+    match.object = object;
+    match.seq = qcb->count;
+
+    if (top->len < (guint)qcb->query->max_results)
+    {
+        /* Sift up from the new leaf */
+        g_array_append_val (top, match);
+        for (pos = top->len - 1; pos > 0; )
+        {
+            guint parent = (pos - 1) / 2;
+
+            if (match_cmp (&g_array_index (top, QofQueryMatch, parent),
+                           &match, qcb) <= 0)
+                break;
+            g_array_index (top, QofQueryMatch, pos) =
+                g_array_index (top, QofQueryMatch, parent);
+            pos = parent;
+        }
+        g_array_index (top, QofQueryMatch, pos) = match;
+        return;
+    }
+
+    if (top->len == 0 ||
+            match_cmp (&match, &g_array_index (top, QofQueryMatch, 0), qcb) < 0)
+        return;
+
+    /* Sift down from the top */
+    for (pos = 0; ; )
+    {
+        guint child = 2 * pos + 1;
+
+        if (child >= top->len)
+            break;
+        if (child + 1 < top->len &&
+                match_cmp (&g_array_index (top, QofQueryMatch, child + 1),
+                           &g_array_index (top, QofQueryMatch, child), qcb) < 0)
+            child++;
+        if (match_cmp (&match, &g_array_index (top, QofQueryMatch, child),
+                       qcb) <= 0)
+            break;
+        g_array_index (top, QofQueryMatch, pos) =
+            g_array_index (top, QofQueryMatch, child);
+        pos = child;
+    }
+    g_array_index (top, QofQueryMatch, pos) = match;
+}
+
 /* ==================================================================== */
 /* This is the main workhorse for performing the query.  For each
  * object, it walks over all of the query terms to see if the
@@ -363,7 +486,7 @@ check_object (const QofQuery *q, gpointer object)
     const QofQueryTerm * qt;
     int       and_terms_ok = 1;
 
-    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    for (or_ptr = q->plan; or_ptr; or_ptr = or_ptr->next)
     {
         and_terms_ok = 1;
         for (and_ptr = or_ptr->data; and_ptr; and_ptr = and_ptr->next)
@@ -499,6 +622,108 @@ compile_sort (QofQuerySort *sort, QofIdType obj)
     LEAVE ("sort=%p id=%s", sort, obj);
 }
 
+/* The query planner.  Within each and-term, the terms are checked in
+ * an order that rejects a non-matching object after as few getter
+ * chains and predicates as possible.  For independent terms, checking
+ * them by increasing cost / (1 - pass rate) minimizes the expected
+ * cost per object.  Both are rough estimates from the type of the
+ * predicate and the length of the parameter path.  The terms of the
+ * query itself keep the order the caller gave them. */
+static gdouble
+term_pass_rate (const QofQueryTerm *qt)
+{
+    const QofQueryPredData *pd = qt->pdata;
+    gdouble pass;
+
+    switch (pd->how)
+    {
+    case QOF_COMPARE_EQUAL:
+        pass = 0.1;
+        break;
+    case QOF_COMPARE_NEQ:
+        pass = 0.9;
+        break;
+    default:
+        pass = 0.5;
+        break;
+    }
+
+    if (!g_strcmp0 (pd->type_name, QOF_TYPE_GUID))
+    {
+        query_guid_t pdata = (query_guid_t)pd;
+
+        switch (pdata->options)
+        {
+        case QOF_GUID_MATCH_ANY:
+        case QOF_GUID_MATCH_LIST_ANY:
+            pass = MIN (0.9, 0.05 * g_list_length (pdata->guids));
+            break;
+        case QOF_GUID_MATCH_NONE:
+            pass = 0.9;
+            break;
+        default:
+            pass = 0.5;
+            break;
+        }
+    }
+    else if (!g_strcmp0 (pd->type_name, QOF_TYPE_BOOLEAN))
+        pass = 0.5;
+
+    return qt->invert ? 1.0 - pass : pass;
+}
+
+static gdouble
+term_cost (const QofQueryTerm *qt)
+{
+    const char *type = qt->pdata->type_name;
+    gdouble cost = g_slist_length (qt->param_fcns);
+
+    if (!g_strcmp0 (type, QOF_TYPE_STRING))
+        cost += ((query_string_t)qt->pdata)->is_regex ? 16 : 4;
+    else if (!g_strcmp0 (type, QOF_TYPE_KVP))
+        cost += 8;
+    else if (!g_strcmp0 (type, QOF_TYPE_COLLECT) ||
+             !g_strcmp0 (type, QOF_TYPE_CHOICE))
+        cost += 4;
+    else if (!g_strcmp0 (type, QOF_TYPE_NUMERIC) ||
+             !g_strcmp0 (type, QOF_TYPE_DEBCRED))
+        cost += 2;
+    else
+        cost += 1;
+
+    return cost;
+}
+
+static gint
+term_rank_cmp (gconstpointer a, gconstpointer b)
+{
+    const QofQueryTerm *qa = a, *qb = b;
+
+    return (qa->rank > qb->rank) - (qa->rank < qb->rank);
+}
+
+static void
+plan_terms (QofQuery *q)
+{
+    GList *or_ptr, *and_ptr;
+
+    free_plan (q);
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        for (and_ptr = or_ptr->data; and_ptr; and_ptr = and_ptr->next)
+        {
+            QofQueryTerm *qt = and_ptr->data;
+
+            qt->rank = term_cost (qt) / MAX (1.0 - term_pass_rate (qt), 0.01);
+        }
+        /* g_list_sort is stable, equal ranks keep the caller's order */
+        q->plan = g_list_prepend (q->plan,
+                                  g_list_sort (g_list_copy (or_ptr->data),
+                                               term_rank_cmp));
+    }
+    q->plan = g_list_reverse (q->plan);
+}
+
 static void compile_terms (QofQuery *q)
 {
     GList *or_ptr, *and_ptr, *node;
@@ -532,6 +757,8 @@ static void compile_terms (QofQuery *q)
         }
     }
 
+    plan_terms (q);
+
     /* Update the sort functions */
     compile_sort (&(q->primary_sort), q->search_for);
     compile_sort (&(q->secondary_sort), q->search_for);
@@ -563,7 +790,10 @@ static void check_item_cb (gpointer object, gpointer user_data)
 
     if (check_object (ql->query, object))
     {
-        ql->list = g_list_prepend (ql->list, object);
+        if (ql->top)
+            top_matches_add (ql, object);
+        else
+            ql->list = g_list_prepend (ql->list, object);
         ql->count++;
     }
     return;
@@ -625,6 +855,261 @@ static void query_clear_compiles (QofQuery *q)
     g_hash_table_foreach_remove (q->be_compiled, query_free_compiled, NULL);
 }
 
+/********************************************************************/
+/* Live queries.  Between runs, the events of the objects searched for
+ * and of the objects they depend on are used to keep a copy of the
+ * results up to date, by checking only the objects that changed.  The
+ * list handed out by qof_query_run() is left alone until the changes
+ * are taken, so callers can change objects while walking it.
+ */
+
+struct _QofQueryLive
+{
+    gint              handler_id;
+    QofIdTypeConst    handler_type;   /* search_for when registered */
+
+    /* The current results in order */
+    GSequence *       results;
+
+    /* object -> its GSequenceIter in results */
+    GHashTable *      members;
+
+    /* type -> QofQueryLiveDependencyFunc */
+    GHashTable *      depends;
+
+    /* QofQueryDelta, the last one first */
+    GList *           deltas;
+    guint             num_deltas;
+
+    /* Set when the results can no longer be updated from events, until
+     * the query is run again */
+    gboolean          stale;
+};
+
+/* Once there are more changes than results, running the query again
+ * costs about as much as applying them to a register. */
+#define LIVE_MIN_DELTAS 64
+
+static void
+live_set_stale (QofQueryLive *live)
+{
+    if (live->stale) return;
+    PINFO ("live query %p is stale", live);
+    live->stale = TRUE;
+    qof_query_free_deltas (live->deltas);
+    live->deltas = NULL;
+    live->num_deltas = 0;
+}
+
+static void
+live_add_delta (QofQuery *q, QofQueryDeltaType type, gpointer object,
+                gint old_index, gint new_index)
+{
+    QofQueryLive *live = q->live;
+    QofQueryDelta *delta;
+
+    if (++live->num_deltas >
+            g_hash_table_size (live->members) + LIVE_MIN_DELTAS)
+    {
+        live_set_stale (live);
+        return;
+    }
+
+    delta = g_new (QofQueryDelta, 1);
+    delta->type = type;
+    delta->object = object;
+    delta->old_index = old_index;
+    delta->new_index = new_index;
+    live->deltas = g_list_prepend (live->deltas, delta);
+}
+
+/* Whether the object at iter still sorts between its neighbours */
+static gboolean
+live_in_order (const QofQuery *q, GSequenceIter *iter)
+{
+    gpointer q_data = (gpointer) q;
+    gpointer object = g_sequence_get (iter);
+    GSequenceIter *next;
+
+    if (!query_is_sorted (q))
+        return TRUE;
+    if (!g_sequence_iter_is_begin (iter) &&
+            sort_func (g_sequence_get (g_sequence_iter_prev (iter)),
+                       object, q_data) > 0)
+        return FALSE;
+    next = g_sequence_iter_next (iter);
+    if (!g_sequence_iter_is_end (next) &&
+            sort_func (object, g_sequence_get (next), q_data) > 0)
+        return FALSE;
+    return TRUE;
+}
+
+/* Order for inserting into the results: after the objects that do not
+ * sort after it, as the stable sort of a full run would put it.  Never
+ * returning 0 makes g_sequence_search() find the last such place. */
+static gint
+live_insert_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    QofQuery *q = user_data;
+
+    if (query_is_sorted (q) && sort_func (a, b, q) > 0)
+        return 1;
+    return -1;
+}
+
+static void
+live_update (QofQuery *q, gpointer object, gboolean gone)
+{
+    QofQueryLive *live = q->live;
+    gboolean match;
+    GSequenceIter *iter;
+    gint old_index = -1, new_index;
+
+    iter = g_hash_table_lookup (live->members, object);
+    match = (!gone && !qof_instance_get_destroying (object) &&
+             g_list_find (q->books, qof_instance_get_book (object)) &&
+             check_object (q, object));
+    if (!iter && !match)
+        return;
+
+    if (iter)
+    {
+        old_index = g_sequence_iter_get_position (iter);
+
+        if (match && live_in_order (q, iter))
+        {
+            /* Changed in place */
+            live_add_delta (q, QOF_QUERY_DELTA_MOVE, object,
+                            old_index, old_index);
+            return;
+        }
+
+        g_sequence_remove (iter);
+        if (!match)
+        {
+            g_hash_table_remove (live->members, object);
+            live_add_delta (q, QOF_QUERY_DELTA_REMOVE, object, old_index, -1);
+            return;
+        }
+    }
+
+    iter = g_sequence_insert_before (g_sequence_search (live->results, object,
+                                     live_insert_cmp, q), object);
+    new_index = g_sequence_iter_get_position (iter);
+    live_add_delta (q, old_index >= 0 ? QOF_QUERY_DELTA_MOVE :
+                    QOF_QUERY_DELTA_INSERT, object, old_index, new_index);
+    g_hash_table_insert (live->members, object, iter);
+}
+
+static void
+live_event_handler (QofInstance *ent, QofEventId event_type,
+                    gpointer handler_data, gpointer event_data)
+{
+    QofQuery *q = handler_data;
+    QofQueryLive *live = q->live;
+    QofQueryLiveDependencyFunc depend;
+    GList *node;
+
+    if (live->stale)
+        return;
+
+    /* Changing the query or chopping the results needs a full run */
+    if (q->changed || q->max_results >= 0)
+    {
+        live_set_stale (live);
+        return;
+    }
+
+    if (!g_strcmp0 (ent->e_type, q->search_for))
+    {
+        live_update (q, ent, event_type == QOF_EVENT_DESTROY);
+        return;
+    }
+
+    /* The objects depending on a destroyed one go with it, without
+     * necessarily generating events of their own */
+    depend = g_hash_table_lookup (live->depends, ent->e_type);
+    if (!depend)
+        return;
+    for (node = depend (ent); node; node = node->next)
+    {
+        if (live->stale)
+            break;
+        live_update (q, node->data, event_type == QOF_EVENT_DESTROY);
+    }
+}
+
+static void
+live_register (QofQuery *q)
+{
+    QofQueryLive *live = q->live;
+    QofIdTypeConst *types;
+    GHashTableIter iter;
+    gpointer key;
+    guint i = 0;
+
+    if (live->handler_id && live->handler_type == q->search_for)
+        return;
+    if (live->handler_id)
+        qof_event_unregister_handler (live->handler_id);
+    live->handler_id = 0;
+    live->handler_type = q->search_for;
+    if (!q->search_for)
+        return;
+
+    types = g_new0 (QofIdTypeConst, g_hash_table_size (live->depends) + 2);
+    types[i++] = q->search_for;
+    g_hash_table_iter_init (&iter, live->depends);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        types[i++] = key;
+
+    live->handler_id =
+        qof_event_register_filtered_handler (live_event_handler, q,
+                QOF_EVENT_MODIFY | QOF_EVENT_DESTROY | QOF_EVENT_REMOVE,
+                types);
+    g_free (types);
+}
+
+/* Start over from the results of a full run */
+static void
+live_reset (QofQuery *q)
+{
+    QofQueryLive *live = q->live;
+    GList *node;
+
+    if (!live) return;
+
+    g_hash_table_remove_all (live->members);
+    g_sequence_free (live->results);
+    live->results = g_sequence_new (NULL);
+    for (node = q->results; node; node = node->next)
+        g_hash_table_insert (live->members, node->data,
+                             g_sequence_append (live->results, node->data));
+
+    qof_query_free_deltas (live->deltas);
+    live->deltas = NULL;
+    live->num_deltas = 0;
+    live->stale = FALSE;
+    live_register (q);
+}
+
+static void
+live_free (QofQuery *q)
+{
+    QofQueryLive *live = q->live;
+
+    if (!live) return;
+
+    if (live->handler_id)
+        qof_event_unregister_handler (live->handler_id);
+    g_hash_table_destroy (live->members);
+    g_hash_table_destroy (live->depends);
+    g_sequence_free (live->results);
+    qof_query_free_deltas (live->deltas);
+    g_free (live);
+    q->live = NULL;
+}
+
 /********************************************************************/
 /* PUBLISHED API FUNCTIONS */
 
@@ -691,6 +1176,7 @@ void qof_query_purge_terms (QofQuery *q, QofQueryParamList *param_list)
                     q->terms = g_list_remove_link (q->terms, or);
                     g_list_free_1 (or);
                     or = q->terms;
+                    q->changed = 1;
                     break;
                 }
                 else
@@ -721,8 +1207,6 @@ static GList * qof_query_run_internal (QofQuery *q,
     g_return_val_if_fail (run_cb, NULL);
     ENTER (" q=%p", q);
 
-    /* XXX: Prioritize the query terms? */
-
     /* prepare the Query for processing */
     if (q->changed)
     {
@@ -740,55 +1224,48 @@ static GList * qof_query_run_internal (QofQuery *q,
 
         memset (&qcb, 0, sizeof (qcb));
         qcb.query = q;
+        qcb.sorted = query_is_sorted (q);
+        if (q->max_results > -1)
+            qcb.top = g_array_new (FALSE, FALSE, sizeof (QofQueryMatch));
 
         /* Run the query callback */
         run_cb(&qcb, cb_arg);
 
         matching_objects = qcb.list;
         object_count = qcb.count;
+
+        /* The matches kept for max_results only need to be put in
+         * order; the other ones have been dropped already. */
+        if (qcb.top)
+        {
+            guint i;
+
+            g_array_sort_with_data (qcb.top, match_cmp, &qcb);
+            for (i = qcb.top->len; i > 0; i--)
+                matching_objects =
+                    g_list_prepend (matching_objects,
+                                    g_array_index (qcb.top, QofQueryMatch, i - 1).object);
+            object_count = qcb.top->len;
+            g_array_free (qcb.top, TRUE);
+        }
     }
     PINFO ("matching objects=%p count=%d", matching_objects, object_count);
 
-    /* There is no absolute need to reverse this list, since it's being
-     * sorted below. However, in the common case, we will be searching
-     * in a confined location where the objects are already in order,
-     * thus reversing will put us in the correct order we want and make
-     * the sorting go much faster.
-     */
-    matching_objects = g_list_reverse(matching_objects);
-
-    /* Now sort the matching objects based on the search criteria */
-    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-            (q->primary_sort.use_default && q->defaultSort))
+    if (q->max_results < 0)
     {
-        matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
-    }
+        /* There is no absolute need to reverse this list, since it's being
+         * sorted below. However, in the common case, we will be searching
+         * in a confined location where the objects are already in order,
+         * thus reversing will put us in the correct order we want and make
+         * the sorting go much faster.
+         */
+        matching_objects = g_list_reverse(matching_objects);
 
-    /* Crop the list to limit the number of splits. */
-    if ((object_count > q->max_results) && (q->max_results > -1))
-    {
-        if (q->max_results > 0)
+        /* Now sort the matching objects based on the search criteria */
+        if (query_is_sorted (q))
         {
-            GList *mptr;
-
-            /* mptr is set to the first node of what will be the new list */
-            mptr = g_list_nth(matching_objects, object_count - q->max_results);
-            /* mptr should not be NULL, but let's be safe */
-            if (mptr != NULL)
-            {
-                if (mptr->prev != NULL) mptr->prev->next = NULL;
-                mptr->prev = NULL;
-            }
-            g_list_free(matching_objects);
-            matching_objects = mptr;
+            matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
         }
-        else
-        {
-            /* q->max_results == 0 */
-            g_list_free(matching_objects);
-            matching_objects = NULL;
-        }
-        object_count = q->max_results;
     }
 
     q->changed = 0;
@@ -824,7 +1301,18 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 
-        /* And then iterate over all the objects */
+        /* And then iterate over the objects.  A query of a single
+         * and-term may be answered from an access path of the object
+         * type, which only offers the objects that can match; anything
+         * else checks all the objects in the book. */
+        if (qcb->query->terms && !qcb->query->terms->next &&
+                qof_object_foreach_query_match (qcb->query->search_for, book,
+                        qcb->query->plan->data,
+                        (QofInstanceForeachCB) check_item_cb, qcb))
+        {
+            PINFO ("used the access path of %s", qcb->query->search_for);
+            continue;
+        }
         qof_object_foreach (qcb->query->search_for, book,
                             (QofInstanceForeachCB) check_item_cb, qcb);
     }
@@ -832,8 +1320,12 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 
 GList * qof_query_run (QofQuery *q)
 {
-    /* Just a wrapper */
-    return qof_query_run_internal(q, qof_query_run_cb, NULL);
+    GList *results;
+
+    results = qof_query_run_internal(q, qof_query_run_cb, NULL);
+    if (q && q->live)
+        live_reset (q);
+    return results;
 }
 
 static void qof_query_run_subq_cb(QofQueryCB* qcb, gpointer cb_arg)
@@ -856,6 +1348,10 @@ qof_query_run_subquery (QofQuery *subq, const QofQuery* primaryq)
     g_return_val_if_fail(!g_strcmp0(subq->search_for, primaryq->search_for),
                          NULL);
 
+    /* The results of a subquery are not kept up to date */
+    if (subq->live)
+        live_set_stale (subq->live);
+
     /* Perform the subquery */
     return qof_query_run_internal(subq, qof_query_run_subq_cb,
                                   (gpointer)primaryq);
@@ -870,6 +1366,91 @@ qof_query_last_run (QofQuery *query)
     return query->results;
 }
 
+void
+qof_query_set_live (QofQuery *q, gboolean live)
+{
+    if (!q) return;
+
+    if (!live)
+    {
+        live_free (q);
+        return;
+    }
+    if (q->live)
+        return;
+
+    q->live = g_new0 (QofQueryLive, 1);
+    q->live->results = g_sequence_new (NULL);
+    q->live->members = g_hash_table_new (g_direct_hash, g_direct_equal);
+    q->live->depends = g_hash_table_new (g_str_hash, g_str_equal);
+    /* The results so far may be out of date already */
+    q->live->stale = TRUE;
+    live_register (q);
+}
+
+void
+qof_query_add_live_dependency (QofQuery *q, QofIdTypeConst type,
+                               QofQueryLiveDependencyFunc func)
+{
+    if (!q || !type || !func) return;
+    g_return_if_fail (q->live);
+
+    g_hash_table_insert (q->live->depends, (gpointer) type, func);
+
+    /* Register again for the new type */
+    if (q->live->handler_id)
+        qof_event_unregister_handler (q->live->handler_id);
+    q->live->handler_id = 0;
+    live_register (q);
+}
+
+gboolean
+qof_query_take_live_changes (QofQuery *q, GList **deltas)
+{
+    g_return_val_if_fail (deltas, FALSE);
+    *deltas = NULL;
+
+    if (!q || !q->live || q->live->stale || q->changed || q->max_results >= 0)
+        return FALSE;
+
+    *deltas = g_list_reverse (q->live->deltas);
+    q->live->deltas = NULL;
+    q->live->num_deltas = 0;
+
+    /* Hand out the results as they are now, as a run would */
+    if (*deltas)
+    {
+        GSequenceIter *iter;
+        GList *results = NULL;
+
+        iter = g_sequence_get_end_iter (q->live->results);
+        while (!g_sequence_iter_is_begin (iter))
+        {
+            iter = g_sequence_iter_prev (iter);
+            results = g_list_prepend (results, g_sequence_get (iter));
+        }
+        g_list_free (q->results);
+        q->results = results;
+    }
+    return TRUE;
+}
+
+gboolean
+qof_query_live_contains (const QofQuery *q, gconstpointer object)
+{
+    if (!q || !object) return FALSE;
+
+    if (q->live)
+        return g_hash_table_lookup (q->live->members, object) != NULL;
+    return g_list_find (q->results, object) != NULL;
+}
+
+void
+qof_query_free_deltas (GList *deltas)
+{
+    g_list_free_full (deltas, g_free);
+}
+
 void qof_query_clear (QofQuery *query)
 {
     QofQuery *q2 = qof_query_create ();
@@ -975,6 +1556,7 @@ GSList * qof_query_get_term_type (QofQuery *q, QofQueryParamList *term_param)
 void qof_query_destroy (QofQuery *q)
 {
     if (!q) return;
+    live_free (q);
     free_members (q);
     query_clear_compiles (q);
     g_hash_table_destroy (q->be_compiled);
@@ -995,8 +1577,10 @@ QofQuery * qof_query_copy (QofQuery *q)
 
     copy->be_compiled = ht;
     copy->terms = copy_or_terms (q->terms);
+    copy->plan = NULL;
     copy->books = g_list_copy (q->books);
     copy->results = g_list_copy (q->results);
+    copy->live = NULL;
 
     copy_sort (&(copy->primary_sort), &(q->primary_sort));
     copy_sort (&(copy->secondary_sort), &(q->secondary_sort));
@@ -1240,6 +1824,8 @@ void qof_query_set_sort_options (QofQuery *q, gint prim_op, gint sec_op,
     q->primary_sort.options = prim_op;
     q->secondary_sort.options = sec_op;
     q->tertiary_sort.options = tert_op;
+    if (q->live)
+        live_set_stale (q->live);
 }
 
 void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
@@ -1249,6 +1835,8 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
     q->primary_sort.increasing = prim_inc;
     q->secondary_sort.increasing = sec_inc;
     q->tertiary_sort.increasing = tert_inc;
+    if (q->live)
+        live_set_stale (q->live);
 }
 
 void qof_query_set_max_results (QofQuery *q, int n)
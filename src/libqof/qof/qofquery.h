@@ -222,6 +222,82 @@ GList * qof_query_run (QofQuery *query);
  */
 GList * qof_query_last_run (QofQuery *query);
 
+/** @name Live queries
+ *
+ * A live query keeps the results of its last run up to date from the
+ * engine events of the objects searched for, and of the objects they
+ * depend on, by checking only the objects that changed.  Every change
+ * to the results is recorded as a QofQueryDelta, so that a view of
+ * the results can be patched instead of rebuilt.
+ *
+ * The list returned by qof_query_run() and qof_query_last_run() does
+ * not change with the events; it is replaced by the next run, or when
+ * the changes are taken with qof_query_take_live_changes().
+ *
+ * The results can only be kept up to date until the query itself is
+ * changed, or if max_results is set; after that the query has to be
+ * run again.
+ * @{
+ */
+
+/** The kinds of changes to the results of a live query */
+typedef enum
+{
+    QOF_QUERY_DELTA_INSERT,   /**< object inserted at new_index */
+    QOF_QUERY_DELTA_REMOVE,   /**< object removed from old_index */
+    QOF_QUERY_DELTA_MOVE,     /**< object changed, and moved from old_index
+                               *   to new_index if they differ */
+} QofQueryDeltaType;
+
+/** A change to the results of a live query.  The indexes are those of
+ *  the results as the deltas before this one left them. */
+typedef struct
+{
+    QofQueryDeltaType type;
+    gpointer          object;
+    gint              old_index;
+    gint              new_index;
+} QofQueryDelta;
+
+/** Return the objects of the searched-for type that depend on object,
+ *  in a list owned by object. */
+typedef GList * (*QofQueryLiveDependencyFunc) (gpointer object);
+
+/** Start or stop keeping the results of query up to date.  The
+ *  results are up to date after the next qof_query_run(). */
+void qof_query_set_live (QofQuery *query, gboolean live);
+
+/** Check the objects returned by func again when an object of the
+ *  given type changes.  For example a query for splits depends on
+ *  the transactions, through xaccTransGetSplitList().  When an object
+ *  of the type is destroyed, the objects depending on it are removed
+ *  from the results. */
+void qof_query_add_live_dependency (QofQuery *query, QofIdTypeConst type,
+                                    QofQueryLiveDependencyFunc func);
+
+/** Take the changes to the results of a live query since the last
+ *  qof_query_run() or the last call of this function.  If there are
+ *  any, qof_query_last_run() returns the updated results afterwards,
+ *  and the list it returned before is freed, as by a run.
+ *
+ *  @param deltas Set to the list of QofQueryDelta in the order they
+ *  happened; free it with qof_query_free_deltas().
+ *
+ *  @return FALSE if the results could not be kept up to date, and the
+ *  query has to be run again.
+ */
+gboolean qof_query_take_live_changes (QofQuery *query, GList **deltas);
+
+/** Return whether object is in the results of query, as a live query
+ *  has kept them up to date. */
+gboolean qof_query_live_contains (const QofQuery *query,
+                                  gconstpointer object);
+
+/** Free a list of QofQueryDelta. */
+void qof_query_free_deltas (GList *deltas);
+
+/** @} */
+
 /** Perform a subquery, return the results.
  *  Instead of running over a book, the subquery runs over the results
  *  of the primary query.
@@ -1256,6 +1256,72 @@ test_kvp_frame_replace_slot_nc( Fixture *fixture, gconstpointer pData )
     kvp_value_delete( orig_value2 );
 }
 
+static void
+collect_slot_key( const gchar *key, KvpValue *value, gpointer data )
+{
+    g_ptr_array_add( (GPtrArray*)data, (gpointer)key );
+}
+
+static void
+test_kvp_frame_many_slots( Fixture *fixture, gconstpointer pData )
+{
+    GPtrArray *keys;
+    KvpFrame *copy;
+    gchar key[32];
+    guint i;
+
+    g_assert( fixture->frame );
+    g_assert( kvp_frame_is_empty( fixture->frame ) );
+
+    g_test_message( "Test storing enough slots to outgrow the slot array" );
+    for ( i = 0; i < 40; i++ )
+    {
+        g_snprintf( key, sizeof( key ), "key%02u", 39 - i );
+        kvp_frame_set_gint64( fixture->frame, key, 39 - i );
+        g_snprintf( key, sizeof( key ), "sub/key%02u", i );
+        kvp_frame_set_gint64( fixture->frame, key, i );
+        g_assert_cmpuint( kvp_frame_get_slot_count( fixture->frame ), == , i + 2 );
+    }
+    for ( i = 0; i < 40; i++ )
+    {
+        g_snprintf( key, sizeof( key ), "/key%02u", i );
+        g_assert_cmpint( kvp_frame_get_gint64( fixture->frame, key ), == , i );
+        g_snprintf( key, sizeof( key ), "sub//key%02u", i );
+        g_assert_cmpint( kvp_frame_get_gint64( fixture->frame, key ), == , i );
+    }
+    g_assert( kvp_frame_get_value( fixture->frame, "su/key00" ) == NULL );
+    g_assert( kvp_frame_get_value( fixture->frame, "subx/key00" ) == NULL );
+    g_assert( kvp_frame_get_value( fixture->frame, "key/key00" ) == NULL );
+
+    g_test_message( "Test sorted traversal" );
+    keys = g_ptr_array_new();
+    kvp_frame_for_each_slot_sorted( kvp_frame_get_frame( fixture->frame, "sub" ),
+                                    collect_slot_key, keys );
+    g_assert_cmpuint( keys->len, == , 40 );
+    for ( i = 1; i < keys->len; i++ )
+        g_assert_cmpstr( g_ptr_array_index( keys, i - 1 ), < , g_ptr_array_index( keys, i ) );
+    g_ptr_array_set_size( keys, 0 );
+    kvp_frame_for_each_slot_sorted( fixture->frame, collect_slot_key, keys );
+    g_assert_cmpuint( keys->len, == , 41 );
+    for ( i = 1; i < keys->len; i++ )
+        g_assert_cmpstr( g_ptr_array_index( keys, i - 1 ), < , g_ptr_array_index( keys, i ) );
+    g_ptr_array_free( keys, TRUE );
+
+    g_test_message( "Test copying and removing slots" );
+    copy = kvp_frame_copy( fixture->frame );
+    g_assert_cmpint( kvp_frame_compare( fixture->frame, copy ), == , 0 );
+    for ( i = 0; i < 40; i += 2 )
+    {
+        g_snprintf( key, sizeof( key ), "sub/key%02u", i );
+        kvp_frame_set_value( copy, key, NULL );
+    }
+    g_assert_cmpuint( kvp_frame_get_slot_count( kvp_frame_get_frame( copy, "sub" ) ), == , 20 );
+    g_assert( kvp_frame_get_value( copy, "sub/key00" ) == NULL );
+    g_assert_cmpint( kvp_frame_get_gint64( copy, "sub/key01" ), == , 1 );
+    g_assert_cmpint( kvp_frame_compare( fixture->frame, copy ), != , 0 );
+    kvp_frame_delete( copy );
+}
+
 static void
 test_get_trailer_make( Fixture *fixture, gconstpointer pData )
 {
@@ -1477,6 +1543,7 @@ test_suite_kvp_frame( void )
     GNC_TEST_ADD( suitename, "kvp frame set slot path", Fixture, NULL, setup, test_kvp_frame_set_slot_path, teardown );
     GNC_TEST_ADD( suitename, "kvp frame set slot path gslist", Fixture, NULL, setup, test_kvp_frame_set_slot_path_gslist, teardown );
     GNC_TEST_ADD( suitename, "kvp frame replace slot nc", Fixture, NULL, setup, test_kvp_frame_replace_slot_nc, teardown );
+    GNC_TEST_ADD( suitename, "kvp frame many slots", Fixture, NULL, setup, test_kvp_frame_many_slots, teardown );
     GNC_TEST_ADD( suitename, "get trailer make", Fixture, NULL, setup_static, test_get_trailer_make, teardown_static );
     GNC_TEST_ADD( suitename, "kvp value glist to string", Fixture, NULL, setup_static, test_kvp_value_glist_to_string, teardown_static );
     GNC_TEST_ADD( suitename, "get or make", Fixture, NULL, setup_static, test_get_or_make, teardown_static );
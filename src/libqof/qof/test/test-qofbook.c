@@ -405,21 +405,25 @@ test_book_get_num_days_autofreeze( Fixture *fixture, gconstpointer pData )
 
     g_test_message( "Testing with incorrect slot path and some correct value - 17" );
     kvp_frame_set_double(qof_book_get_slots(fixture->book), OPTION_NAME_AUTO_READONLY_DAYS, 17);
+    qof_book_kvp_changed( fixture->book );
     g_assert( qof_book_uses_autoreadonly( fixture-> book ) == FALSE );
     g_assert( qof_book_get_num_days_autoreadonly( fixture-> book ) == 0 );
 
     g_test_message( "Testing when setting this correctly with some correct value - 17" );
     kvp_frame_set_double(qof_book_get_slots(fixture->book), slot_path, 17);
+    qof_book_kvp_changed( fixture->book );
     g_assert( qof_book_uses_autoreadonly( fixture-> book ) == TRUE );
     g_assert( qof_book_get_num_days_autoreadonly( fixture-> book ) == 17 );
 
     g_test_message( "Testing when setting this correctly to zero again" );
     kvp_frame_set_double(qof_book_get_slots(fixture->book), slot_path, 0);
+    qof_book_kvp_changed( fixture->book );
     g_assert( qof_book_uses_autoreadonly( fixture-> book ) == FALSE );
     g_assert( qof_book_get_num_days_autoreadonly( fixture-> book ) == 0 );
 
     g_test_message( "Testing when setting this correctly with some correct value - 32" );
     kvp_frame_set_double(qof_book_get_slots(fixture->book), slot_path, 32);
+    qof_book_kvp_changed( fixture->book );
     g_assert( qof_book_uses_autoreadonly( fixture-> book ) == TRUE );
     g_assert( qof_book_get_num_days_autoreadonly( fixture-> book ) == 32 );
 
@@ -451,6 +455,96 @@ test_book_use_split_action_for_num_field( Fixture *fixture, gconstpointer pData
     g_assert( qof_book_use_split_action_for_num_field( fixture-> book ) == FALSE );
 }
 
+static void
+test_book_get_autoreadonly_date( Fixture *fixture, gconstpointer pData )
+{
+    const char *slot_path;
+    GDate date, *expected, *allocated;
+
+    slot_path = (const char *) g_strconcat( KVP_OPTION_PATH, "/", OPTION_SECTION_ACCOUNTS, "/", OPTION_NAME_AUTO_READONLY_DAYS, NULL );
+
+    g_test_message( "Testing without auto-read-only days" );
+    g_assert( qof_book_get_autoreadonly_date( fixture->book, &date ) == FALSE );
+    g_assert( qof_book_get_autoreadonly_gdate( fixture->book ) == NULL );
+
+    g_test_message( "Testing with 17 auto-read-only days" );
+    kvp_frame_set_double(qof_book_get_slots(fixture->book), slot_path, 17);
+    qof_book_kvp_changed( fixture->book );
+    expected = gnc_g_date_new_today ();
+    g_date_subtract_days (expected, 17);
+    g_assert( qof_book_get_autoreadonly_date( fixture->book, &date ) == TRUE );
+    g_assert( g_date_compare( &date, expected ) == 0 );
+    allocated = qof_book_get_autoreadonly_gdate( fixture->book );
+    g_assert( g_date_compare( allocated, expected ) == 0 );
+    g_date_free( allocated );
+
+    g_test_message( "Testing that the cached threshold follows the option" );
+    kvp_frame_set_double(qof_book_get_slots(fixture->book), slot_path, 18);
+    qof_book_kvp_changed( fixture->book );
+    g_date_subtract_days (expected, 1);
+    g_assert( qof_book_get_autoreadonly_date( fixture->book, &date ) == TRUE );
+    g_assert( g_date_compare( &date, expected ) == 0 );
+    g_date_free( expected );
+
+    g_free( (gpointer) slot_path );
+}
+
+/* The options the register reads for every split it loads, once
+ * straight from the slots as before they were cached and once through
+ * the getters. */
+static void
+test_book_options_perf( Fixture *fixture, gconstpointer pData )
+{
+    const gint num_splits = 200000;
+    KvpFrame *slots = qof_book_get_slots( fixture->book );
+    const char *opt;
+    gchar *slot_path;
+    GDate date;
+    gint i, count = 0;
+
+    if (!g_test_perf ())
+        return;
+
+    slot_path = g_strconcat( KVP_OPTION_PATH, "/", OPTION_SECTION_ACCOUNTS, "/", OPTION_NAME_AUTO_READONLY_DAYS, NULL );
+    kvp_frame_set_double( slots, slot_path, 30 );
+    qof_book_kvp_changed( fixture->book );
+    g_free( slot_path );
+
+    g_test_timer_start ();
+    for (i = 0; i < num_splits; i++)
+    {
+        kvp_value *val;
+        val = kvp_frame_get_slot_path( slots, KVP_OPTION_PATH, OPTION_SECTION_ACCOUNTS, OPTION_NAME_NUM_FIELD_SOURCE, NULL );
+        opt = val ? kvp_value_get_string( val ) : NULL;
+        count += (opt && opt[0] == 't');
+        val = kvp_frame_get_slot_path( slots, KVP_OPTION_PATH, OPTION_SECTION_ACCOUNTS, OPTION_NAME_TRADING_ACCOUNTS, NULL );
+        opt = val ? kvp_value_get_string( val ) : NULL;
+        count += (opt && opt[0] == 't');
+        val = kvp_frame_get_slot_path( slots, KVP_OPTION_PATH, OPTION_SECTION_ACCOUNTS, OPTION_NAME_AUTO_READONLY_DAYS, NULL );
+        if (val && kvp_value_get_double( val ) > 0)
+        {
+            GDate *d = gnc_g_date_new_today ();
+            g_date_subtract_days( d, (gint) kvp_value_get_double( val ) );
+            count += g_date_valid( d );
+            g_date_free( d );
+        }
+    }
+    g_test_minimized_result (g_test_timer_elapsed (),
+                             "%d splits, options read from the slots", num_splits);
+
+    g_test_timer_start ();
+    for (i = 0; i < num_splits; i++)
+    {
+        count -= qof_book_use_split_action_for_num_field( fixture->book );
+        count -= qof_book_use_trading_accounts( fixture->book );
+        if (qof_book_get_autoreadonly_date( fixture->book, &date ))
+            count -= g_date_valid( &date );
+    }
+    g_test_minimized_result (g_test_timer_elapsed (),
+                             "%d splits, cached options", num_splits);
+    g_assert_cmpint( count, ==, 0 );
+}
+
 static void
 test_book_mark_session_dirty( Fixture *fixture, gconstpointer pData )
 {
@@ -769,6 +863,8 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "use trading accounts", Fixture, NULL, setup, test_book_use_trading_accounts, teardown );
     GNC_TEST_ADD( suitename, "get autofreeze days", Fixture, NULL, setup, test_book_get_num_days_autofreeze, teardown );
     GNC_TEST_ADD( suitename, "use split action for num field", Fixture, NULL, setup, test_book_use_split_action_for_num_field, teardown );
+    GNC_TEST_ADD( suitename, "get autoreadonly date", Fixture, NULL, setup, test_book_get_autoreadonly_date, teardown );
+    GNC_TEST_ADD( suitename, "options perf", Fixture, NULL, setup, test_book_options_perf, teardown );
     GNC_TEST_ADD( suitename, "mark session dirty", Fixture, NULL, setup, test_book_mark_session_dirty, teardown );
     GNC_TEST_ADD( suitename, "session dirty time", Fixture, NULL, setup, test_book_get_session_dirty_time, teardown );
     GNC_TEST_ADD( suitename, "set dirty callback", Fixture, NULL, setup, test_book_set_dirty_cb, teardown );
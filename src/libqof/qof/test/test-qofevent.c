@@ -0,0 +1,265 @@
+/********************************************************************
+ * test-qofevent.c: GLib g_test test suite for qofevent.c.          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+#include "config.h"
+#include <glib.h>
+#include <unittest-support.h>
+#include "../qof.h"
+
+static const gchar *suitename = "/qof/qofevent";
+void test_suite_qofevent ( void );
+
+#define TYPE_A "TypeA"
+#define TYPE_B "TypeB"
+
+typedef struct
+{
+    QofInstance *a;
+    QofInstance *b;
+    GString *log;
+} Fixture;
+
+static void
+setup( Fixture *fixture, gconstpointer pData )
+{
+    fixture->a = g_object_new( QOF_TYPE_INSTANCE, NULL );
+    fixture->a->e_type = TYPE_A;
+    fixture->b = g_object_new( QOF_TYPE_INSTANCE, NULL );
+    fixture->b->e_type = TYPE_B;
+    fixture->log = g_string_new( NULL );
+    qof_event_reset_handler_counts();
+}
+
+static void
+teardown( Fixture *fixture, gconstpointer pData )
+{
+    g_object_unref( fixture->a );
+    g_object_unref( fixture->b );
+    g_string_free( fixture->log, TRUE );
+}
+
+/* Each handler appends its name to the log. */
+static void
+handler_1( QofInstance *ent, QofEventId event_type, gpointer handler_data,
+           gpointer event_data )
+{
+    g_string_append( ((Fixture*)handler_data)->log, "1" );
+}
+
+static void
+handler_2( QofInstance *ent, QofEventId event_type, gpointer handler_data,
+           gpointer event_data )
+{
+    g_string_append( ((Fixture*)handler_data)->log, "2" );
+}
+
+static void
+handler_3( QofInstance *ent, QofEventId event_type, gpointer handler_data,
+           gpointer event_data )
+{
+    g_string_append( ((Fixture*)handler_data)->log, "3" );
+}
+
+static gint self_id;
+
+static void
+unregistering_handler( QofInstance *ent, QofEventId event_type,
+                       gpointer handler_data, gpointer event_data )
+{
+    g_string_append( ((Fixture*)handler_data)->log, "u" );
+    qof_event_unregister_handler( self_id );
+}
+
+static void
+gen_and_check( Fixture *fixture, QofInstance *ent, QofEventId event_id,
+               const gchar *expected )
+{
+    g_string_truncate( fixture->log, 0 );
+    qof_event_gen( ent, event_id, NULL );
+    g_assert_cmpstr( fixture->log->str, == , expected );
+}
+
+static void
+test_filtered_dispatch( Fixture *fixture, gconstpointer pData )
+{
+    static const QofIdTypeConst a_types[] = { TYPE_A, NULL };
+    static const QofIdTypeConst ab_types[] = { TYPE_A, TYPE_B, NULL };
+    gint id1, id2, id3;
+    guint64 invoked, avoided, batched;
+
+    id1 = qof_event_register_handler( handler_1, fixture );
+    id2 = qof_event_register_filtered_handler( handler_2, fixture,
+            QOF_EVENT_MODIFY, a_types );
+    id3 = qof_event_register_filtered_handler( handler_3, fixture,
+            QOF_EVENT_MODIFY | QOF_EVENT_DESTROY, ab_types );
+
+    g_test_message( "Handlers are invoked newest first, filtered by type and event" );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "321" );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_DESTROY, "31" );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_CREATE, "1" );
+    gen_and_check( fixture, fixture->b, QOF_EVENT_MODIFY, "31" );
+    gen_and_check( fixture, fixture->b, QOF_EVENT_CREATE, "1" );
+
+    qof_event_get_handler_counts( &invoked, &avoided, &batched );
+    g_assert_cmpuint( invoked, == , 9 );
+    g_assert_cmpuint( avoided, == , 6 );
+    g_assert_cmpuint( batched, == , 0 );
+
+    g_test_message( "Unregistered handlers are no longer invoked" );
+    qof_event_unregister_handler( id2 );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "31" );
+    qof_event_unregister_handler( id1 );
+    qof_event_unregister_handler( id3 );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "" );
+}
+
+static void
+test_unregister_while_dispatching( Fixture *fixture, gconstpointer pData )
+{
+    static const QofIdTypeConst a_types[] = { TYPE_A, NULL };
+    gint id1, id2;
+
+    id1 = qof_event_register_filtered_handler( handler_1, fixture, 0, a_types );
+    self_id = qof_event_register_filtered_handler( unregistering_handler,
+              fixture, 0, a_types );
+    id2 = qof_event_register_handler( handler_2, fixture );
+
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "2u1" );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "21" );
+
+    qof_event_unregister_handler( id1 );
+    qof_event_unregister_handler( id2 );
+}
+
+/* Ten views, only one of which cares about the entities being edited,
+ * as with the account trees, registers and quickfills of a busy
+ * session. */
+static void
+test_bulk_edit_counts( Fixture *fixture, gconstpointer pData )
+{
+    static const QofIdTypeConst a_types[] = { TYPE_A, NULL };
+    static const QofIdTypeConst b_types[] = { TYPE_B, NULL };
+    gint ids[10];
+    guint64 invoked, avoided;
+    gint i;
+
+    for (i = 0; i < 10; i++)
+        ids[i] = qof_event_register_filtered_handler( handler_1, fixture,
+                 QOF_EVENT_MODIFY, i == 0 ? a_types : b_types );
+
+    for (i = 0; i < 1000; i++)
+        qof_event_gen( fixture->a, QOF_EVENT_MODIFY, NULL );
+
+    qof_event_get_handler_counts( &invoked, &avoided, NULL );
+    g_test_message( "%" G_GUINT64_FORMAT " handler invocations, %"
+                    G_GUINT64_FORMAT " avoided", invoked, avoided );
+    g_assert_cmpuint( invoked, == , 1000 );
+    g_assert_cmpuint( avoided, == , 9000 );
+
+    for (i = 0; i < 10; i++)
+        qof_event_unregister_handler( ids[i] );
+}
+
+static void
+batch_handler( const GPtrArray *entries, gpointer handler_data )
+{
+    Fixture *fixture = handler_data;
+    guint i;
+
+    for (i = 0; i < entries->len; i++)
+    {
+        QofEventBatchEntry *entry = g_ptr_array_index( entries, i );
+        g_string_append_printf( fixture->log, "[%s %x]", entry->type,
+                                entry->event_mask );
+    }
+}
+
+static void
+test_batch( Fixture *fixture, gconstpointer pData )
+{
+    gint id1, id2;
+    gint i;
+    guint64 invoked, avoided, batched;
+
+    id1 = qof_event_register_batch_handler( handler_1, batch_handler, fixture );
+    id2 = qof_event_register_handler( handler_2, fixture );
+
+    g_test_message( "Outside a batch, batch handlers get every event" );
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "12" );
+
+    g_test_message( "In a batch, events are coalesced per entity" );
+    g_string_truncate( fixture->log, 0 );
+    qof_event_begin_batch();
+    for (i = 0; i < 100; i++)
+        qof_event_gen( fixture->a, QOF_EVENT_MODIFY, NULL );
+    qof_event_begin_batch();
+    qof_event_gen( fixture->b, QOF_EVENT_CREATE, NULL );
+    qof_event_gen( fixture->a, QOF_EVENT_DESTROY, NULL );
+    qof_event_end_batch();
+    g_assert_cmpuint( fixture->log->len, == , 102 );
+    qof_event_end_batch();
+    g_assert_cmpstr( fixture->log->str + 102, == , "[TypeA 6][TypeB 1]" );
+
+    g_test_message( "Handlers left to the batch are not counted as avoided" );
+    qof_event_get_handler_counts( &invoked, &avoided, &batched );
+    g_assert_cmpuint( invoked, == , 104 );
+    g_assert_cmpuint( avoided, == , 0 );
+    g_assert_cmpuint( batched, == , 102 );
+
+    g_test_message( "An empty batch invokes nothing" );
+    g_string_truncate( fixture->log, 0 );
+    qof_event_begin_batch();
+    qof_event_end_batch();
+    g_assert_cmpstr( fixture->log->str, == , "" );
+
+    qof_event_unregister_handler( id1 );
+    qof_event_unregister_handler( id2 );
+}
+
+static void
+test_suspend( Fixture *fixture, gconstpointer pData )
+{
+    guint64 dropped = qof_event_get_dropped_count();
+    gint id1;
+
+    id1 = qof_event_register_handler( handler_1, fixture );
+
+    g_test_message( "Events generated while suspended are dropped and counted" );
+    qof_event_suspend();
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "" );
+    gen_and_check( fixture, fixture->b, QOF_EVENT_CREATE, "" );
+    qof_event_resume();
+    g_assert_cmpuint( qof_event_get_dropped_count(), == , dropped + 2 );
+
+    gen_and_check( fixture, fixture->a, QOF_EVENT_MODIFY, "1" );
+    g_assert_cmpuint( qof_event_get_dropped_count(), == , dropped + 2 );
+
+    qof_event_unregister_handler( id1 );
+}
+
+void
+test_suite_qofevent ( void )
+{
+    GNC_TEST_ADD( suitename, "filtered dispatch", Fixture, NULL, setup, test_filtered_dispatch, teardown );
+    GNC_TEST_ADD( suitename, "unregister while dispatching", Fixture, NULL, setup, test_unregister_while_dispatching, teardown );
+    GNC_TEST_ADD( suitename, "bulk edit counts", Fixture, NULL, setup, test_bulk_edit_counts, teardown );
+    GNC_TEST_ADD( suitename, "batch", Fixture, NULL, setup, test_batch, teardown );
+    GNC_TEST_ADD( suitename, "suspend", Fixture, NULL, setup, test_suspend, teardown );
+}
@@ -529,13 +529,104 @@ gnc_ledger_display_set_watches (GNCLedgerDisplay *ld, GList *splits)
     }
 }
 
+/* Keep the results of the query up to date from the engine events, so
+ * that a refresh needs neither run nor sort it again. */
+static void
+gnc_ledger_display_make_live (GNCLedgerDisplay *ld)
+{
+    qof_query_set_live (ld->query, TRUE);
+    qof_query_add_live_dependency (ld->query, GNC_ID_TRANS,
+                                   (QofQueryLiveDependencyFunc)
+                                   xaccTransGetSplitList);
+}
+
+typedef struct
+{
+    GNCLedgerDisplay *ld;
+    QofBook *book;
+    gboolean shown;
+} ShownChangeData;
+
+static void
+find_shown_change (gpointer key, gpointer value, gpointer user_data)
+{
+    const GncGUID *guid = key;
+    const EventInfo *info = value;
+    ShownChangeData *data = user_data;
+    Transaction *trans;
+    GList *node;
+
+    if (data->shown)
+        return;
+
+    /* Renamed accounts show in the transfer column */
+    if ((info->event_mask & (QOF_EVENT_MODIFY | QOF_EVENT_DESTROY)) &&
+            xaccAccountLookup (guid, data->book))
+    {
+        data->shown = TRUE;
+        return;
+    }
+
+    trans = xaccTransLookup (guid, data->book);
+    if (!trans)
+        return;
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        if (qof_query_live_contains (data->ld->query, node->data))
+        {
+            data->shown = TRUE;
+            return;
+        }
+    }
+}
+
+/* Whether the changes touch anything the register shows, other than
+ * the splits the live query reported. */
+static gboolean
+gnc_ledger_display_changes_shown (GNCLedgerDisplay *ld, GHashTable *changes)
+{
+    ShownChangeData data;
+
+    data.ld = ld;
+    data.book = gnc_get_current_book ();
+    data.shown = FALSE;
+    g_hash_table_foreach (changes, find_shown_change, &data);
+    return data.shown;
+}
+
+/* Redraw the rows of the splits that changed in place, if the live
+ * query reported nothing else. */
+static gboolean
+gnc_ledger_display_redraw_changed (GNCLedgerDisplay *ld, GList *deltas)
+{
+    GList *node, *splits = NULL;
+    gboolean redrawn;
+
+    for (node = deltas; node; node = node->next)
+    {
+        QofQueryDelta *delta = node->data;
+
+        if (delta->type != QOF_QUERY_DELTA_MOVE ||
+                delta->old_index != delta->new_index)
+        {
+            g_list_free (splits);
+            return FALSE;
+        }
+        splits = g_list_prepend (splits, delta->object);
+    }
+
+    redrawn = gnc_split_register_redraw_splits (ld->reg, splits);
+    g_list_free (splits);
+    return redrawn;
+}
+
 static void
 refresh_handler (GHashTable *changes, gpointer user_data)
 {
     GNCLedgerDisplay *ld = user_data;
     const EventInfo *info;
     gboolean has_leader;
-    GList *splits;
+    GList *splits, *deltas;
 
     ENTER("changes=%p, user_data=%p", changes, user_data);
 
@@ -569,14 +660,35 @@ refresh_handler (GHashTable *changes, gpointer user_data)
         }
     }
 
-    /* Its not clear if we should re-run the query, or if we should
-     * just use qof_query_last_run().  Its possible that the dates
-     * changed, requiring a full new query.  Similar considerations
-     * needed for multi-user mode.
-     */
-    splits = qof_query_run (ld->query);
+    /* The live query has already been updated for the changes, unless
+     * the query itself changed in the meantime.  Then, or when asked
+     * for a full refresh, run it again. */
+    if (changes && qof_query_take_live_changes (ld->query, &deltas))
+    {
+        splits = qof_query_last_run (ld->query);
+        if (!deltas && !gnc_ledger_display_changes_shown (ld, changes))
+        {
+            LEAVE("no shown changes");
+            return;
+        }
 
-    gnc_ledger_display_set_watches (ld, splits);
+        /* Splits changed in place only need their rows redrawn;
+         * anything else reloads the register. */
+        if (deltas && gnc_ledger_display_redraw_changed (ld, deltas))
+        {
+            qof_query_free_deltas (deltas);
+            LEAVE("redrew changed rows");
+            return;
+        }
+        if (deltas)
+            gnc_ledger_display_set_watches (ld, splits);
+        qof_query_free_deltas (deltas);
+    }
+    else
+    {
+        splits = qof_query_run (ld->query);
+        gnc_ledger_display_set_watches (ld, splits);
+    }
 
     gnc_ledger_display_refresh_internal (ld, splits);
     LEAVE(" ");
@@ -767,6 +879,7 @@ gnc_ledger_display_internal (Account *lead_account, Query *q,
         ld->query = qof_query_copy (q);
     else
         gnc_ledger_display_make_query (ld, limit, reg_type);
+    gnc_ledger_display_make_live (ld);
 
     ld->component_id = gnc_register_gui_component (class,
                        refresh_handler,
@@ -801,6 +914,7 @@ gnc_ledger_display_set_query (GNCLedgerDisplay *ledger_display, Query *q)
 
     qof_query_destroy (ledger_display->query);
     ledger_display->query = qof_query_copy (q);
+    gnc_ledger_display_make_live (ledger_display);
 }
 
 GNCLedgerDisplay *
@@ -836,6 +950,8 @@ gnc_ledger_display_refresh_internal (GNCLedgerDisplay *ld, GList *splits)
 void
 gnc_ledger_display_refresh (GNCLedgerDisplay *ld)
 {
+    GList *splits, *deltas;
+
     ENTER("ld=%p", ld);
 
     if (!ld)
@@ -850,7 +966,19 @@ gnc_ledger_display_refresh (GNCLedgerDisplay *ld)
         return;
     }
 
-    gnc_ledger_display_refresh_internal (ld, qof_query_run (ld->query));
+    /* Reloading more rows into the register does not need the query
+     * to be run again while its live results are up to date. */
+    if (qof_query_take_live_changes (ld->query, &deltas))
+    {
+        splits = qof_query_last_run (ld->query);
+        if (deltas)
+            gnc_ledger_display_set_watches (ld, splits);
+        qof_query_free_deltas (deltas);
+    }
+    else
+        splits = qof_query_run (ld->query);
+
+    gnc_ledger_display_refresh_internal (ld, splits);
     LEAVE(" ");
 }
 
@@ -1808,6 +1808,32 @@ gnc_split_register_traverse (VirtualLocation *p_new_virt_loc,
                                        new_trans, info->exact_traversal);
 }
 
+/* Load more of the splits the register left out before its first row:
+ * all of them, or as many again as it holds.  Doubling the window keeps
+ * the reloads needed to reach the top of a long register down to a few,
+ * and their total work proportional to its length. */
+static int
+gnc_split_register_load_more (gboolean all, gpointer user_data)
+{
+    SplitRegister *reg = user_data;
+    SRInfo *info = gnc_split_register_get_info (reg);
+    int old_rows;
+
+    if (!info->window_skipped)
+        return 0;
+
+    ENTER("reg=%p, skipped=%d, all=%d", reg, info->window_skipped, all);
+    old_rows = reg->table->num_virt_rows;
+    if (all)
+        info->window_rows += info->window_skipped;
+    else
+        info->window_rows += MIN (info->window_rows, info->window_skipped);
+    gnc_split_register_redraw (reg);
+
+    LEAVE("added %d rows", reg->table->num_virt_rows - old_rows);
+    return MAX (reg->table->num_virt_rows - old_rows, 0);
+}
+
 TableControl *
 gnc_split_register_control_new (void)
 {
@@ -1815,6 +1841,7 @@ gnc_split_register_control_new (void)
 
     control->move_cursor = gnc_split_register_move_cursor;
     control->traverse = gnc_split_register_traverse;
+    control->load_more = gnc_split_register_load_more;
 
     return control;
 }
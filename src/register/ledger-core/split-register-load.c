@@ -239,6 +239,75 @@ static void add_quickfill_completions(TableLayout *layout, Transaction *trans,
     }
 }
 
+/* The index of the first split of slist to put into the table: the
+ * last window_rows of them, or from a little before the transaction
+ * the cursor goes to, the pending transaction or the transaction of
+ * the requested split if that is earlier. */
+static gint
+gnc_split_register_window_start (SRInfo *info, GList *slist,
+                                 Transaction *find_trans,
+                                 Transaction *pending_trans)
+{
+    Transaction *window_trans;
+    GList *node;
+    gint start, index;
+
+    start = (gint) g_list_length (slist) - info->window_rows;
+    if (start <= 0)
+        return 0;
+
+    window_trans = xaccSplitGetParent (xaccSplitLookup (&info->window_split_guid,
+                                       gnc_get_current_book ()));
+
+    for (node = slist, index = 0; node && index < start;
+            node = node->next, index++)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+
+        if (trans == find_trans || trans == pending_trans ||
+                (window_trans && trans == window_trans))
+            return MAX (index - SPLIT_REGISTER_WINDOW / 10, 0);
+    }
+    return start;
+}
+
+/* Whether the register shows a running balance computed from its rows,
+ * see gnc_split_register_get_rbaln() */
+static gboolean
+gnc_split_register_uses_rbaln (SplitRegister *reg)
+{
+    if (reg->is_template)
+        return FALSE;
+
+    switch (reg->type)
+    {
+    case INCOME_LEDGER:
+    case GENERAL_LEDGER:
+    case SEARCH_LEDGER:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+/* What the splits of trans add to the running balance of accounts */
+static gnc_numeric
+gnc_split_register_trans_rbaln (Transaction *trans, GList *accounts)
+{
+    gnc_numeric amount = gnc_numeric_zero ();
+    GList *node;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split *split = node->data;
+
+        if (g_list_find (accounts, xaccSplitGetAccount (split)))
+            amount = gnc_numeric_add_fixed (amount, xaccSplitGetAmount (split));
+    }
+    return amount;
+}
+
 static Split*
 create_blank_split (Account *default_account, SRInfo *info)
 {
@@ -343,6 +412,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     Split *split;
     Table *table;
     GList *node;
+    GList *rbaln_accounts = NULL;
 
     gboolean start_primary_color = TRUE;
     gboolean found_pending = FALSE;
@@ -361,6 +431,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     int new_trans_split_row = -1;
     int new_trans_row = -1;
     int new_split_row = -1;
+    gint length, index, window_start;
     time64 present, autoreadonly_time = 0;
 
     g_return_if_fail(reg);
@@ -453,10 +524,11 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     present = gnc_time64_get_today_end ();
     if (use_autoreadonly)
     {
-        GDate *d = qof_book_get_autoreadonly_gdate(gnc_get_current_book());
-        // "d" is NULL if use_autoreadonly is FALSE
-        autoreadonly_time = d ? timespecToTime64(gdate_to_timespec(*d)) : 0;
-        g_date_free(d);
+        GDate d;
+        // "d" is unset if use_autoreadonly is FALSE
+        autoreadonly_time =
+            qof_book_get_autoreadonly_date(gnc_get_current_book(), &d) ?
+            timespecToTime64(gdate_to_timespec(d)) : 0;
     }
 
     if (info->first_pass)
@@ -515,9 +587,26 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     if (multi_line)
         trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
 
+    /* Only the last splits go into the table, so that loading does not
+     * take longer the more splits an account has.  The ones before are
+     * loaded when the top of the table comes into view. */
+    length = g_list_length (slist);
+    window_start = gnc_split_register_window_start (info, slist, find_trans,
+                   pending_trans);
+    info->window_skipped = 0;
+    info->window_balance = gnc_numeric_zero ();
+    if (window_start > 0 && default_account &&
+            gnc_split_register_uses_rbaln (reg))
+    {
+        rbaln_accounts = gnc_account_get_descendants (default_account);
+        rbaln_accounts = g_list_prepend (rbaln_accounts, default_account);
+    }
+
     /* populate the table */
-    for (node = slist; node; node = node->next)
+    for (node = slist, index = 0; node; node = node->next, index++)
     {
+        gboolean skip = (index < window_start);
+
         split = node->data;
         trans = xaccSplitGetParent (split);
 
@@ -554,7 +643,8 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
         {
             if (xaccTransGetDate (trans) >= autoreadonly_time)
             {
-                table->model->dividing_row_upper = vcell_loc.virt_row;
+                if (!skip)
+                    table->model->dividing_row_upper = vcell_loc.virt_row;
                 found_divider_upper = TRUE;
             }
             else
@@ -567,7 +657,8 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
                 !found_divider &&
                 (xaccTransGetDate (trans) > present))
         {
-            table->model->dividing_row = vcell_loc.virt_row;
+            if (!skip)
+                table->model->dividing_row = vcell_loc.virt_row;
             found_divider = TRUE;
         }
 
@@ -576,6 +667,16 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
         if (info->first_pass)
             add_quickfill_completions(reg->table->layout, trans, split, has_last_num);
 
+        if (skip)
+        {
+            if (rbaln_accounts)
+                info->window_balance =
+                    gnc_numeric_add_fixed (info->window_balance,
+                                           gnc_split_register_trans_rbaln (trans, rbaln_accounts));
+            info->window_skipped++;
+            continue;
+        }
+
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
 
@@ -595,6 +696,11 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
 
     if (multi_line)
         g_hash_table_destroy (trans_table);
+    g_list_free (rbaln_accounts);
+
+    /* Keep the splits loaded so far in the table from now on. */
+    info->window_rows = MAX (info->window_rows, length - window_start);
+    info->window_split_guid = *guid_null ();
 
     /* add the blank split at the end. */
     if (pending_trans == blank_trans)
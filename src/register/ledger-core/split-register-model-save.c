@@ -674,7 +674,7 @@ gnc_template_register_save_xfrm_cell (BasicCell * cell,
     }
 
     acctGUID = xaccAccountGetGUID (acct);
-    kvpf = xaccSplitGetSlots (sd->split);
+    kvpf = xaccSplitGetSlotsForEdit (sd->split);
     kvp_frame_set_slot_path (kvpf, kvp_value_new_guid(acctGUID),
                              GNC_SX_ID, GNC_SX_ACCOUNT, NULL);
 
@@ -712,7 +712,7 @@ gnc_template_register_save_debcred_cell (BasicCell * cell,
     if (sd->handled_dc)
         return;
 
-    kvpf = xaccSplitGetSlots (sd->split);
+    kvpf = xaccSplitGetSlotsForEdit (sd->split);
 
     DEBUG ("kvp_frame before: %s\n", kvp_frame_to_string (kvpf));
 
@@ -778,7 +778,7 @@ gnc_template_register_save_shares_cell (BasicCell * cell,
 
     g_return_if_fail (gnc_basic_cell_has_name (cell, SHRS_CELL));
 
-    kvpf = xaccSplitGetSlots (sd->split);
+    kvpf = xaccSplitGetSlotsForEdit (sd->split);
 
     /* FIXME: shares cells are numeric by definition. */
     DEBUG ("kvp_frame before: %s\n", kvp_frame_to_string (kvpf));
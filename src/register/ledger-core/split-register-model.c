@@ -58,7 +58,8 @@ static QofLogModule log_module = GNC_MOD_LEDGER;
 static gboolean use_red_for_negative = TRUE;
 
 /* This returns the balance at runtime of a register at the split defined by virt_loc regardless of
- * sort order. It always assumes that the first txn in the register is starting from a 0 balance.
+ * sort order. It always assumes that the first txn in the register is starting from a 0 balance,
+ * counting the txns the register left out before its first row.
  * If gboolean subaccounts is TRUE, then it will return the total balance of the parent account
  * and all its subaccounts. FALSE will return the balance of just the parent account of the register. */
 static gnc_numeric
@@ -103,6 +104,9 @@ gnc_split_register_get_rbaln (VirtualLocation virt_loc, gpointer user_data, gboo
     row = virt_loc.vcell_loc.virt_row;
     virt_loc.vcell_loc.virt_row = 0;
 
+    if (subaccounts)
+        balance = info->window_balance;
+
     while (virt_loc.vcell_loc.virt_row <= row )
     {
         /* Get new temporary split and its parent transaction */
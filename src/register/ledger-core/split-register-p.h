@@ -32,6 +32,10 @@
 #define ACTION_BUY_STR  _("Buy")
 #define ACTION_SELL_STR _("Sell")
 
+/* How many splits a load puts into the table at first.  The window
+ * doubles each time the top of the table comes into view. */
+#define SPLIT_REGISTER_WINDOW 250
+
 typedef enum {
     RATE_RESET_NOT_REQD = 0,
     RATE_RESET_REQD     = 1,
@@ -130,6 +134,18 @@ struct sr_info
 
     /* true if the account separator has changed */
     gboolean separator_changed;
+
+    /* How many of the last splits given to the load are put into the
+     * table; the ones before them are left out */
+    gint window_rows;
+
+    /* How many splits the last load left out, and the running balance
+     * they add up to */
+    gint window_skipped;
+    gnc_numeric window_balance;
+
+    /* A split the next load has to put into the table */
+    GncGUID window_split_guid;
 };
 
 
@@ -51,6 +51,10 @@ gnc_split_register_init_info (SplitRegister *reg)
     info->pending_trans_guid = *guid_null ();
     info->default_account = *guid_null ();
     info->template_account = *guid_null ();
+    info->window_split_guid = *guid_null ();
+
+    info->window_rows = SPLIT_REGISTER_WINDOW;
+    info->window_balance = gnc_numeric_zero ();
 
     info->last_date_entered = gnc_time64_get_today_start ();
 
@@ -349,6 +349,85 @@ gnc_split_register_get_split_virt_loc (SplitRegister *reg, Split *split,
     return FALSE;
 }
 
+gboolean
+gnc_split_register_include_split (SplitRegister *reg, Split *split)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    if (!reg || !split) return FALSE;
+
+    if (!info->window_skipped ||
+            gnc_split_register_get_split_virt_loc (reg, split, NULL))
+        return FALSE;
+
+    info->window_split_guid = *xaccSplitGetGUID (split);
+    gnc_split_register_redraw (reg);
+    return TRUE;
+}
+
+/* Whether a transaction at row is on the side of a divider that the
+ * load put it on: the divider is at the first row whose transaction is
+ * at or past the divider's time. */
+static gboolean
+gnc_split_register_divider_holds (int divider, int row, gboolean past)
+{
+    if (past)
+        return divider >= 0 && row >= divider;
+    return row != divider;
+}
+
+gboolean
+gnc_split_register_redraw_splits (SplitRegister *reg, GList *splits)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+    Transaction *current_trans, *pending_trans;
+    QofBook *book = gnc_get_current_book ();
+    gboolean use_autoreadonly = qof_book_uses_autoreadonly (book);
+    time64 present, autoreadonly_time = 0;
+    GList *node;
+
+    if (!reg || !info || reg->style != REG_STYLE_LEDGER)
+        return FALSE;
+
+    current_trans = gnc_split_register_get_current_trans (reg);
+    pending_trans = xaccTransLookup (&info->pending_trans_guid, book);
+    present = gnc_time64_get_today_end ();
+    if (use_autoreadonly)
+    {
+        GDate d;
+        autoreadonly_time =
+            qof_book_get_autoreadonly_date (book, &d) ?
+            timespecToTime64 (gdate_to_timespec (d)) : 0;
+    }
+
+    for (node = splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+        VirtualCellLocation vcell_loc;
+        time64 date = xaccTransGetDate (trans);
+
+        /* The cursor holds its own copy of the values it shows */
+        if (trans == current_trans || trans == pending_trans)
+            return FALSE;
+        if (!gnc_split_register_get_split_virt_loc (reg, split, &vcell_loc))
+            return FALSE;
+        if (info->show_present_divider &&
+                !gnc_split_register_divider_holds (reg->table->model->dividing_row,
+                                                   vcell_loc.virt_row,
+                                                   date > present))
+            return FALSE;
+        if (info->show_present_divider && use_autoreadonly &&
+                !gnc_split_register_divider_holds (reg->table->model->dividing_row_upper,
+                                                   vcell_loc.virt_row,
+                                                   date >= autoreadonly_time))
+            return FALSE;
+    }
+
+    gnc_table_refresh_gui (reg->table, FALSE);
+    return TRUE;
+}
+
 gboolean
 gnc_split_register_get_split_amount_virt_loc (SplitRegister *reg, Split *split,
         VirtualLocation *virt_loc)
@@ -431,6 +431,35 @@ gboolean
 gnc_split_register_get_split_virt_loc (SplitRegister *reg, Split *split,
                                        VirtualCellLocation *vcell_loc);
 
+/** Makes sure the rows of a split are in the register.  A register
+ *  loads only its last splits at first; if the split is not among the
+ *  rows loaded so far, the register is reloaded from its transaction
+ *  on.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param split the ::Split to show
+ *
+ *  @return @c TRUE if the register was reloaded, @c FALSE otherwise
+ */
+gboolean
+gnc_split_register_include_split (SplitRegister *reg, Split *split);
+
+/** Redraws the rows of splits that changed in ways that leave the rows
+ *  of the register as they are, instead of reloading the register.
+ *  Only basic ledgers are redrawn, and only if none of the splits is
+ *  in the transaction being edited or has moved across a divider.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param splits the changed ::Split's, all shown in the register
+ *
+ *  @return @c TRUE if the rows were redrawn, @c FALSE if the register
+ *  has to be reloaded
+ */
+gboolean
+gnc_split_register_redraw_splits (SplitRegister *reg, GList *splits);
+
 /** Searches the split register for the given split and determines the
  *  location of either its credit (if non-zero) or debit cell.
  *
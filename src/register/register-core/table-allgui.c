@@ -1823,3 +1823,12 @@ gnc_table_traverse_update(Table *table,
 
     return abort_move;
 }
+
+int
+gnc_table_load_more (Table *table, gboolean all)
+{
+    if (!table || !table->control->load_more)
+        return 0;
+
+    return table->control->load_more (all, table->control->user_data);
+}
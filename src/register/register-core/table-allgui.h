@@ -389,6 +389,12 @@ gboolean     gnc_table_traverse_update(Table *table,
                                        gncTableTraversalDir dir,
                                        VirtualLocation *dest_loc);
 
+/* The gnc_table_load_more() method asks the control to load more of
+ *   the rows a windowed table left out before its first row, or all of
+ *   them.  It returns the number of virtual rows added in front of the
+ *   old ones. */
+int          gnc_table_load_more (Table *table, gboolean all);
+
 #endif /* TABLE_ALLGUI_H */
 /** @} */
 /** @} */
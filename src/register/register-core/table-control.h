@@ -41,6 +41,8 @@ typedef gboolean (*TableTraverseFunc) (VirtualLocation *new_virt_loc,
                                        gncTableTraversalDir dir,
                                        gpointer user_data);
 
+typedef int (*TableLoadMoreFunc) (gboolean all, gpointer user_data);
+
 typedef struct table_control
 {
     /* called when the cursor is moved */
@@ -51,6 +53,11 @@ typedef struct table_control
     /* called to determine traversal when user requests a move */
     TableTraverseFunc traverse;
 
+    /* called when the top of the table comes into view, to load more
+     * of the rows left out before it, or all of them; returns how many
+     * rows it added there */
+    TableLoadMoreFunc load_more;
+
     gpointer user_data;
 } TableControl;
 
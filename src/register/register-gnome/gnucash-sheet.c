@@ -589,11 +589,43 @@ gnucash_sheet_update_adjustments (GnucashSheet *sheet)
 }
 
 
+/* A table may hold only its last rows.  When its top comes into view,
+ * have more of the rows before it loaded, and keep the rows that were
+ * at the top in view.  A scrollbar dragged right to the top asks for
+ * all of them at once. */
+static void
+gnucash_sheet_load_more (GnucashSheet *sheet)
+{
+    VirtualCellLocation vcell_loc = { 1, 0 };
+    SheetBlock *block;
+    gboolean all;
+    gint added;
+
+    if (sheet->loading_more || sheet->top_block > 1)
+        return;
+
+    sheet->loading_more = TRUE;
+    all = (sheet->vadj->value <= sheet->vadj->lower);
+    added = gnc_table_load_more (sheet->table, all);
+    if (added > 0)
+    {
+        if (!all)
+            vcell_loc.virt_row = MIN (1 + added, sheet->num_virt_rows - 1);
+        block = gnucash_sheet_get_block (sheet, vcell_loc);
+        if (block)
+            gtk_adjustment_set_value (sheet->vadj, block->origin_y);
+        gnucash_sheet_compute_visible_range (sheet);
+        gnucash_sheet_update_adjustments (sheet);
+    }
+    sheet->loading_more = FALSE;
+}
+
 static void
 gnucash_sheet_vadjustment_value_changed (GtkAdjustment *adj,
         GnucashSheet *sheet)
 {
     gnucash_sheet_compute_visible_range (sheet);
+    gnucash_sheet_load_more (sheet);
 }
 
 
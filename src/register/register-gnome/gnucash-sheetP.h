@@ -77,6 +77,8 @@ struct _GnucashSheet
     gint num_visible_blocks;
     gint num_visible_phys_rows;
 
+    gboolean loading_more; /* loading the rows before the top block */
+
     gint width;  /* the width in pixels of the sheet */
     gint height;
 